@@ -38,7 +38,8 @@ while [ $i -le $# ]; do
 		;;
 	"-os=unix")
 		os=1
-		CFLAGS="$CFLAGS -DKRIPTO_UNIX"
+		CFLAGS="$CFLAGS -DKRIPTO_UNIX -pthread"
+		LDFLAGS="$LDFLAGS -pthread"
 		;;
 	"-os=windows")
 		os=2
@@ -61,7 +62,8 @@ done
 
 # if OS not defined assume UNIX
 if [ -z $os ]; then
-	CFLAGS="$CFLAGS -DKRIPTO_UNIX"
+	CFLAGS="$CFLAGS -DKRIPTO_UNIX -pthread"
+	LDFLAGS="$LDFLAGS -pthread"
 fi
 
 if [ -z $debug ]; then
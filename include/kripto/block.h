@@ -1,6 +1,8 @@
 #ifndef KRIPTO_BLOCK_H
 #define KRIPTO_BLOCK_H
 
+#include <stddef.h>
+
 typedef struct kripto_block_desc kripto_block_desc;
 typedef struct kripto_block kripto_block;
 
@@ -41,6 +43,22 @@ extern void kripto_block_decrypt
 	void *pt
 );
 
+extern void kripto_block_encrypt_blocks
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct,
+	size_t blocks
+);
+
+extern void kripto_block_decrypt_blocks
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt,
+	size_t blocks
+);
+
 extern void kripto_block_destroy(kripto_block *s);
 
 extern const kripto_block_desc *kripto_block_getdesc(const kripto_block *s);
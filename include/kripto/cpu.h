@@ -0,0 +1,22 @@
+#ifndef KRIPTO_CPU_H
+#define KRIPTO_CPU_H
+
+#if (defined(__GNUC__) || defined(__clang__)) \
+&& (defined(__i386__) || defined(__x86_64__)) \
+&& !defined(KRIPTO_NO_SIMD)
+#define KRIPTO_X86_SIMD
+#define KRIPTO_TARGET(X) __attribute__((target(X)))
+#endif
+
+#define KRIPTO_CPU_SSE2		0x0001
+#define KRIPTO_CPU_SSSE3	0x0002
+#define KRIPTO_CPU_SSE41	0x0004
+#define KRIPTO_CPU_AES		0x0008
+#define KRIPTO_CPU_AVX		0x0010
+#define KRIPTO_CPU_AVX2		0x0020
+#define KRIPTO_CPU_AVX512	0x0040 /* F, VL and BW */
+#define KRIPTO_CPU_SHA		0x0080
+
+extern unsigned int kripto_cpu(void);
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef KRIPTO_BLOCK_DESC_H
 #define KRIPTO_BLOCK_DESC_H
 
+#include <stddef.h>
+
 struct kripto_block_desc
 {
 	kripto_block *(*create)
@@ -29,6 +31,22 @@ struct kripto_block_desc
 
 	void (*decrypt)(const kripto_block *, const void *, void *);
 
+	void (*encrypt_blocks)
+	(
+		const kripto_block *,
+		const void *,
+		void *,
+		size_t
+	);
+
+	void (*decrypt_blocks)
+	(
+		const kripto_block *,
+		const void *,
+		void *,
+		size_t
+	);
+
 	void (*destroy)(kripto_block *);
 
 	unsigned int blocksize;
@@ -11,6 +11,12 @@ struct kripto_hash_desc
 
 	void (*output)(kripto_hash *, void *, size_t);
 
+	void (*copy)(kripto_hash *, const kripto_hash *);
+
+	void (*export_state)(const kripto_hash *, void *);
+
+	int (*import_state)(kripto_hash *, const void *);
+
 	void (*destroy)(kripto_hash *);
 
 	int (*hash_all)
@@ -22,8 +28,19 @@ struct kripto_hash_desc
 		size_t
 	);
 
+	int (*hash_many)
+	(
+		unsigned int,
+		const void *const *,
+		const size_t *,
+		void *const *,
+		size_t,
+		size_t
+	);
+
 	size_t maxout;
 	unsigned int blocksize;
+	unsigned int statesize;
 };
 
 #endif
@@ -2,6 +2,7 @@
 #define KRIPTO_STREAM_DESC_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 struct kripto_stream_desc
 {
@@ -41,8 +42,28 @@ struct kripto_stream_desc
 		size_t
 	);
 
+	void (*encrypt_parallel)
+	(
+		kripto_stream *,
+		const void *,
+		void *,
+		size_t,
+		unsigned int
+	);
+
+	void (*decrypt_parallel)
+	(
+		kripto_stream *,
+		const void *,
+		void *,
+		size_t,
+		unsigned int
+	);
+
 	void (*prng)(kripto_stream *, void *, size_t);
 
+	void (*seek)(kripto_stream *, uint64_t);
+
 	void (*destroy)(kripto_stream *);
 
 	unsigned int maxkey;
@@ -34,6 +34,23 @@ extern void kripto_hash_output
 	size_t len
 );
 
+/* dst must be created with the same desc as src */
+extern void kripto_hash_copy(kripto_hash *dst, const kripto_hash *src);
+
+/*
+ * Exported state is a version byte, a 24 bit little endian body size
+ * and the body, kripto_hash_exportsize() bytes in all. It can be
+ * imported into any object of the same hash, also in another process.
+ */
+#define KRIPTO_HASH_STATE_VERSION 1
+
+extern size_t kripto_hash_exportsize(const kripto_hash_desc *desc);
+
+extern void kripto_hash_export(const kripto_hash *s, void *out);
+
+/* returns -1 (and leaves s as it was) if in is not a valid state */
+extern int kripto_hash_import(kripto_hash *s, const void *in);
+
 extern void kripto_hash_destroy(kripto_hash *s);
 
 extern int kripto_hash_all
@@ -46,6 +63,22 @@ extern int kripto_hash_all
 	size_t out_len
 );
 
+/*
+ * Hashes n independent messages, in[i] (in_len[i] bytes) to out[i].
+ * Hashes with multi-buffer kernels run one message per vector lane,
+ * the rest fall back to kripto_hash_all() for each message.
+ */
+extern int kripto_hash_many
+(
+	const kripto_hash_desc *desc,
+	unsigned int rounds,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+);
+
 extern const kripto_hash_desc *kripto_hash_getdesc(const kripto_hash *s);
 
 extern size_t kripto_hash_maxout(const kripto_hash_desc *s);
@@ -0,0 +1,6 @@
+#ifndef KRIPTO_HASH_BLAKE2BP_H
+#define KRIPTO_HASH_BLAKE2BP_H
+
+extern const kripto_hash_desc *const kripto_hash_blake2bp;
+
+#endif
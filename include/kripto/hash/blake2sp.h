@@ -0,0 +1,6 @@
+#ifndef KRIPTO_HASH_BLAKE2SP_H
+#define KRIPTO_HASH_BLAKE2SP_H
+
+extern const kripto_hash_desc *const kripto_hash_blake2sp;
+
+#endif
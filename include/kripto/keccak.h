@@ -0,0 +1,130 @@
+#ifndef KRIPTO_KECCAK_H
+#define KRIPTO_KECCAK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Keccak sponges kept as native lanes, shared by the keccak hash, mac,
+ * stream and ae. Byte k of the state is byte k % w of lane k / w, as in
+ * the little endian byte view. Input after output starts absorbing
+ * again from the first byte without a permutation.
+ *
+ * encrypt and decrypt run the sponge as a duplex: out = in ^ state and
+ * the ciphertext takes the place of those state bytes, so it is
+ * absorbed in the same pass. The first call after input, and every
+ * full rate, pads and permutes. Input and output after it continue in
+ * the same block.
+ */
+
+struct kripto_keccak1600
+{
+	uint64_t s[25];
+	unsigned int r;
+	unsigned int rate; /* bytes */
+	unsigned int i;
+	int o; /* 0 input, -1 output, 1 duplex */
+};
+
+extern void kripto_keccak1600_init
+(
+	struct kripto_keccak1600 *s,
+	unsigned int r,
+	unsigned int rate
+);
+
+extern void kripto_keccak1600_input
+(
+	struct kripto_keccak1600 *s,
+	const void *in,
+	size_t len
+);
+
+extern void kripto_keccak1600_output
+(
+	struct kripto_keccak1600 *s,
+	void *out,
+	size_t len
+);
+
+/* out = in ^ output */
+extern void kripto_keccak1600_output_xor
+(
+	struct kripto_keccak1600 *s,
+	const void *in,
+	void *out,
+	size_t len
+);
+
+extern void kripto_keccak1600_encrypt
+(
+	struct kripto_keccak1600 *s,
+	const void *pt,
+	void *ct,
+	size_t len
+);
+
+extern void kripto_keccak1600_decrypt
+(
+	struct kripto_keccak1600 *s,
+	const void *ct,
+	void *pt,
+	size_t len
+);
+
+struct kripto_keccak800
+{
+	uint32_t s[25];
+	unsigned int r;
+	unsigned int rate; /* bytes */
+	unsigned int i;
+	int o; /* 0 input, -1 output, 1 duplex */
+};
+
+extern void kripto_keccak800_init
+(
+	struct kripto_keccak800 *s,
+	unsigned int r,
+	unsigned int rate
+);
+
+extern void kripto_keccak800_input
+(
+	struct kripto_keccak800 *s,
+	const void *in,
+	size_t len
+);
+
+extern void kripto_keccak800_output
+(
+	struct kripto_keccak800 *s,
+	void *out,
+	size_t len
+);
+
+/* out = in ^ output */
+extern void kripto_keccak800_output_xor
+(
+	struct kripto_keccak800 *s,
+	const void *in,
+	void *out,
+	size_t len
+);
+
+extern void kripto_keccak800_encrypt
+(
+	struct kripto_keccak800 *s,
+	const void *pt,
+	void *ct,
+	size_t len
+);
+
+extern void kripto_keccak800_decrypt
+(
+	struct kripto_keccak800 *s,
+	const void *ct,
+	void *pt,
+	size_t len
+);
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef KRIPTO_LANES_H
+#define KRIPTO_LANES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kripto/hash.h>
+
+/*
+ * Multi-buffer hashing for hash_many: n messages share the lanes of
+ * a vector kernel, a lane taking the next message as soon as its own
+ * is done. Word i of lane l (of the state and of any scratch) is at
+ * [i * lanes + l].
+ */
+
+/* a message in a lane, blocks left counting the padded ones in pad */
+struct kripto_lane
+{
+	const uint8_t *in;
+	size_t full;
+	size_t blocks;
+	size_t msg;
+	uint8_t pad[256];
+};
+
+/*
+ * The scheduler. load() takes a message into a lane and sets its
+ * blocks, vector() moves every lane with blocks left one block on
+ * and serial() runs a lane to its end on the scalar state words at
+ * s. Every lane starts from the words s held when the run began, and
+ * the output of a lane is taken from its words in h.
+ */
+struct kripto_lanes
+{
+	struct kripto_lane lane[16];
+	unsigned int lanes;
+	unsigned int words;
+	unsigned int word_size; /* 4 or 8 */
+	int big_endian; /* output words */
+	void *h;
+	void *s;
+	uint8_t iv[200];
+	void *arg;
+	void (*load)
+	(
+		struct kripto_lanes *x,
+		struct kripto_lane *lane,
+		const void *in,
+		size_t len
+	);
+	void (*vector)(struct kripto_lanes *x);
+	void (*serial)(struct kripto_lanes *x, struct kripto_lane *lane);
+};
+
+extern void kripto_lanes_run
+(
+	struct kripto_lanes *x,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+);
+
+/* a kernel lanes wide, usable with the KRIPTO_CPU_* flags in cpu */
+struct kripto_lanes_kernel
+{
+	unsigned int lanes;
+	unsigned int cpu;
+	void (*f)
+	(
+		void *h,
+		const uint8_t *const *in,
+		void *w,
+		unsigned int r
+	);
+};
+
+/*
+ * Merkle-Damgard hashes: 64 or 128-byte blocks ending in 0x80 and a
+ * bit length field of block / 8 bytes, 32 or 64-bit state words. The
+ * kernels get one block per lane and 1 KB of scratch at w, widest
+ * first, a kernel with 0 lanes ending the list.
+ */
+struct kripto_lanes_md
+{
+	unsigned int block;
+	int big_endian; /* length field and output words */
+	unsigned int words;
+	unsigned int word_size;
+	void (*process)(kripto_hash *, const uint8_t *);
+	struct kripto_lanes_kernel kernel[4];
+};
+
+/*
+ * Hashes n messages with the widest kernel the CPU has that n fills
+ * more than half of, every lane starting from the state words h of s
+ * (as recreated). r goes to the kernels. Returns -1 when no kernel
+ * fits, for the messages to be hashed one by one.
+ */
+extern int kripto_lanes_md
+(
+	const struct kripto_lanes_md *md,
+	kripto_hash *s,
+	void *h,
+	unsigned int r,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+);
+
+#endif
@@ -3,4 +3,10 @@
 
 extern kripto_mac_desc *kripto_mac_hmac(const kripto_hash_desc *hash);
 
+/* hash of a desc from kripto_mac_hmac(), 0 for any other MAC */
+extern const kripto_hash_desc *kripto_mac_hmac_hash
+(
+	const kripto_mac_desc *desc
+);
+
 #endif
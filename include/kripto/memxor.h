@@ -0,0 +1,15 @@
+#ifndef KRIPTO_MEMXOR_H
+#define KRIPTO_MEMXOR_H
+
+#include <stddef.h>
+
+/* out = a ^ b, out may be a or b */
+extern void kripto_memxor
+(
+	const void *a,
+	const void *b,
+	void *out,
+	size_t len
+);
+
+#endif
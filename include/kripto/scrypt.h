@@ -16,4 +16,59 @@ extern int kripto_scrypt
 	size_t out_len
 );
 
+/*
+ * Same as kripto_scrypt(), but the p lanes are mixed by up to
+ * threads threads at once, each with its own n * r * 128 byte V.
+ */
+extern int kripto_scrypt_ex
+(
+	const kripto_mac_desc *mac,
+	unsigned int mac_rounds,
+	uint64_t n,
+	uint32_t r,
+	uint32_t p,
+	unsigned int threads,
+	const void *pass,
+	unsigned int pass_len,
+	const void *salt,
+	unsigned int salt_len,
+	void *out,
+	size_t out_len
+);
+
+typedef struct kripto_scrypt_ctx kripto_scrypt_ctx;
+
+/* back the workspace with huge pages where the system has them */
+#define KRIPTO_SCRYPT_HUGEPAGES 1
+
+/*
+ * Workspace for any number of runs with the same n, r, p and threads.
+ * It is wiped after every run, but stays allocated (and its pages
+ * mapped) until kripto_scrypt_ctx_destroy(). Returns 0 if n is not a
+ * power of 2, r or p is 0, or memory can not be allocated.
+ */
+extern kripto_scrypt_ctx *kripto_scrypt_ctx_create
+(
+	uint64_t n,
+	uint32_t r,
+	uint32_t p,
+	unsigned int threads,
+	unsigned int flags
+);
+
+extern int kripto_scrypt_ctx_run
+(
+	kripto_scrypt_ctx *ctx,
+	const kripto_mac_desc *mac,
+	unsigned int mac_rounds,
+	const void *pass,
+	unsigned int pass_len,
+	const void *salt,
+	unsigned int salt_len,
+	void *out,
+	size_t out_len
+);
+
+extern void kripto_scrypt_ctx_destroy(kripto_scrypt_ctx *ctx);
+
 #endif
@@ -0,0 +1,32 @@
+#ifndef KRIPTO_SIMD_H
+#define KRIPTO_SIMD_H
+
+#include <kripto/cpu.h>
+
+#ifdef KRIPTO_X86_SIMD
+
+#include <immintrin.h>
+
+#define LOADU(X) _mm_loadu_si128((const __m128i *)(const void *)(X))
+#define STOREU(X, Y) _mm_storeu_si128((__m128i *)(void *)(X), (Y))
+#define LOADU256(X) _mm256_loadu_si256((const __m256i *)(const void *)(X))
+#define STOREU256(X, Y) _mm256_storeu_si256((__m256i *)(void *)(X), (Y))
+#define LOADU512(X) _mm512_loadu_si512((const void *)(X))
+#define STOREU512(X, Y) _mm512_storeu_si512((void *)(X), (Y))
+
+/* 4x4 transpose of 32-bit words within every 128-bit lane */
+#define TRANSPOSE4(A, B, C, D, T, UNPACKLO32, UNPACKHI32, UNPACKLO64, UNPACKHI64) \
+{																	\
+	T[0] = UNPACKLO32(A, B);										\
+	T[1] = UNPACKLO32(C, D);										\
+	T[2] = UNPACKHI32(A, B);										\
+	T[3] = UNPACKHI32(C, D);										\
+	A = UNPACKLO64(T[0], T[1]);										\
+	B = UNPACKHI64(T[0], T[1]);										\
+	C = UNPACKLO64(T[2], T[3]);										\
+	D = UNPACKHI64(T[2], T[3]);										\
+}
+
+#endif
+
+#endif
@@ -2,6 +2,7 @@
 #define KRIPTO_STREAM_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct kripto_stream_desc kripto_stream_desc;
 typedef struct kripto_stream kripto_stream;
@@ -42,6 +43,24 @@ extern void kripto_stream_decrypt
 	size_t len
 );
 
+extern void kripto_stream_encrypt_parallel
+(
+	kripto_stream *s,
+	const void *pt,
+	void *ct,
+	size_t len,
+	unsigned int threads
+);
+
+extern void kripto_stream_decrypt_parallel
+(
+	kripto_stream *s,
+	const void *ct,
+	void *pt,
+	size_t len,
+	unsigned int threads
+);
+
 extern void kripto_stream_prng
 (
 	kripto_stream *s,
@@ -49,6 +68,8 @@ extern void kripto_stream_prng
 	size_t len
 );
 
+extern void kripto_stream_seek(kripto_stream *s, uint64_t offset);
+
 extern void kripto_stream_destroy(kripto_stream *s);
 
 extern unsigned int kripto_stream_multof(const kripto_stream *s);
@@ -1,6 +1,18 @@
 #ifndef KRIPTO_STREAM_CBC_H
 #define KRIPTO_STREAM_CBC_H
 
+#include <stddef.h>
+
 extern kripto_stream_desc *kripto_stream_cbc(const kripto_block_desc *block);
 
+/* all streams must be CBC with the same block cipher and key */
+extern void kripto_stream_cbc_encrypt_multi
+(
+	kripto_stream **s,
+	const void *const *pt,
+	void *const *ct,
+	const size_t *len,
+	unsigned int lanes
+);
+
 #endif
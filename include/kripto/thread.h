@@ -0,0 +1,86 @@
+#ifndef KRIPTO_THREAD_H
+#define KRIPTO_THREAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined(KRIPTO_NO_THREADS) \
+&& (defined(KRIPTO_UNIX) || defined(KRIPTO_WINDOWS))
+#define KRIPTO_THREADS
+#endif
+
+/* smallest span (in bytes) worth handing to a thread */
+#define KRIPTO_THREAD_MIN 65536
+
+/* calls f(arg, i) for i = 0 ... n - 1, each in its own thread */
+extern void kripto_thread_run
+(
+	void (*f)(void *, unsigned int),
+	void *arg,
+	unsigned int n
+);
+
+/* start of part i when total is split in n nearly equal parts */
+static inline size_t kripto_thread_part
+(
+	size_t total,
+	unsigned int n,
+	unsigned int i
+)
+{
+	return (total / n) * i + (i < total % n ? i : total % n);
+}
+
+/*
+ * A run of blocks from in to out, split in n parts as by
+ * kripto_thread_part(). Part i gets size bytes of its own workspace
+ * at mem + i * size, or none if size is 0.
+ */
+struct kripto_thread_blocks
+{
+	void *s;
+	const uint8_t *in;
+	uint8_t *out;
+	uint8_t *mem;
+	size_t size;
+	size_t blocks;
+	unsigned int n;
+};
+
+/*
+ * Splits the whole blocks of len between at most threads threads.
+ * Returns -1 (with nothing to free) if len is not worth splitting or
+ * the workspace can not be allocated.
+ */
+extern int kripto_thread_blocks_init
+(
+	struct kripto_thread_blocks *job,
+	void *s,
+	const void *in,
+	void *out,
+	size_t len,
+	unsigned int block_size,
+	size_t size,
+	unsigned int threads
+);
+
+/*
+ * Starts each workspace with the input block before its part (first
+ * for part 0), as chaining modes need. They are all taken before any
+ * thread runs, so in and out may be the same.
+ */
+extern void kripto_thread_blocks_chain
+(
+	struct kripto_thread_blocks *job,
+	const void *first,
+	unsigned int block_size
+);
+
+/* calls f(job, i) for every part, then wipes and frees the workspace */
+extern void kripto_thread_blocks_run
+(
+	struct kripto_thread_blocks *job,
+	void (*f)(void *, unsigned int)
+);
+
+#endif
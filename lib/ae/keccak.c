@@ -15,11 +15,8 @@
 #include <stdlib.h>
 #include <limits.h>
 
-#include <kripto/cast.h>
 #include <kripto/memwipe.h>
-#include <kripto/hash.h>
-#include <kripto/hash/keccak1600.h>
-#include <kripto/hash/keccak800.h>
+#include <kripto/keccak.h>
 #include <kripto/ae.h>
 #include <kripto/desc/ae.h>
 #include <kripto/object/ae.h>
@@ -30,14 +27,21 @@
 struct kripto_ae
 {
 	struct kripto_ae_object obj;
-	kripto_hash *hash;
-	unsigned int size;
-	uint8_t *buf;
-	unsigned int rate;
-	unsigned int i;
+	union
+	{
+		struct kripto_keccak1600 k1600; /* kripto_ae_keccak1600 */
+		struct kripto_keccak800 k800; /* kripto_ae_keccak800 */
+	} k;
 };
 
-static void keccak_encrypt
+static void keccak_destroy(kripto_ae *s)
+{
+	kripto_memwipe(s, sizeof(kripto_ae));
+	free(s);
+}
+
+/* 1600 */
+static void keccak1600_encrypt
 (
 	kripto_ae *s,
 	const void *pt,
@@ -45,25 +49,10 @@ static void keccak_encrypt
 	size_t len
 )
 {
-	size_t i;
-	uint8_t t;
-
-	for(i = 0; i < len; i++)
-	{
-		if(s->i == s->rate)
-		{
-			kripto_hash_output(s->hash, s->buf, s->rate);
-			s->i = 0;
-		}
-
-		t = CU8(pt)[i];
-		U8(ct)[i] = t ^ s->buf[s->i++];
-
-		kripto_hash_input(s->hash, &t/*U8(ct) + i*/, 1);
-	}
+	kripto_keccak1600_encrypt(&s->k.k1600, pt, ct, len);
 }
 
-static void keccak_decrypt
+static void keccak1600_decrypt
 (
 	kripto_ae *s,
 	const void *ct,
@@ -71,50 +60,27 @@ static void keccak_decrypt
 	size_t len
 )
 {
-	size_t i;
-
-	for(i = 0; i < len; i++, s->i++)
-	{
-		if(s->i == s->rate)
-		{
-			kripto_hash_output(s->hash, s->buf, s->rate);
-			s->i = 0;
-		}
-
-		s->buf[s->i] ^= CU8(ct)[i];
-
-		kripto_hash_input(s->hash, s->buf + s->i/*CU8(ct) + i*/, 1);
-
-		U8(pt)[i] = s->buf[s->i];
-	}
+	kripto_keccak1600_decrypt(&s->k.k1600, ct, pt, len);
 }
 
-static void keccak_header
+static void keccak1600_header
 (
 	kripto_ae *s,
 	const void *header,
 	size_t len
 )
 {
-	kripto_hash_input(s->hash, header, len);
+	kripto_keccak1600_input(&s->k.k1600, header, len);
 }
 
-static void keccak_tag(kripto_ae *s, void *tag, unsigned int len)
+static void keccak1600_tag(kripto_ae *s, void *tag, unsigned int len)
 {
-	kripto_hash_output(s->hash, tag, len);
-}
-
-static void keccak_destroy(kripto_ae *s)
-{
-	kripto_hash_destroy(s->hash);
-	kripto_memwipe(s, s->size);
-	free(s);
+	kripto_keccak1600_output(&s->k.k1600, tag, len);
 }
 
-/* 1600 */
-static kripto_ae *keccak1600_create
+static kripto_ae *keccak1600_recreate
 (
-	const kripto_ae_desc *desc,
+	kripto_ae *s,
 	unsigned int r,
 	const void *key,
 	unsigned int key_len,
@@ -123,36 +89,17 @@ static kripto_ae *keccak1600_create
 	unsigned int tag_len
 )
 {
-	kripto_ae *s;
+	kripto_keccak1600_init(&s->k.k1600, r, 200 - (tag_len << 1));
 
-	(void)desc;
-
-	s = malloc(sizeof(kripto_ae) + 200 - (tag_len << 1));
-	if(!s) return 0;
-
-	s->obj.desc = kripto_ae_keccak1600;
-	s->obj.multof = 1;
-
-	s->i = s->rate = 200 - (tag_len << 1);
-	s->size = sizeof(kripto_ae) + s->rate;
-	s->buf = U8(s) + sizeof(kripto_ae);
-
-	s->hash = kripto_hash_create(kripto_hash_keccak1600, r, tag_len);
-	if(!s->hash)
-	{
-		free(s);
-		return 0;
-	}
-
-	kripto_hash_input(s->hash, key, key_len);
-	kripto_hash_input(s->hash, iv, iv_len);
+	kripto_keccak1600_input(&s->k.k1600, key, key_len);
+	kripto_keccak1600_input(&s->k.k1600, iv, iv_len);
 
 	return s;
 }
 
-static kripto_ae *keccak1600_recreate
+static kripto_ae *keccak1600_create
 (
-	kripto_ae *s,
+	const kripto_ae_desc *desc,
 	unsigned int r,
 	const void *key,
 	unsigned int key_len,
@@ -161,32 +108,27 @@ static kripto_ae *keccak1600_recreate
 	unsigned int tag_len
 )
 {
-	if(sizeof(kripto_ae) + 200 - (tag_len << 1) > s->size)
-	{
-		keccak_destroy(s);
-		s = keccak1600_create(s->obj.desc, r, key, key_len, iv, iv_len, tag_len);
-	}
-	else
-	{
-		s->i = s->rate = 200 - (tag_len << 1);
+	kripto_ae *s;
 
-		(void)kripto_hash_recreate(s->hash, r, tag_len);
+	(void)desc;
 
-		kripto_hash_input(s->hash, key, key_len);
-		kripto_hash_input(s->hash, iv, iv_len);
-	}
+	s = malloc(sizeof(kripto_ae));
+	if(!s) return 0;
 
-	return s;
+	s->obj.desc = kripto_ae_keccak1600;
+	s->obj.multof = 1;
+
+	return keccak1600_recreate(s, r, key, key_len, iv, iv_len, tag_len);
 }
 
 static const kripto_ae_desc keccak1600 =
 {
 	&keccak1600_create,
 	&keccak1600_recreate,
-	&keccak_encrypt,
-	&keccak_decrypt,
-	&keccak_header,
-	&keccak_tag,
+	&keccak1600_encrypt,
+	&keccak1600_decrypt,
+	&keccak1600_header,
+	&keccak1600_tag,
 	&keccak_destroy,
 	UINT_MAX, /* max key */
 	UINT_MAX, /* max iv */
@@ -196,9 +138,46 @@ static const kripto_ae_desc keccak1600 =
 const kripto_ae_desc *const kripto_ae_keccak1600 = &keccak1600;
 
 /* 800 */
-static kripto_ae *keccak800_create
+static void keccak800_encrypt
 (
-	const kripto_ae_desc *desc,
+	kripto_ae *s,
+	const void *pt,
+	void *ct,
+	size_t len
+)
+{
+	kripto_keccak800_encrypt(&s->k.k800, pt, ct, len);
+}
+
+static void keccak800_decrypt
+(
+	kripto_ae *s,
+	const void *ct,
+	void *pt,
+	size_t len
+)
+{
+	kripto_keccak800_decrypt(&s->k.k800, ct, pt, len);
+}
+
+static void keccak800_header
+(
+	kripto_ae *s,
+	const void *header,
+	size_t len
+)
+{
+	kripto_keccak800_input(&s->k.k800, header, len);
+}
+
+static void keccak800_tag(kripto_ae *s, void *tag, unsigned int len)
+{
+	kripto_keccak800_output(&s->k.k800, tag, len);
+}
+
+static kripto_ae *keccak800_recreate
+(
+	kripto_ae *s,
 	unsigned int r,
 	const void *key,
 	unsigned int key_len,
@@ -207,36 +186,17 @@ static kripto_ae *keccak800_create
 	unsigned int tag_len
 )
 {
-	kripto_ae *s;
-
-	(void)desc;
-
-	s = malloc(sizeof(kripto_ae) + 100 - (tag_len << 1));
-	if(!s) return 0;
-
-	s->obj.desc = kripto_ae_keccak800;
-	s->obj.multof = 1;
-
-	s->i = s->rate = 100 - (tag_len << 1);
-	s->size = sizeof(kripto_ae) + s->rate;
-	s->buf = U8(s) + sizeof(kripto_ae);
-
-	s->hash = kripto_hash_create(kripto_hash_keccak800, r, tag_len);
-	if(!s->hash)
-	{
-		free(s);
-		return 0;
-	}
+	kripto_keccak800_init(&s->k.k800, r, 100 - (tag_len << 1));
 
-	kripto_hash_input(s->hash, key, key_len);
-	kripto_hash_input(s->hash, iv, iv_len);
+	kripto_keccak800_input(&s->k.k800, key, key_len);
+	kripto_keccak800_input(&s->k.k800, iv, iv_len);
 
 	return s;
 }
 
-static kripto_ae *keccak800_recreate
+static kripto_ae *keccak800_create
 (
-	kripto_ae *s,
+	const kripto_ae_desc *desc,
 	unsigned int r,
 	const void *key,
 	unsigned int key_len,
@@ -245,32 +205,27 @@ static kripto_ae *keccak800_recreate
 	unsigned int tag_len
 )
 {
-	if(sizeof(kripto_ae) + 100 - (tag_len << 1) > s->size)
-	{
-		keccak_destroy(s);
-		s = keccak800_create(s->obj.desc, r, key, key_len, iv, iv_len, tag_len);
-	}
-	else
-	{
-		s->i = s->rate = 100 - (tag_len << 1);
+	kripto_ae *s;
 
-		(void)kripto_hash_recreate(s->hash, r, tag_len);
+	(void)desc;
 
-		kripto_hash_input(s->hash, key, key_len);
-		kripto_hash_input(s->hash, iv, iv_len);
-	}
+	s = malloc(sizeof(kripto_ae));
+	if(!s) return 0;
 
-	return s;
+	s->obj.desc = kripto_ae_keccak800;
+	s->obj.multof = 1;
+
+	return keccak800_recreate(s, r, key, key_len, iv, iv_len, tag_len);
 }
 
 static const kripto_ae_desc keccak800 =
 {
 	&keccak800_create,
 	&keccak800_recreate,
-	&keccak_encrypt,
-	&keccak_decrypt,
-	&keccak_header,
-	&keccak_tag,
+	&keccak800_encrypt,
+	&keccak800_decrypt,
+	&keccak800_header,
+	&keccak800_tag,
 	&keccak_destroy,
 	UINT_MAX, /* max key */
 	UINT_MAX, /* max iv */
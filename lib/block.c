@@ -11,8 +11,11 @@
  * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
  */
 
+#include <stdint.h>
 #include <assert.h>
 
+#include <kripto/cast.h>
+
 #include <kripto/block.h>
 #include <kripto/desc/block.h>
 
@@ -107,6 +110,68 @@ void kripto_block_decrypt
 	s->desc->decrypt(s, ct, pt);
 }
 
+void kripto_block_encrypt_blocks
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct,
+	size_t blocks
+)
+{
+	size_t i;
+
+	assert(s);
+	assert(s->desc);
+	assert(s->desc->encrypt);
+	assert(pt);
+	assert(ct);
+
+	if(s->desc->encrypt_blocks)
+	{
+		s->desc->encrypt_blocks(s, pt, ct, blocks);
+		return;
+	}
+
+	/* generic fallback */
+	for(i = 0; i < blocks; i++)
+	{
+		s->desc->encrypt(s, pt, ct);
+		pt = CU8(pt) + s->desc->blocksize;
+		ct = U8(ct) + s->desc->blocksize;
+	}
+}
+
+void kripto_block_decrypt_blocks
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt,
+	size_t blocks
+)
+{
+	size_t i;
+
+	assert(s);
+	assert(s->desc);
+	assert(s->desc->decrypt);
+	assert(ct);
+	assert(pt);
+
+	if(s->desc->decrypt_blocks)
+	{
+		s->desc->decrypt_blocks(s, ct, pt, blocks);
+		return;
+	}
+
+	/* generic fallback */
+	for(i = 0; i < blocks; i++)
+	{
+		s->desc->decrypt(s, ct, pt);
+		ct = CU8(ct) + s->desc->blocksize;
+		pt = U8(pt) + s->desc->blocksize;
+	}
+}
+
 void kripto_block_destroy(kripto_block *s)
 {
 	assert(s);
@@ -232,6 +232,8 @@ static const kripto_block_desc threeway =
 	0, /* tweak */
 	&threeway_encrypt,
 	&threeway_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&threeway_destroy,
 	12, /* block size */
 	12, /* max key */
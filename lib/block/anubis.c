@@ -791,6 +791,8 @@ static const kripto_block_desc anubis =
 	0, /* tweak */
 	&anubis_encrypt,
 	&anubis_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&anubis_destroy,
 	16, /* block size */
 	40, /* max key */
@@ -726,6 +726,8 @@ static const kripto_block_desc aria =
 	0, /* tweak */
 	&aria_encrypt,
 	&aria_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&aria_destroy,
 	16, /* block size */
 	32, /* max key */
@@ -539,6 +539,8 @@ static const kripto_block_desc blowfish =
 	0, /* tweak */
 	&blowfish_encrypt,
 	&blowfish_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&blowfish_destroy,
 	8, /* block size */
 	56, /* max key */
@@ -702,6 +702,8 @@ static const kripto_block_desc camellia =
 	0, /* tweak */
 	&camellia_encrypt,
 	&camellia_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&camellia_destroy,
 	16, /* block size */
 	32, /* max key */
@@ -818,6 +818,8 @@ static const kripto_block_desc cast5 =
 	0, /* tweak */
 	&cast5_encrypt,
 	&cast5_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&cast5_destroy,
 	8, /* block size */
 	16, /* max key */
@@ -533,6 +533,8 @@ static const kripto_block_desc des =
 	0, /* tweak */
 	&des_encrypt,
 	&des_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&des_destroy,
 	8, /* block size */
 	24, /* max key */
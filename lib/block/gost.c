@@ -341,6 +341,8 @@ static const kripto_block_desc gost =
 	0, /* tweak */
 	&gost_encrypt,
 	&gost_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&gost_destroy,
 	8, /* block size */
 	32, /* max key */
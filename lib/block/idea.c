@@ -233,6 +233,8 @@ static const kripto_block_desc idea =
 	0, /* tweak */
 	&idea_encrypt,
 	&idea_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&idea_destroy,
 	8, /* block size */
 	16, /* max key */
@@ -767,6 +767,8 @@ static const kripto_block_desc khazad =
 	0, /* tweak */
 	&khazad_encrypt,
 	&khazad_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&khazad_destroy,
 	8, /* block size */
 	16, /* max key */
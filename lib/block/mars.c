@@ -447,6 +447,8 @@ static const kripto_block_desc mars =
 	0, /* tweak */
 	&mars_encrypt,
 	&mars_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&mars_destroy,
 	16, /* block size */
 	56, /* max key */
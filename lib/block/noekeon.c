@@ -224,6 +224,8 @@ static const kripto_block_desc noekeon =
 	0, /* tweak */
 	&noekeon_encrypt,
 	&noekeon_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&noekeon_destroy,
 	16, /* block size */
 	16, /* max key */
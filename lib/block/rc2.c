@@ -216,6 +216,8 @@ static const kripto_block_desc rc2 =
 	0, /* tweak */
 	&rc2_encrypt,
 	&rc2_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&rc2_destroy,
 	8, /* block size */
 	128, /* max key */
@@ -177,6 +177,8 @@ static const kripto_block_desc rc5 =
 	0, /* tweak */
 	&rc5_encrypt,
 	&rc5_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&rc5_destroy,
 	8, /* block size */
 	255, /* max key */
@@ -177,6 +177,8 @@ static const kripto_block_desc rc5_64 =
 	0, /* tweak */
 	&rc5_64_encrypt,
 	&rc5_64_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&rc5_64_destroy,
 	16, /* block size */
 	255, /* max key */
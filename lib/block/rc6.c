@@ -218,6 +218,8 @@ static const kripto_block_desc rc6 =
 	0, /* tweak */
 	&rc6_encrypt,
 	&rc6_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&rc6_destroy,
 	16, /* block size */
 	255, /* max key */
@@ -29,6 +29,8 @@
 #include <kripto/cast.h>
 #include <kripto/loadstore.h>
 #include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
 #include <kripto/block.h>
 #include <kripto/desc/block.h>
 #include <kripto/object/block.h>
@@ -36,9 +38,19 @@
 #include <kripto/block/rijndael128.h>
 #include <kripto/block/rijndael256.h>
 
+/* implementation picked at key setup */
+struct rijndael_impl
+{
+	void (*encrypt)(const kripto_block *, const void *, void *);
+	void (*decrypt)(const kripto_block *, const void *, void *);
+	void (*encrypt_blocks)(const kripto_block *, const void *, void *, size_t);
+	void (*decrypt_blocks)(const kripto_block *, const void *, void *, size_t);
+};
+
 struct kripto_block
 {
 	struct kripto_block_object obj;
+	const struct rijndael_impl *impl;
 	unsigned int rounds;
 	size_t size;
 	uint32_t *k;
@@ -884,279 +896,1872 @@ static void rijndael128_decrypt
 	STORE32B(t3, U8(pt) + 12);
 }
 
-static kripto_block *rijndael128_create
+static void rijndael128_encrypt_blocks
 (
-	unsigned int r,
-	const void *key,
-	unsigned int key_len
+	const kripto_block *s,
+	const void *pt,
+	void *ct,
+	size_t n
 )
 {
-	kripto_block *s;
+	for(; n; n--)
+	{
+		rijndael128_encrypt(s, pt, ct);
+		pt = CU8(pt) + 16;
+		ct = U8(ct) + 16;
+	}
+}
 
-	if(!r)
+static void rijndael128_decrypt_blocks
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt,
+	size_t n
+)
+{
+	for(; n; n--)
 	{
-		r = 6 + ((key_len + 3) >> 2);
-		if(r < 10) r = 10;
+		rijndael128_decrypt(s, ct, pt);
+		ct = CU8(ct) + 16;
+		pt = U8(pt) + 16;
 	}
+}
 
-	s = malloc(sizeof(kripto_block) + ((r + 1) << 5));
-	if(!s) return 0;
+static const struct rijndael_impl table128 =
+{
+	&rijndael128_encrypt,
+	&rijndael128_decrypt,
+	&rijndael128_encrypt_blocks,
+	&rijndael128_decrypt_blocks
+};
 
-	s->obj.desc = kripto_block_rijndael128;
-	s->size = sizeof(kripto_block) + ((r + 1) << 5);
-	s->rounds = r;
-	s->k = (uint32_t *)((uint8_t *)s + sizeof(kripto_block));
-	s->dk = s->k + ((r + 1) << 2);
+#ifdef KRIPTO_X86_SIMD
 
-	rijndael_setup(s, key, key_len, 16);
+/* AES-NI, round keys are kept in memory byte order */
 
-	return s;
+#define RK(K, I) LOADU(CU8(K) + ((I) << 4))
+
+/* convert round keys from rijndael_setup() to memory byte order */
+static void rijndael_tobytes(kripto_block *s, unsigned int bs)
+{
+	unsigned int i;
+	const unsigned int len = (s->rounds + 1) * (bs >> 2);
+
+	for(i = 0; i < len; i++)
+	{
+		STORE32B(s->k[i], s->k + i);
+		STORE32B(s->dk[i], s->dk + i);
+	}
 }
 
-static void rijndael_destroy(kripto_block *s)
+KRIPTO_TARGET("sse2")
+static __m128i aesni_expand(__m128i k, __m128i t)
 {
-	kripto_memwipe(s, s->size);
-	free(s);
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+
+	return _mm_xor_si128(k, t);
 }
 
-static kripto_block *rijndael128_recreate
+#define AESNI128_KEY(I, RCON)										\
+{																	\
+	t = _mm_aeskeygenassist_si128(k[I - 1], RCON);					\
+	k[I] = aesni_expand(k[I - 1], _mm_shuffle_epi32(t, 0xFF));		\
+}
+
+#define AESNI192_STEP(RCON)										\
+{																	\
+	t = _mm_aeskeygenassist_si128(x1, RCON);						\
+	x0 = aesni_expand(x0, _mm_shuffle_epi32(t, 0x55));				\
+	x1 = _mm_xor_si128(x1, _mm_slli_si128(x1, 4));					\
+	x1 = _mm_xor_si128(x1, _mm_shuffle_epi32(x0, 0xFF));			\
+}
+
+#define SHUFPD(X, Y, I) _mm_castpd_si128(_mm_shuffle_pd				\
+	(_mm_castsi128_pd(X), _mm_castsi128_pd(Y), I))
+
+/* two steps give 12 words, three round keys from k[I] */
+#define AESNI192_KEY(I, RCON0, RCON1)								\
+{																	\
+	k[I] = x1;														\
+	AESNI192_STEP(RCON0);											\
+	k[I] = SHUFPD(k[I], x0, 0);										\
+	k[I + 1] = SHUFPD(x0, x1, 1);									\
+	AESNI192_STEP(RCON1);											\
+	k[I + 2] = x0;													\
+}
+
+#define AESNI256_KEY(I, RCON)										\
+{																	\
+	t = _mm_aeskeygenassist_si128(k[I - 1], RCON);					\
+	k[I] = aesni_expand(k[I - 2], _mm_shuffle_epi32(t, 0xFF));		\
+	if(I < 14)														\
+	{																\
+		t = _mm_aeskeygenassist_si128(k[I], 0x00);					\
+		k[I + 1] = aesni_expand(k[I - 1], _mm_shuffle_epi32(t, 0xAA));	\
+	}																\
+}
+
+/* returns 0 if key length and rounds are not those of AES */
+KRIPTO_TARGET("aes,sse2")
+static int aesni_setup
 (
 	kripto_block *s,
-	unsigned int r,
-	const void *key,
+	const uint8_t *key,
 	unsigned int key_len
 )
 {
-	if(!r)
-	{
-		r = 6 + ((key_len + 3) >> 2);
-		if(r < 10) r = 10;
-	}
+	__m128i k[15];
+	__m128i x0;
+	__m128i x1;
+	__m128i t;
+	unsigned int i;
 
-	if(sizeof(kripto_block) + ((r + 1) << 5) > s->size)
+	if(s->rounds != 6 + (key_len >> 2)) return 0;
+
+	switch(key_len)
 	{
-		rijndael_destroy(s);
-		s = rijndael128_create(r, key, key_len);
+		case 16:
+			k[0] = LOADU(key);
+			AESNI128_KEY(1, 0x01);
+			AESNI128_KEY(2, 0x02);
+			AESNI128_KEY(3, 0x04);
+			AESNI128_KEY(4, 0x08);
+			AESNI128_KEY(5, 0x10);
+			AESNI128_KEY(6, 0x20);
+			AESNI128_KEY(7, 0x40);
+			AESNI128_KEY(8, 0x80);
+			AESNI128_KEY(9, 0x1B);
+			AESNI128_KEY(10, 0x36);
+			break;
+
+		case 24:
+			/* 6 words per step, so round keys straddle registers */
+			x0 = LOADU(key);
+			x1 = _mm_loadl_epi64((const __m128i *)(const void *)(key + 16));
+			k[0] = x0;
+			AESNI192_KEY(1, 0x01, 0x02);
+			AESNI192_KEY(4, 0x04, 0x08);
+			AESNI192_KEY(7, 0x10, 0x20);
+			AESNI192_KEY(10, 0x40, 0x80);
+			break;
+
+		case 32:
+			k[0] = LOADU(key);
+			k[1] = LOADU(key + 16);
+			AESNI256_KEY(2, 0x01);
+			AESNI256_KEY(4, 0x02);
+			AESNI256_KEY(6, 0x04);
+			AESNI256_KEY(8, 0x08);
+			AESNI256_KEY(10, 0x10);
+			AESNI256_KEY(12, 0x20);
+			AESNI256_KEY(14, 0x40);
+			break;
+
+		default:
+			return 0;
 	}
-	else
+
+	/* decryption keys for the equivalent inverse cipher */
+	STOREU(s->k, k[0]);
+	STOREU(s->dk, k[s->rounds]);
+	for(i = 1; i < s->rounds; i++)
 	{
-		s->rounds = r;
-		rijndael_setup(s, key, key_len, 16);
+		STOREU(U8(s->k) + (i << 4), k[i]);
+		STOREU(U8(s->dk) + (i << 4), _mm_aesimc_si128(k[s->rounds - i]));
 	}
+	STOREU(U8(s->k) + (i << 4), k[i]);
+	STOREU(U8(s->dk) + (i << 4), k[0]);
 
-	return s;
-}
-
-static const kripto_block_desc rijndael128 =
-{
-	&rijndael128_create,
-	&rijndael128_recreate,
-	0, /* tweak */
-	&rijndael128_encrypt,
-	&rijndael128_decrypt,
-	&rijndael_destroy,
-	16, /* block size */
-	32, /* max key */
-	0 /* max tweak */
-};
-
-const kripto_block_desc *const kripto_block_rijndael128 = &rijndael128;
+	/* wipe */
+	kripto_memwipe(k, sizeof(k));
+	kripto_memwipe(&x0, sizeof(__m128i));
+	kripto_memwipe(&x1, sizeof(__m128i));
+	kripto_memwipe(&t, sizeof(__m128i));
 
-/* rijndael256 */
+	return 1;
+}
 
-static void rijndael256_encrypt
+KRIPTO_TARGET("aes,sse2")
+static void aesni128_encrypt
 (
 	const kripto_block *s,
 	const void *pt,
 	void *ct
 )
 {
-	uint32_t x0;
-	uint32_t x1;
-	uint32_t x2;
-	uint32_t x3;
-	uint32_t x4;
-	uint32_t x5;
-	uint32_t x6;
-	uint32_t x7;
-	uint32_t t0;
-	uint32_t t1;
-	uint32_t t2;
-	uint32_t t3;
-	uint32_t t4;
-	uint32_t t5;
-	uint32_t t6;
-	uint32_t t7;
+	__m128i x;
 	unsigned int i;
 
-	x0 = LOAD32B(CU8(pt)) ^ s->k[0];
-	x1 = LOAD32B(CU8(pt) + 4) ^ s->k[1];
-	x2 = LOAD32B(CU8(pt) + 8) ^ s->k[2];
-	x3 = LOAD32B(CU8(pt) + 12) ^ s->k[3];
-	x4 = LOAD32B(CU8(pt) + 16) ^ s->k[4];
-	x5 = LOAD32B(CU8(pt) + 20) ^ s->k[5];
-	x6 = LOAD32B(CU8(pt) + 24) ^ s->k[6];
-	x7 = LOAD32B(CU8(pt) + 28) ^ s->k[7];
-
-	/* - 1 full rounds */
-	for(i = 8; i < (s->rounds << 3);)
-	{
-		t0 = E(x0, x1, x3, x4) ^ s->k[i++];
-		t1 = E(x1, x2, x4, x5) ^ s->k[i++];
-		t2 = E(x2, x3, x5, x6) ^ s->k[i++];
-		t3 = E(x3, x4, x6, x7) ^ s->k[i++];
-		t4 = E(x4, x5, x7, x0) ^ s->k[i++];
-		t5 = E(x5, x6, x0, x1) ^ s->k[i++];
-		t6 = E(x6, x7, x1, x2) ^ s->k[i++];
-		t7 = E(x7, x0, x2, x3) ^ s->k[i++];
-
-		x0 = t0;
-		x1 = t1;
-		x2 = t2;
-		x3 = t3;
-		x4 = t4;
-		x5 = t5;
-		x6 = t6;
-		x7 = t7;
-	}
+	x = _mm_xor_si128(LOADU(pt), RK(s->k, 0));
 
-	/* last round */
-	t0 = EL(x0, x1, x3, x4) ^ s->k[i++];
-	t1 = EL(x1, x2, x4, x5) ^ s->k[i++];
-	t2 = EL(x2, x3, x5, x6) ^ s->k[i++];
-	t3 = EL(x3, x4, x6, x7) ^ s->k[i++];
-	t4 = EL(x4, x5, x7, x0) ^ s->k[i++];
-	t5 = EL(x5, x6, x0, x1) ^ s->k[i++];
-	t6 = EL(x6, x7, x1, x2) ^ s->k[i++];
-	t7 = EL(x7, x0, x2, x3) ^ s->k[i];
+	for(i = 1; i < s->rounds; i++)
+		x = _mm_aesenc_si128(x, RK(s->k, i));
 
-	STORE32B(t0, U8(ct));
-	STORE32B(t1, U8(ct) + 4);
-	STORE32B(t2, U8(ct) + 8);
-	STORE32B(t3, U8(ct) + 12);
-	STORE32B(t4, U8(ct) + 16);
-	STORE32B(t5, U8(ct) + 20);
-	STORE32B(t6, U8(ct) + 24);
-	STORE32B(t7, U8(ct) + 28);
+	STOREU(ct, _mm_aesenclast_si128(x, RK(s->k, i)));
 }
 
-static void rijndael256_decrypt
+KRIPTO_TARGET("aes,sse2")
+static void aesni128_decrypt
 (
 	const kripto_block *s,
 	const void *ct,
 	void *pt
 )
 {
-	uint32_t x0;
-	uint32_t x1;
-	uint32_t x2;
-	uint32_t x3;
-	uint32_t x4;
-	uint32_t x5;
-	uint32_t x6;
-	uint32_t x7;
-	uint32_t t0;
-	uint32_t t1;
-	uint32_t t2;
-	uint32_t t3;
-	uint32_t t4;
-	uint32_t t5;
-	uint32_t t6;
-	uint32_t t7;
+	__m128i x;
 	unsigned int i;
 
-	x0 = LOAD32B(CU8(ct)) ^ s->dk[0];
-	x1 = LOAD32B(CU8(ct) + 4) ^ s->dk[1];
-	x2 = LOAD32B(CU8(ct) + 8) ^ s->dk[2];
-	x3 = LOAD32B(CU8(ct) + 12) ^ s->dk[3];
-	x4 = LOAD32B(CU8(ct) + 16) ^ s->dk[4];
-	x5 = LOAD32B(CU8(ct) + 20) ^ s->dk[5];
-	x6 = LOAD32B(CU8(ct) + 24) ^ s->dk[6];
-	x7 = LOAD32B(CU8(ct) + 28) ^ s->dk[7];
-
-	/* - 1 full rounds */
-	for(i = 8; i < (s->rounds << 3);)
-	{
-		t0 = D(x0, x7, x5, x4) ^ s->dk[i++];
-		t1 = D(x1, x0, x6, x5) ^ s->dk[i++];
-		t2 = D(x2, x1, x7, x6) ^ s->dk[i++];
-		t3 = D(x3, x2, x0, x7) ^ s->dk[i++];
-		t4 = D(x4, x3, x1, x0) ^ s->dk[i++];
-		t5 = D(x5, x4, x2, x1) ^ s->dk[i++];
-		t6 = D(x6, x5, x3, x2) ^ s->dk[i++];
-		t7 = D(x7, x6, x4, x3) ^ s->dk[i++];
+	x = _mm_xor_si128(LOADU(ct), RK(s->dk, 0));
 
-		x0 = t0;
-		x1 = t1;
-		x2 = t2;
-		x3 = t3;
-		x4 = t4;
-		x5 = t5;
-		x6 = t6;
-		x7 = t7;
-	}
+	for(i = 1; i < s->rounds; i++)
+		x = _mm_aesdec_si128(x, RK(s->dk, i));
 
-	/* last round */
-	t0 = DL(x0, x7, x5, x4) ^ s->dk[i++];
-	t1 = DL(x1, x0, x6, x5) ^ s->dk[i++];
-	t2 = DL(x2, x1, x7, x6) ^ s->dk[i++];
-	t3 = DL(x3, x2, x0, x7) ^ s->dk[i++];
-	t4 = DL(x4, x3, x1, x0) ^ s->dk[i++];
-	t5 = DL(x5, x4, x2, x1) ^ s->dk[i++];
-	t6 = DL(x6, x5, x3, x2) ^ s->dk[i++];
-	t7 = DL(x7, x6, x4, x3) ^ s->dk[i];
+	STOREU(pt, _mm_aesdeclast_si128(x, RK(s->dk, i)));
+}
 
-	STORE32B(t0, U8(pt));
-	STORE32B(t1, U8(pt) + 4);
-	STORE32B(t2, U8(pt) + 8);
-	STORE32B(t3, U8(pt) + 12);
-	STORE32B(t4, U8(pt) + 16);
-	STORE32B(t5, U8(pt) + 20);
-	STORE32B(t6, U8(pt) + 24);
-	STORE32B(t7, U8(pt) + 28);
+/* 8 independent blocks in flight hide AESENC/AESDEC latency */
+#define AESNI_X8(F, L, K)											\
+{																	\
+	for(; n >= 8; n -= 8)											\
+	{																\
+		t = RK(K, 0);												\
+		x0 = _mm_xor_si128(LOADU(CU8(in)), t);						\
+		x1 = _mm_xor_si128(LOADU(CU8(in) + 16), t);					\
+		x2 = _mm_xor_si128(LOADU(CU8(in) + 32), t);					\
+		x3 = _mm_xor_si128(LOADU(CU8(in) + 48), t);					\
+		x4 = _mm_xor_si128(LOADU(CU8(in) + 64), t);					\
+		x5 = _mm_xor_si128(LOADU(CU8(in) + 80), t);					\
+		x6 = _mm_xor_si128(LOADU(CU8(in) + 96), t);					\
+		x7 = _mm_xor_si128(LOADU(CU8(in) + 112), t);				\
+																	\
+		for(i = 1; i < s->rounds; i++)								\
+		{															\
+			t = RK(K, i);											\
+			x0 = F(x0, t);											\
+			x1 = F(x1, t);											\
+			x2 = F(x2, t);											\
+			x3 = F(x3, t);											\
+			x4 = F(x4, t);											\
+			x5 = F(x5, t);											\
+			x6 = F(x6, t);											\
+			x7 = F(x7, t);											\
+		}															\
+																	\
+		t = RK(K, i);												\
+		STOREU(U8(out), L(x0, t));									\
+		STOREU(U8(out) + 16, L(x1, t));								\
+		STOREU(U8(out) + 32, L(x2, t));								\
+		STOREU(U8(out) + 48, L(x3, t));								\
+		STOREU(U8(out) + 64, L(x4, t));								\
+		STOREU(U8(out) + 80, L(x5, t));								\
+		STOREU(U8(out) + 96, L(x6, t));								\
+		STOREU(U8(out) + 112, L(x7, t));							\
+																	\
+		in = CU8(in) + 128;											\
+		out = U8(out) + 128;										\
+	}																\
 }
 
-static kripto_block *rijndael256_create
+KRIPTO_TARGET("aes,sse2")
+static void aesni128_encrypt_blocks
 (
-	unsigned int r,
-	const void *key,
-	unsigned int key_len
+	const kripto_block *s,
+	const void *in,
+	void *out,
+	size_t n
 )
 {
-	kripto_block *s;
+	__m128i x0;
+	__m128i x1;
+	__m128i x2;
+	__m128i x3;
+	__m128i x4;
+	__m128i x5;
+	__m128i x6;
+	__m128i x7;
+	__m128i t;
+	unsigned int i;
 
-	if(!r)
+	AESNI_X8(_mm_aesenc_si128, _mm_aesenclast_si128, s->k);
+
+	for(; n; n--)
 	{
-		r = 6 + ((key_len + 3) >> 2);
-		if(r < 14) r = 14;
+		aesni128_encrypt(s, in, out);
+		in = CU8(in) + 16;
+		out = U8(out) + 16;
 	}
-
-	s = malloc(sizeof(kripto_block) + ((r + 1) << 6));
-	if(!s) return 0;
-
-	s->obj.desc = kripto_block_rijndael256;
-	s->size = sizeof(kripto_block) + ((r + 1) << 6);
-	s->rounds = r;
-	s->k = (uint32_t *)((uint8_t *)s + sizeof(kripto_block));
-	s->dk = s->k + ((r + 1) << 3);
-
-	rijndael_setup(s, key, key_len, 32);
-
-	return s;
 }
 
-static kripto_block *rijndael256_recreate
+KRIPTO_TARGET("aes,sse2")
+static void aesni128_decrypt_blocks
 (
-	kripto_block *s,
-	unsigned int r,
-	const void *key,
-	unsigned int key_len
+	const kripto_block *s,
+	const void *in,
+	void *out,
+	size_t n
 )
 {
-	if(!r)
+	__m128i x0;
+	__m128i x1;
+	__m128i x2;
+	__m128i x3;
+	__m128i x4;
+	__m128i x5;
+	__m128i x6;
+	__m128i x7;
+	__m128i t;
+	unsigned int i;
+
+	AESNI_X8(_mm_aesdec_si128, _mm_aesdeclast_si128, s->dk);
+
+	for(; n; n--)
 	{
-		r = 6 + ((key_len + 3) >> 2);
-		if(r < 14) r = 14;
+		aesni128_decrypt(s, in, out);
+		in = CU8(in) + 16;
+		out = U8(out) + 16;
+	}
+}
+
+static const struct rijndael_impl aesni128 =
+{
+	&aesni128_encrypt,
+	&aesni128_decrypt,
+	&aesni128_encrypt_blocks,
+	&aesni128_decrypt_blocks
+};
+
+/*
+ * Rijndael-256 with AES-NI, both 128-bit halves go through AESENC. Its
+ * ShiftRows is undone and the wider one (shifts 0, 1, 3, 4) done instead
+ * by exchanging bytes between the halves with PBLENDVB and one PSHUFB.
+ */
+
+static const uint8_t aesni256_blend[2][16] =
+{
+	{
+		0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80,
+		0x00, 0x00, 0x80, 0x80, 0x00, 0x00, 0x00, 0x80
+	},
+	{
+		0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x80, 0x80,
+		0x00, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80
+	}
+};
+
+static const uint8_t aesni256_shuffle[2][16] =
+{
+	{0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13, 2, 3},
+	{0, 1, 14, 15, 4, 5, 2, 3, 8, 9, 6, 7, 12, 13, 10, 11}
+};
+
+#define AESNI256_ROUND(F, X0, X1, K, I)								\
+{																	\
+	t = _mm_blendv_epi8(X0, X1, m);									\
+	X1 = _mm_blendv_epi8(X1, X0, m);								\
+	X0 = F(_mm_shuffle_epi8(t, p), RK(K, (I) << 1));				\
+	X1 = F(_mm_shuffle_epi8(X1, p), RK(K, ((I) << 1) + 1));			\
+}
+
+KRIPTO_TARGET("aes,sse4.1")
+static void aesni256_encrypt
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct
+)
+{
+	const __m128i m = LOADU(aesni256_blend[0]);
+	const __m128i p = LOADU(aesni256_shuffle[0]);
+	__m128i x0;
+	__m128i x1;
+	__m128i t;
+	unsigned int i;
+
+	x0 = _mm_xor_si128(LOADU(pt), RK(s->k, 0));
+	x1 = _mm_xor_si128(LOADU(CU8(pt) + 16), RK(s->k, 1));
+
+	for(i = 1; i < s->rounds; i++)
+		AESNI256_ROUND(_mm_aesenc_si128, x0, x1, s->k, i);
+
+	AESNI256_ROUND(_mm_aesenclast_si128, x0, x1, s->k, i);
+
+	STOREU(ct, x0);
+	STOREU(U8(ct) + 16, x1);
+}
+
+KRIPTO_TARGET("aes,sse4.1")
+static void aesni256_decrypt
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt
+)
+{
+	const __m128i m = LOADU(aesni256_blend[1]);
+	const __m128i p = LOADU(aesni256_shuffle[1]);
+	__m128i x0;
+	__m128i x1;
+	__m128i t;
+	unsigned int i;
+
+	x0 = _mm_xor_si128(LOADU(ct), RK(s->dk, 0));
+	x1 = _mm_xor_si128(LOADU(CU8(ct) + 16), RK(s->dk, 1));
+
+	for(i = 1; i < s->rounds; i++)
+		AESNI256_ROUND(_mm_aesdec_si128, x0, x1, s->dk, i);
+
+	AESNI256_ROUND(_mm_aesdeclast_si128, x0, x1, s->dk, i);
+
+	STOREU(pt, x0);
+	STOREU(U8(pt) + 16, x1);
+}
+
+/* 4 blocks (8 halves) in flight */
+#define AESNI256_X4(F, L, K)										\
+{																	\
+	for(; n >= 4; n -= 4)											\
+	{																\
+		x0 = _mm_xor_si128(LOADU(CU8(in)), RK(K, 0));				\
+		x1 = _mm_xor_si128(LOADU(CU8(in) + 16), RK(K, 1));			\
+		x2 = _mm_xor_si128(LOADU(CU8(in) + 32), RK(K, 0));			\
+		x3 = _mm_xor_si128(LOADU(CU8(in) + 48), RK(K, 1));			\
+		x4 = _mm_xor_si128(LOADU(CU8(in) + 64), RK(K, 0));			\
+		x5 = _mm_xor_si128(LOADU(CU8(in) + 80), RK(K, 1));			\
+		x6 = _mm_xor_si128(LOADU(CU8(in) + 96), RK(K, 0));			\
+		x7 = _mm_xor_si128(LOADU(CU8(in) + 112), RK(K, 1));			\
+																	\
+		for(i = 1; i < s->rounds; i++)								\
+		{															\
+			AESNI256_ROUND(F, x0, x1, K, i);						\
+			AESNI256_ROUND(F, x2, x3, K, i);						\
+			AESNI256_ROUND(F, x4, x5, K, i);						\
+			AESNI256_ROUND(F, x6, x7, K, i);						\
+		}															\
+																	\
+		AESNI256_ROUND(L, x0, x1, K, i);							\
+		AESNI256_ROUND(L, x2, x3, K, i);							\
+		AESNI256_ROUND(L, x4, x5, K, i);							\
+		AESNI256_ROUND(L, x6, x7, K, i);							\
+																	\
+		STOREU(U8(out), x0);										\
+		STOREU(U8(out) + 16, x1);									\
+		STOREU(U8(out) + 32, x2);									\
+		STOREU(U8(out) + 48, x3);									\
+		STOREU(U8(out) + 64, x4);									\
+		STOREU(U8(out) + 80, x5);									\
+		STOREU(U8(out) + 96, x6);									\
+		STOREU(U8(out) + 112, x7);									\
+																	\
+		in = CU8(in) + 128;											\
+		out = U8(out) + 128;										\
+	}																\
+}
+
+KRIPTO_TARGET("aes,sse4.1")
+static void aesni256_encrypt_blocks
+(
+	const kripto_block *s,
+	const void *in,
+	void *out,
+	size_t n
+)
+{
+	const __m128i m = LOADU(aesni256_blend[0]);
+	const __m128i p = LOADU(aesni256_shuffle[0]);
+	__m128i x0;
+	__m128i x1;
+	__m128i x2;
+	__m128i x3;
+	__m128i x4;
+	__m128i x5;
+	__m128i x6;
+	__m128i x7;
+	__m128i t;
+	unsigned int i;
+
+	AESNI256_X4(_mm_aesenc_si128, _mm_aesenclast_si128, s->k);
+
+	for(; n; n--)
+	{
+		aesni256_encrypt(s, in, out);
+		in = CU8(in) + 32;
+		out = U8(out) + 32;
+	}
+}
+
+KRIPTO_TARGET("aes,sse4.1")
+static void aesni256_decrypt_blocks
+(
+	const kripto_block *s,
+	const void *in,
+	void *out,
+	size_t n
+)
+{
+	const __m128i m = LOADU(aesni256_blend[1]);
+	const __m128i p = LOADU(aesni256_shuffle[1]);
+	__m128i x0;
+	__m128i x1;
+	__m128i x2;
+	__m128i x3;
+	__m128i x4;
+	__m128i x5;
+	__m128i x6;
+	__m128i x7;
+	__m128i t;
+	unsigned int i;
+
+	AESNI256_X4(_mm_aesdec_si128, _mm_aesdeclast_si128, s->dk);
+
+	for(; n; n--)
+	{
+		aesni256_decrypt(s, in, out);
+		in = CU8(in) + 32;
+		out = U8(out) + 32;
+	}
+}
+
+static const struct rijndael_impl aesni256 =
+{
+	&aesni256_encrypt,
+	&aesni256_decrypt,
+	&aesni256_encrypt_blocks,
+	&aesni256_decrypt_blocks
+};
+
+/*
+ * SSSE3, constant time
+ *
+ * Single blocks use PSHUFB as 16-entry table lookups: SubBytes works in
+ * GF((2^4)^2), where inversion needs only nibble tables (log, exp and
+ * square). Groups of 8 blocks are bitsliced, each register holds one bit
+ * of every byte of all 8 blocks and SubBytes is the Boyar-Peralta
+ * circuit. Both use round keys in memory byte order.
+ */
+
+static const uint8_t vp_log[16] =
+{
+	0x90, 0x00, 0x01, 0x04, 0x02, 0x08, 0x05, 0x0A,
+	0x03, 0x0E, 0x09, 0x07, 0x06, 0x0D, 0x0B, 0x0C
+};
+
+static const uint8_t vp_loginv[16] =
+{
+	0x90, 0x00, 0x0E, 0x0B, 0x0D, 0x07, 0x0A, 0x05,
+	0x0C, 0x01, 0x06, 0x08, 0x09, 0x02, 0x04, 0x03
+};
+
+static const uint8_t vp_exp0[16] =
+{
+	0x01, 0x02, 0x04, 0x08, 0x03, 0x06, 0x0C, 0x0B,
+	0x05, 0x0A, 0x07, 0x0E, 0x0F, 0x0D, 0x09, 0x01
+};
+
+static const uint8_t vp_exp1[16] =
+{
+	0x02, 0x04, 0x08, 0x03, 0x06, 0x0C, 0x0B, 0x05,
+	0x0A, 0x07, 0x0E, 0x0F, 0x0D, 0x00, 0x00, 0x00
+};
+
+static const uint8_t vp_sq[16] =
+{
+	0x00, 0x01, 0x04, 0x05, 0x03, 0x02, 0x07, 0x06,
+	0x0C, 0x0D, 0x08, 0x09, 0x0F, 0x0E, 0x0B, 0x0A
+};
+
+static const uint8_t vp_sql[16] =
+{
+	0x00, 0x08, 0x06, 0x0E, 0x0B, 0x03, 0x0D, 0x05,
+	0x0A, 0x02, 0x0C, 0x04, 0x01, 0x09, 0x07, 0x0F
+};
+
+static const uint8_t vp_enc[6][16] =
+{
+	{
+		0x00, 0x00, 0x02, 0x02, 0x04, 0x04, 0x06, 0x06,
+		0x04, 0x04, 0x06, 0x06, 0x00, 0x00, 0x02, 0x02
+	},
+	{
+		0x00, 0x03, 0x0D, 0x0E, 0x03, 0x00, 0x0E, 0x0D,
+		0x0E, 0x0D, 0x03, 0x00, 0x0D, 0x0E, 0x00, 0x03
+	},
+	{
+		0x00, 0x01, 0x00, 0x01, 0x06, 0x07, 0x06, 0x07,
+		0x0C, 0x0D, 0x0C, 0x0D, 0x0A, 0x0B, 0x0A, 0x0B
+	},
+	{
+		0x00, 0x0C, 0x05, 0x09, 0x04, 0x08, 0x01, 0x0D,
+		0x05, 0x09, 0x00, 0x0C, 0x01, 0x0D, 0x04, 0x08
+	},
+	{
+		0x63, 0x7C, 0xD1, 0xCE, 0xC8, 0xD7, 0x7A, 0x65,
+		0x55, 0x4A, 0xE7, 0xF8, 0xFE, 0xE1, 0x4C, 0x53
+	},
+	{
+		0x00, 0x52, 0x3E, 0x6C, 0x65, 0x37, 0x5B, 0x09,
+		0x60, 0x32, 0x5E, 0x0C, 0x05, 0x57, 0x3B, 0x69
+	}
+};
+
+static const uint8_t vp_dec[6][16] =
+{
+	{
+		0x04, 0x01, 0x0D, 0x08, 0x0D, 0x08, 0x04, 0x01,
+		0x06, 0x03, 0x0F, 0x0A, 0x0F, 0x0A, 0x06, 0x03
+	},
+	{
+		0x00, 0x07, 0x07, 0x00, 0x0F, 0x08, 0x08, 0x0F,
+		0x09, 0x0E, 0x0E, 0x09, 0x06, 0x01, 0x01, 0x06
+	},
+	{
+		0x07, 0x0F, 0x08, 0x00, 0x0F, 0x07, 0x00, 0x08,
+		0x0F, 0x07, 0x00, 0x08, 0x07, 0x0F, 0x08, 0x00
+	},
+	{
+		0x00, 0x06, 0x09, 0x0F, 0x09, 0x0F, 0x00, 0x06,
+		0x02, 0x04, 0x0B, 0x0D, 0x0B, 0x0D, 0x02, 0x04
+	},
+	{
+		0x00, 0x01, 0x5C, 0x5D, 0xE0, 0xE1, 0xBC, 0xBD,
+		0x50, 0x51, 0x0C, 0x0D, 0xB0, 0xB1, 0xEC, 0xED
+	},
+	{
+		0x00, 0xA2, 0x02, 0xA0, 0xB8, 0x1A, 0xBA, 0x18,
+		0xDB, 0x79, 0xD9, 0x7B, 0x63, 0xC1, 0x61, 0xC3
+	}
+};
+
+static const uint8_t sr128[16] =
+{
+	0x00, 0x05, 0x0A, 0x0F, 0x04, 0x09, 0x0E, 0x03,
+	0x08, 0x0D, 0x02, 0x07, 0x0C, 0x01, 0x06, 0x0B
+};
+
+static const uint8_t isr128[16] =
+{
+	0x00, 0x0D, 0x0A, 0x07, 0x04, 0x01, 0x0E, 0x0B,
+	0x08, 0x05, 0x02, 0x0F, 0x0C, 0x09, 0x06, 0x03
+};
+
+static const uint8_t sr256[2][16] =
+{
+	{
+		0x00, 0x05, 0x0E, 0x80, 0x04, 0x09, 0x80, 0x80,
+		0x08, 0x0D, 0x80, 0x80, 0x0C, 0x80, 0x80, 0x80
+	},
+	{
+		0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x02, 0x07,
+		0x80, 0x80, 0x06, 0x0B, 0x80, 0x01, 0x0A, 0x0F
+	}
+};
+
+static const uint8_t isr256[2][16] =
+{
+	{
+		0x00, 0x80, 0x80, 0x80, 0x04, 0x01, 0x80, 0x80,
+		0x08, 0x05, 0x80, 0x80, 0x0C, 0x09, 0x02, 0x80
+	},
+	{
+		0x80, 0x0D, 0x06, 0x03, 0x80, 0x80, 0x0A, 0x07,
+		0x80, 0x80, 0x0E, 0x0B, 0x80, 0x80, 0x80, 0x0F
+	}
+};
+
+static const uint8_t rot1[16] =
+{
+	0x01, 0x02, 0x03, 0x00, 0x05, 0x06, 0x07, 0x04,
+	0x09, 0x0A, 0x0B, 0x08, 0x0D, 0x0E, 0x0F, 0x0C
+};
+
+static const uint8_t rot2[16] =
+{
+	0x02, 0x03, 0x00, 0x01, 0x06, 0x07, 0x04, 0x05,
+	0x0A, 0x0B, 0x08, 0x09, 0x0E, 0x0F, 0x0C, 0x0D
+};
+
+#define T(X) LOADU(X)
+
+KRIPTO_TARGET("ssse3")
+static __m128i ssse3_mul(__m128i la, __m128i lb)
+{
+	__m128i x;
+
+	/* log(0) = 0x90, so PSHUFB returns 0 for a zero factor */
+	x = _mm_adds_epu8(la, lb);
+
+	return _mm_xor_si128
+	(
+		_mm_shuffle_epi8(T(vp_exp0), _mm_adds_epu8(x, _mm_set1_epi8(0x70))),
+		_mm_shuffle_epi8(T(vp_exp1), _mm_sub_epi8(x, _mm_set1_epi8(0x10)))
+	);
+}
+
+/* SubBytes (vp_enc) or InvSubBytes (vp_dec) */
+KRIPTO_TARGET("ssse3")
+static __m128i ssse3_sub(__m128i x, const uint8_t (*m)[16])
+{
+	const __m128i f = _mm_set1_epi8(0x0F);
+	__m128i h;
+	__m128i l;
+	__m128i a;
+	__m128i b;
+	__m128i la;
+	__m128i lb;
+	__m128i ld;
+
+	l = _mm_and_si128(x, f);
+	h = _mm_and_si128(_mm_srli_epi16(x, 4), f);
+
+	/* to tower field, x = a * y + b */
+	a = _mm_xor_si128(_mm_shuffle_epi8(T(m[0]), l), _mm_shuffle_epi8(T(m[1]), h));
+	b = _mm_xor_si128(_mm_shuffle_epi8(T(m[2]), l), _mm_shuffle_epi8(T(m[3]), h));
+
+	la = _mm_shuffle_epi8(T(vp_log), a);
+	lb = _mm_shuffle_epi8(T(vp_log), b);
+
+	/* 1 / (a * y + b) = (a * y + a + b) / (a^2 * lambda + a * b + b^2) */
+	ld = _mm_xor_si128(_mm_shuffle_epi8(T(vp_sql), a), _mm_shuffle_epi8(T(vp_sq), b));
+	ld = _mm_xor_si128(ld, ssse3_mul(la, lb));
+	ld = _mm_shuffle_epi8(T(vp_loginv), ld);
+
+	h = ssse3_mul(la, ld);
+	l = ssse3_mul(_mm_shuffle_epi8(T(vp_log), _mm_xor_si128(a, b)), ld);
+
+	/* back from tower field (and affine transform) */
+	return _mm_xor_si128(_mm_shuffle_epi8(T(m[4]), l), _mm_shuffle_epi8(T(m[5]), h));
+}
+
+KRIPTO_TARGET("ssse3")
+static __m128i ssse3_xtime(__m128i x)
+{
+	return _mm_xor_si128
+	(
+		_mm_add_epi8(x, x),
+		_mm_and_si128
+		(
+			_mm_cmplt_epi8(x, _mm_setzero_si128()),
+			_mm_set1_epi8(0x1B)
+		)
+	);
+}
+
+KRIPTO_TARGET("ssse3")
+static __m128i ssse3_mix(__m128i x)
+{
+	__m128i r;
+
+	/* 2 * (x0 + x1) + x1 + (x2 + x3) */
+	r = _mm_shuffle_epi8(x, T(rot1));
+	x = _mm_xor_si128(x, r);
+	r = _mm_xor_si128(r, _mm_shuffle_epi8(x, T(rot2)));
+
+	return _mm_xor_si128(ssse3_xtime(x), r);
+}
+
+KRIPTO_TARGET("ssse3")
+static __m128i ssse3_invmix(__m128i x)
+{
+	__m128i t;
+
+	t = _mm_xor_si128(x, _mm_shuffle_epi8(x, T(rot2)));
+	x = _mm_xor_si128(x, ssse3_xtime(ssse3_xtime(t)));
+
+	return ssse3_mix(x);
+}
+
+KRIPTO_TARGET("ssse3")
+static void ssse3_128_encrypt
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct
+)
+{
+	__m128i x;
+	unsigned int i;
+
+	x = _mm_xor_si128(LOADU(pt), RK(s->k, 0));
+
+	for(i = 1; i < s->rounds; i++)
+	{
+		x = _mm_shuffle_epi8(ssse3_sub(x, vp_enc), T(sr128));
+		x = _mm_xor_si128(ssse3_mix(x), RK(s->k, i));
+	}
+
+	x = _mm_shuffle_epi8(ssse3_sub(x, vp_enc), T(sr128));
+	STOREU(ct, _mm_xor_si128(x, RK(s->k, i)));
+}
+
+KRIPTO_TARGET("ssse3")
+static void ssse3_128_decrypt
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt
+)
+{
+	__m128i x;
+	unsigned int i;
+
+	x = _mm_xor_si128(LOADU(ct), RK(s->k, s->rounds));
+
+	for(i = s->rounds - 1; i; i--)
+	{
+		x = ssse3_sub(_mm_shuffle_epi8(x, T(isr128)), vp_dec);
+		x = ssse3_invmix(_mm_xor_si128(x, RK(s->k, i)));
+	}
+
+	x = ssse3_sub(_mm_shuffle_epi8(x, T(isr128)), vp_dec);
+	STOREU(pt, _mm_xor_si128(x, RK(s->k, 0)));
+}
+
+/* Rijndael-256, columns 0-3 in x0 and 4-7 in x1 */
+
+#define SR256(X0, X1, M)											\
+{																	\
+	t = _mm_or_si128												\
+	(																\
+		_mm_shuffle_epi8(X0, T(M[0])),								\
+		_mm_shuffle_epi8(X1, T(M[1]))								\
+	);																\
+	X1 = _mm_or_si128												\
+	(																\
+		_mm_shuffle_epi8(X1, T(M[0])),								\
+		_mm_shuffle_epi8(X0, T(M[1]))								\
+	);																\
+	X0 = t;															\
+}
+
+KRIPTO_TARGET("ssse3")
+static void ssse3_256_encrypt
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct
+)
+{
+	__m128i x0;
+	__m128i x1;
+	__m128i t;
+	unsigned int i;
+
+	x0 = _mm_xor_si128(LOADU(pt), RK(s->k, 0));
+	x1 = _mm_xor_si128(LOADU(CU8(pt) + 16), RK(s->k, 1));
+
+	for(i = 1; i < s->rounds; i++)
+	{
+		x0 = ssse3_sub(x0, vp_enc);
+		x1 = ssse3_sub(x1, vp_enc);
+		SR256(x0, x1, sr256);
+		x0 = _mm_xor_si128(ssse3_mix(x0), RK(s->k, i << 1));
+		x1 = _mm_xor_si128(ssse3_mix(x1), RK(s->k, (i << 1) + 1));
+	}
+
+	x0 = ssse3_sub(x0, vp_enc);
+	x1 = ssse3_sub(x1, vp_enc);
+	SR256(x0, x1, sr256);
+	STOREU(ct, _mm_xor_si128(x0, RK(s->k, i << 1)));
+	STOREU(U8(ct) + 16, _mm_xor_si128(x1, RK(s->k, (i << 1) + 1)));
+}
+
+KRIPTO_TARGET("ssse3")
+static void ssse3_256_decrypt
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt
+)
+{
+	__m128i x0;
+	__m128i x1;
+	__m128i t;
+	unsigned int i;
+
+	x0 = _mm_xor_si128(LOADU(ct), RK(s->k, s->rounds << 1));
+	x1 = _mm_xor_si128(LOADU(CU8(ct) + 16), RK(s->k, (s->rounds << 1) + 1));
+
+	for(i = s->rounds - 1; i; i--)
+	{
+		SR256(x0, x1, isr256);
+		x0 = ssse3_sub(x0, vp_dec);
+		x1 = ssse3_sub(x1, vp_dec);
+		x0 = ssse3_invmix(_mm_xor_si128(x0, RK(s->k, i << 1)));
+		x1 = ssse3_invmix(_mm_xor_si128(x1, RK(s->k, (i << 1) + 1)));
+	}
+
+	SR256(x0, x1, isr256);
+	x0 = ssse3_sub(x0, vp_dec);
+	x1 = ssse3_sub(x1, vp_dec);
+	STOREU(pt, _mm_xor_si128(x0, RK(s->k, 0)));
+	STOREU(U8(pt) + 16, _mm_xor_si128(x1, RK(s->k, 1)));
+}
+
+/* bitsliced, q[i] holds bit i of every byte, bit j of a byte is block j */
+
+#define XOR(X, Y) _mm_xor_si128(X, Y)
+#define AND(X, Y) _mm_and_si128(X, Y)
+#define NOT(X) _mm_xor_si128(X, _mm_set1_epi8(-1))
+
+#define SWAPMOVE(X, Y, N, M)										\
+{																	\
+	t = _mm_and_si128(_mm_xor_si128(_mm_srli_epi64(X, N), Y), M);	\
+	Y = _mm_xor_si128(Y, t);										\
+	X = _mm_xor_si128(X, _mm_slli_epi64(t, N));						\
+}
+
+/* transpose 8x8 bit matrices, its own inverse */
+KRIPTO_TARGET("ssse3")
+static void bitslice_ortho(__m128i *q)
+{
+	const __m128i m1 = _mm_set1_epi8(0x55);
+	const __m128i m2 = _mm_set1_epi8(0x33);
+	const __m128i m4 = _mm_set1_epi8(0x0F);
+	__m128i t;
+
+	SWAPMOVE(q[0], q[1], 1, m1);
+	SWAPMOVE(q[2], q[3], 1, m1);
+	SWAPMOVE(q[4], q[5], 1, m1);
+	SWAPMOVE(q[6], q[7], 1, m1);
+
+	SWAPMOVE(q[0], q[2], 2, m2);
+	SWAPMOVE(q[1], q[3], 2, m2);
+	SWAPMOVE(q[4], q[6], 2, m2);
+	SWAPMOVE(q[5], q[7], 2, m2);
+
+	SWAPMOVE(q[0], q[4], 4, m4);
+	SWAPMOVE(q[1], q[5], 4, m4);
+	SWAPMOVE(q[2], q[6], 4, m4);
+	SWAPMOVE(q[3], q[7], 4, m4);
+}
+
+/* Boyar-Peralta AES S-box circuit */
+KRIPTO_TARGET("ssse3")
+static void bitslice_sub(__m128i *q)
+{
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7;
+	__m128i y1, y2, y3, y4, y5, y6, y7, y8;
+	__m128i y9, y10, y11, y12, y13, y14, y15, y16;
+	__m128i y17, y18, y19, y20, y21;
+	__m128i t0, t1, t2, t3, t4, t5, t6, t7;
+	__m128i t8, t9, t10, t11, t12, t13, t14, t15;
+	__m128i t16, t17, t18, t19, t20, t21, t22, t23;
+	__m128i t24, t25, t26, t27, t28, t29, t30, t31;
+	__m128i t32, t33, t34, t35, t36, t37, t38, t39;
+	__m128i t40, t41, t42, t43, t44, t45, t46, t47;
+	__m128i t48, t49, t50, t51, t52, t53, t54, t55;
+	__m128i t56, t57, t58, t59, t60, t61, t62, t63;
+	__m128i t64, t65, t66, t67;
+	__m128i z0, z1, z2, z3, z4, z5, z6, z7;
+	__m128i z8, z9, z10, z11, z12, z13, z14, z15;
+	__m128i z16, z17;
+	__m128i s0, s1, s2, s3, s4, s5, s6, s7;
+
+	x0 = q[7];
+	x1 = q[6];
+	x2 = q[5];
+	x3 = q[4];
+	x4 = q[3];
+	x5 = q[2];
+	x6 = q[1];
+	x7 = q[0];
+
+	/* top linear transformation */
+	y14 = XOR(x3, x5);
+	y13 = XOR(x0, x6);
+	y9 = XOR(x0, x3);
+	y8 = XOR(x0, x5);
+	t0 = XOR(x1, x2);
+	y1 = XOR(t0, x7);
+	y4 = XOR(y1, x3);
+	y12 = XOR(y13, y14);
+	y2 = XOR(y1, x0);
+	y5 = XOR(y1, x6);
+	y3 = XOR(y5, y8);
+	t1 = XOR(x4, y12);
+	y15 = XOR(t1, x5);
+	y20 = XOR(t1, x1);
+	y6 = XOR(y15, x7);
+	y10 = XOR(y15, t0);
+	y11 = XOR(y20, y9);
+	y7 = XOR(x7, y11);
+	y17 = XOR(y10, y11);
+	y19 = XOR(y10, y8);
+	y16 = XOR(t0, y11);
+	y21 = XOR(y13, y16);
+	y18 = XOR(x0, y16);
+
+	/* non-linear section */
+	t2 = AND(y12, y15);
+	t3 = AND(y3, y6);
+	t4 = XOR(t3, t2);
+	t5 = AND(y4, x7);
+	t6 = XOR(t5, t2);
+	t7 = AND(y13, y16);
+	t8 = AND(y5, y1);
+	t9 = XOR(t8, t7);
+	t10 = AND(y2, y7);
+	t11 = XOR(t10, t7);
+	t12 = AND(y9, y11);
+	t13 = AND(y14, y17);
+	t14 = XOR(t13, t12);
+	t15 = AND(y8, y10);
+	t16 = XOR(t15, t12);
+	t17 = XOR(t4, t14);
+	t18 = XOR(t6, t16);
+	t19 = XOR(t9, t14);
+	t20 = XOR(t11, t16);
+	t21 = XOR(t17, y20);
+	t22 = XOR(t18, y19);
+	t23 = XOR(t19, y21);
+	t24 = XOR(t20, y18);
+	t25 = XOR(t21, t22);
+	t26 = AND(t21, t23);
+	t27 = XOR(t24, t26);
+	t28 = AND(t25, t27);
+	t29 = XOR(t28, t22);
+	t30 = XOR(t23, t24);
+	t31 = XOR(t22, t26);
+	t32 = AND(t31, t30);
+	t33 = XOR(t32, t24);
+	t34 = XOR(t23, t33);
+	t35 = XOR(t27, t33);
+	t36 = AND(t24, t35);
+	t37 = XOR(t36, t34);
+	t38 = XOR(t27, t36);
+	t39 = AND(t29, t38);
+	t40 = XOR(t25, t39);
+	t41 = XOR(t40, t37);
+	t42 = XOR(t29, t33);
+	t43 = XOR(t29, t40);
+	t44 = XOR(t33, t37);
+	t45 = XOR(t42, t41);
+	z0 = AND(t44, y15);
+	z1 = AND(t37, y6);
+	z2 = AND(t33, x7);
+	z3 = AND(t43, y16);
+	z4 = AND(t40, y1);
+	z5 = AND(t29, y7);
+	z6 = AND(t42, y11);
+	z7 = AND(t45, y17);
+	z8 = AND(t41, y10);
+	z9 = AND(t44, y12);
+	z10 = AND(t37, y3);
+	z11 = AND(t33, y4);
+	z12 = AND(t43, y13);
+	z13 = AND(t40, y5);
+	z14 = AND(t29, y2);
+	z15 = AND(t42, y9);
+	z16 = AND(t45, y14);
+	z17 = AND(t41, y8);
+
+	/* bottom linear transformation */
+	t46 = XOR(z15, z16);
+	t47 = XOR(z10, z11);
+	t48 = XOR(z5, z13);
+	t49 = XOR(z9, z10);
+	t50 = XOR(z2, z12);
+	t51 = XOR(z2, z5);
+	t52 = XOR(z7, z8);
+	t53 = XOR(z0, z3);
+	t54 = XOR(z6, z7);
+	t55 = XOR(z16, z17);
+	t56 = XOR(z12, t48);
+	t57 = XOR(t50, t53);
+	t58 = XOR(z4, t46);
+	t59 = XOR(z3, t54);
+	t60 = XOR(t46, t57);
+	t61 = XOR(z14, t57);
+	t62 = XOR(t52, t58);
+	t63 = XOR(t49, t58);
+	t64 = XOR(z4, t59);
+	t65 = XOR(t61, t62);
+	t66 = XOR(z1, t63);
+	s0 = XOR(t59, t63);
+	s6 = XOR(t56, NOT(t62));
+	s7 = XOR(t48, NOT(t60));
+	t67 = XOR(t64, t65);
+	s3 = XOR(t53, t66);
+	s4 = XOR(t51, t66);
+	s5 = XOR(t47, t65);
+	s1 = XOR(t64, NOT(s3));
+	s2 = XOR(t55, NOT(t67));
+
+	q[7] = s0;
+	q[6] = s1;
+	q[5] = s2;
+	q[4] = s3;
+	q[3] = s4;
+	q[2] = s5;
+	q[1] = s6;
+	q[0] = s7;
+}
+
+/* inverse affine transform, InvSubBytes = A' SubBytes A' */
+KRIPTO_TARGET("ssse3")
+static void bitslice_invaffine(__m128i *q)
+{
+	__m128i x[8];
+	unsigned int i;
+
+	for(i = 0; i < 8; i++) x[i] = q[i];
+
+	for(i = 0; i < 8; i++)
+		q[i] = XOR(XOR(x[(i + 2) & 7], x[(i + 5) & 7]), x[(i + 7) & 7]);
+
+	/* 0x05 */
+	q[0] = NOT(q[0]);
+	q[2] = NOT(q[2]);
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_invsub(__m128i *q)
+{
+	bitslice_invaffine(q);
+	bitslice_sub(q);
+	bitslice_invaffine(q);
+}
+
+/* multiply by 2 in GF(2^8), bit planes */
+KRIPTO_TARGET("ssse3")
+static void bitslice_xtime(__m128i *x, const __m128i *a)
+{
+	x[0] = a[7];
+	x[1] = XOR(a[0], a[7]);
+	x[2] = a[1];
+	x[3] = XOR(a[2], a[7]);
+	x[4] = XOR(a[3], a[7]);
+	x[5] = a[4];
+	x[6] = a[5];
+	x[7] = a[6];
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_mix(__m128i *q)
+{
+	__m128i r[8];
+	__m128i a[8];
+	__m128i x[8];
+	unsigned int i;
+
+	for(i = 0; i < 8; i++)
+	{
+		r[i] = _mm_shuffle_epi8(q[i], T(rot1));
+		a[i] = XOR(q[i], r[i]);
+		r[i] = XOR(r[i], _mm_shuffle_epi8(a[i], T(rot2)));
+	}
+
+	bitslice_xtime(x, a);
+
+	for(i = 0; i < 8; i++) q[i] = XOR(x[i], r[i]);
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_invmix(__m128i *q)
+{
+	__m128i a[8];
+	__m128i x[8];
+	unsigned int i;
+
+	for(i = 0; i < 8; i++)
+		a[i] = XOR(q[i], _mm_shuffle_epi8(q[i], T(rot2)));
+
+	bitslice_xtime(x, a);
+	bitslice_xtime(a, x);
+
+	for(i = 0; i < 8; i++) q[i] = XOR(q[i], a[i]);
+
+	bitslice_mix(q);
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_shift(__m128i *q, const uint8_t *m)
+{
+	unsigned int i;
+
+	for(i = 0; i < 8; i++) q[i] = _mm_shuffle_epi8(q[i], T(m));
+}
+
+/* every bit of the round key spread over all 8 blocks */
+KRIPTO_TARGET("ssse3")
+static void bitslice_key(__m128i *q, const uint8_t *k)
+{
+	__m128i x;
+	__m128i b;
+	unsigned int i;
+
+	x = LOADU(k);
+
+	for(i = 0; i < 8; i++)
+	{
+		b = _mm_set1_epi8((char)(1 << i));
+		q[i] = XOR(q[i], _mm_cmpeq_epi8(AND(x, b), b));
+	}
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_load(__m128i *q, const void *in, unsigned int bs)
+{
+	unsigned int i;
+
+	for(i = 0; i < 8; i++) q[i] = LOADU(CU8(in) + i * bs);
+
+	bitslice_ortho(q);
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_store(__m128i *q, void *out, unsigned int bs)
+{
+	unsigned int i;
+
+	bitslice_ortho(q);
+
+	for(i = 0; i < 8; i++) STOREU(U8(out) + i * bs, q[i]);
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_128_encrypt
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct
+)
+{
+	__m128i q[8];
+	unsigned int i;
+
+	bitslice_load(q, pt, 16);
+	bitslice_key(q, CU8(s->k));
+
+	for(i = 1; i < s->rounds; i++)
+	{
+		bitslice_sub(q);
+		bitslice_shift(q, sr128);
+		bitslice_mix(q);
+		bitslice_key(q, CU8(s->k) + (i << 4));
+	}
+
+	bitslice_sub(q);
+	bitslice_shift(q, sr128);
+	bitslice_key(q, CU8(s->k) + (i << 4));
+
+	bitslice_store(q, ct, 16);
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_128_decrypt
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt
+)
+{
+	__m128i q[8];
+	unsigned int i;
+
+	bitslice_load(q, ct, 16);
+	bitslice_key(q, CU8(s->k) + (s->rounds << 4));
+
+	for(i = s->rounds - 1; i; i--)
+	{
+		bitslice_shift(q, isr128);
+		bitslice_invsub(q);
+		bitslice_key(q, CU8(s->k) + (i << 4));
+		bitslice_invmix(q);
+	}
+
+	bitslice_shift(q, isr128);
+	bitslice_invsub(q);
+	bitslice_key(q, CU8(s->k));
+
+	bitslice_store(q, pt, 16);
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_shift256(__m128i *q0, __m128i *q1, const uint8_t (*m)[16])
+{
+	__m128i t;
+	unsigned int i;
+
+	for(i = 0; i < 8; i++) SR256(q0[i], q1[i], m);
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_256_encrypt
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct
+)
+{
+	__m128i q0[8];
+	__m128i q1[8];
+	unsigned int i;
+
+	bitslice_load(q0, pt, 32);
+	bitslice_load(q1, CU8(pt) + 16, 32);
+	bitslice_key(q0, CU8(s->k));
+	bitslice_key(q1, CU8(s->k) + 16);
+
+	for(i = 1; i < s->rounds; i++)
+	{
+		bitslice_sub(q0);
+		bitslice_sub(q1);
+		bitslice_shift256(q0, q1, sr256);
+		bitslice_mix(q0);
+		bitslice_mix(q1);
+		bitslice_key(q0, CU8(s->k) + (i << 5));
+		bitslice_key(q1, CU8(s->k) + (i << 5) + 16);
+	}
+
+	bitslice_sub(q0);
+	bitslice_sub(q1);
+	bitslice_shift256(q0, q1, sr256);
+	bitslice_key(q0, CU8(s->k) + (i << 5));
+	bitslice_key(q1, CU8(s->k) + (i << 5) + 16);
+
+	bitslice_store(q0, ct, 32);
+	bitslice_store(q1, U8(ct) + 16, 32);
+}
+
+KRIPTO_TARGET("ssse3")
+static void bitslice_256_decrypt
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt
+)
+{
+	__m128i q0[8];
+	__m128i q1[8];
+	unsigned int i;
+
+	bitslice_load(q0, ct, 32);
+	bitslice_load(q1, CU8(ct) + 16, 32);
+	bitslice_key(q0, CU8(s->k) + (s->rounds << 5));
+	bitslice_key(q1, CU8(s->k) + (s->rounds << 5) + 16);
+
+	for(i = s->rounds - 1; i; i--)
+	{
+		bitslice_shift256(q0, q1, isr256);
+		bitslice_invsub(q0);
+		bitslice_invsub(q1);
+		bitslice_key(q0, CU8(s->k) + (i << 5));
+		bitslice_key(q1, CU8(s->k) + (i << 5) + 16);
+		bitslice_invmix(q0);
+		bitslice_invmix(q1);
+	}
+
+	bitslice_shift256(q0, q1, isr256);
+	bitslice_invsub(q0);
+	bitslice_invsub(q1);
+	bitslice_key(q0, CU8(s->k));
+	bitslice_key(q1, CU8(s->k) + 16);
+
+	bitslice_store(q0, pt, 32);
+	bitslice_store(q1, U8(pt) + 16, 32);
+}
+
+/* 8 blocks bitsliced, the rest one at a time */
+#define SSSE3_BLOCKS(BITSLICE, SINGLE, BS)							\
+{																	\
+	for(; n >= 8; n -= 8)											\
+	{																\
+		BITSLICE(s, in, out);										\
+		in = CU8(in) + ((BS) << 3);									\
+		out = U8(out) + ((BS) << 3);								\
+	}																\
+																	\
+	for(; n; n--)													\
+	{																\
+		SINGLE(s, in, out);											\
+		in = CU8(in) + (BS);										\
+		out = U8(out) + (BS);										\
+	}																\
+}
+
+static void ssse3_128_encrypt_blocks
+(
+	const kripto_block *s,
+	const void *in,
+	void *out,
+	size_t n
+)
+{
+	SSSE3_BLOCKS(bitslice_128_encrypt, ssse3_128_encrypt, 16);
+}
+
+static void ssse3_128_decrypt_blocks
+(
+	const kripto_block *s,
+	const void *in,
+	void *out,
+	size_t n
+)
+{
+	SSSE3_BLOCKS(bitslice_128_decrypt, ssse3_128_decrypt, 16);
+}
+
+static void ssse3_256_encrypt_blocks
+(
+	const kripto_block *s,
+	const void *in,
+	void *out,
+	size_t n
+)
+{
+	SSSE3_BLOCKS(bitslice_256_encrypt, ssse3_256_encrypt, 32);
+}
+
+static void ssse3_256_decrypt_blocks
+(
+	const kripto_block *s,
+	const void *in,
+	void *out,
+	size_t n
+)
+{
+	SSSE3_BLOCKS(bitslice_256_decrypt, ssse3_256_decrypt, 32);
+}
+
+static const struct rijndael_impl ssse3_128 =
+{
+	&ssse3_128_encrypt,
+	&ssse3_128_decrypt,
+	&ssse3_128_encrypt_blocks,
+	&ssse3_128_decrypt_blocks
+};
+
+static const struct rijndael_impl ssse3_256 =
+{
+	&ssse3_256_encrypt,
+	&ssse3_256_decrypt,
+	&ssse3_256_encrypt_blocks,
+	&ssse3_256_decrypt_blocks
+};
+
+#endif
+
+static void rijndael128_setup
+(
+	kripto_block *s,
+	const uint8_t *key,
+	unsigned int key_len
+)
+{
+	#ifdef KRIPTO_X86_SIMD
+	if(kripto_cpu() & KRIPTO_CPU_AES)
+	{
+		s->impl = &aesni128;
+		if(!aesni_setup(s, key, key_len))
+		{
+			rijndael_setup(s, key, key_len, 16);
+			rijndael_tobytes(s, 16);
+		}
+		return;
+	}
+
+	if(kripto_cpu() & KRIPTO_CPU_SSSE3)
+	{
+		s->impl = &ssse3_128;
+		rijndael_setup(s, key, key_len, 16);
+		rijndael_tobytes(s, 16);
+		return;
+	}
+	#endif
+
+	s->impl = &table128;
+	rijndael_setup(s, key, key_len, 16);
+}
+
+static void rijndael_encrypt
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct
+)
+{
+	s->impl->encrypt(s, pt, ct);
+}
+
+static void rijndael_decrypt
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt
+)
+{
+	s->impl->decrypt(s, ct, pt);
+}
+
+static void rijndael_encrypt_blocks
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct,
+	size_t n
+)
+{
+	s->impl->encrypt_blocks(s, pt, ct, n);
+}
+
+static void rijndael_decrypt_blocks
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt,
+	size_t n
+)
+{
+	s->impl->decrypt_blocks(s, ct, pt, n);
+}
+
+static kripto_block *rijndael128_create
+(
+	unsigned int r,
+	const void *key,
+	unsigned int key_len
+)
+{
+	kripto_block *s;
+
+	if(!r)
+	{
+		r = 6 + ((key_len + 3) >> 2);
+		if(r < 10) r = 10;
+	}
+
+	s = malloc(sizeof(kripto_block) + ((r + 1) << 5));
+	if(!s) return 0;
+
+	s->obj.desc = kripto_block_rijndael128;
+	s->size = sizeof(kripto_block) + ((r + 1) << 5);
+	s->rounds = r;
+	s->k = (uint32_t *)((uint8_t *)s + sizeof(kripto_block));
+	s->dk = s->k + ((r + 1) << 2);
+
+	rijndael128_setup(s, key, key_len);
+
+	return s;
+}
+
+static void rijndael_destroy(kripto_block *s)
+{
+	kripto_memwipe(s, s->size);
+	free(s);
+}
+
+static kripto_block *rijndael128_recreate
+(
+	kripto_block *s,
+	unsigned int r,
+	const void *key,
+	unsigned int key_len
+)
+{
+	if(!r)
+	{
+		r = 6 + ((key_len + 3) >> 2);
+		if(r < 10) r = 10;
+	}
+
+	if(sizeof(kripto_block) + ((r + 1) << 5) > s->size)
+	{
+		rijndael_destroy(s);
+		s = rijndael128_create(r, key, key_len);
+	}
+	else
+	{
+		s->rounds = r;
+		rijndael128_setup(s, key, key_len);
+	}
+
+	return s;
+}
+
+static const kripto_block_desc rijndael128 =
+{
+	&rijndael128_create,
+	&rijndael128_recreate,
+	0, /* tweak */
+	&rijndael_encrypt,
+	&rijndael_decrypt,
+	&rijndael_encrypt_blocks,
+	&rijndael_decrypt_blocks,
+	&rijndael_destroy,
+	16, /* block size */
+	32, /* max key */
+	0 /* max tweak */
+};
+
+const kripto_block_desc *const kripto_block_rijndael128 = &rijndael128;
+
+/* rijndael256 */
+
+static void rijndael256_encrypt
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct
+)
+{
+	uint32_t x0;
+	uint32_t x1;
+	uint32_t x2;
+	uint32_t x3;
+	uint32_t x4;
+	uint32_t x5;
+	uint32_t x6;
+	uint32_t x7;
+	uint32_t t0;
+	uint32_t t1;
+	uint32_t t2;
+	uint32_t t3;
+	uint32_t t4;
+	uint32_t t5;
+	uint32_t t6;
+	uint32_t t7;
+	unsigned int i;
+
+	x0 = LOAD32B(CU8(pt)) ^ s->k[0];
+	x1 = LOAD32B(CU8(pt) + 4) ^ s->k[1];
+	x2 = LOAD32B(CU8(pt) + 8) ^ s->k[2];
+	x3 = LOAD32B(CU8(pt) + 12) ^ s->k[3];
+	x4 = LOAD32B(CU8(pt) + 16) ^ s->k[4];
+	x5 = LOAD32B(CU8(pt) + 20) ^ s->k[5];
+	x6 = LOAD32B(CU8(pt) + 24) ^ s->k[6];
+	x7 = LOAD32B(CU8(pt) + 28) ^ s->k[7];
+
+	/* - 1 full rounds */
+	for(i = 8; i < (s->rounds << 3);)
+	{
+		t0 = E(x0, x1, x3, x4) ^ s->k[i++];
+		t1 = E(x1, x2, x4, x5) ^ s->k[i++];
+		t2 = E(x2, x3, x5, x6) ^ s->k[i++];
+		t3 = E(x3, x4, x6, x7) ^ s->k[i++];
+		t4 = E(x4, x5, x7, x0) ^ s->k[i++];
+		t5 = E(x5, x6, x0, x1) ^ s->k[i++];
+		t6 = E(x6, x7, x1, x2) ^ s->k[i++];
+		t7 = E(x7, x0, x2, x3) ^ s->k[i++];
+
+		x0 = t0;
+		x1 = t1;
+		x2 = t2;
+		x3 = t3;
+		x4 = t4;
+		x5 = t5;
+		x6 = t6;
+		x7 = t7;
+	}
+
+	/* last round */
+	t0 = EL(x0, x1, x3, x4) ^ s->k[i++];
+	t1 = EL(x1, x2, x4, x5) ^ s->k[i++];
+	t2 = EL(x2, x3, x5, x6) ^ s->k[i++];
+	t3 = EL(x3, x4, x6, x7) ^ s->k[i++];
+	t4 = EL(x4, x5, x7, x0) ^ s->k[i++];
+	t5 = EL(x5, x6, x0, x1) ^ s->k[i++];
+	t6 = EL(x6, x7, x1, x2) ^ s->k[i++];
+	t7 = EL(x7, x0, x2, x3) ^ s->k[i];
+
+	STORE32B(t0, U8(ct));
+	STORE32B(t1, U8(ct) + 4);
+	STORE32B(t2, U8(ct) + 8);
+	STORE32B(t3, U8(ct) + 12);
+	STORE32B(t4, U8(ct) + 16);
+	STORE32B(t5, U8(ct) + 20);
+	STORE32B(t6, U8(ct) + 24);
+	STORE32B(t7, U8(ct) + 28);
+}
+
+static void rijndael256_decrypt
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt
+)
+{
+	uint32_t x0;
+	uint32_t x1;
+	uint32_t x2;
+	uint32_t x3;
+	uint32_t x4;
+	uint32_t x5;
+	uint32_t x6;
+	uint32_t x7;
+	uint32_t t0;
+	uint32_t t1;
+	uint32_t t2;
+	uint32_t t3;
+	uint32_t t4;
+	uint32_t t5;
+	uint32_t t6;
+	uint32_t t7;
+	unsigned int i;
+
+	x0 = LOAD32B(CU8(ct)) ^ s->dk[0];
+	x1 = LOAD32B(CU8(ct) + 4) ^ s->dk[1];
+	x2 = LOAD32B(CU8(ct) + 8) ^ s->dk[2];
+	x3 = LOAD32B(CU8(ct) + 12) ^ s->dk[3];
+	x4 = LOAD32B(CU8(ct) + 16) ^ s->dk[4];
+	x5 = LOAD32B(CU8(ct) + 20) ^ s->dk[5];
+	x6 = LOAD32B(CU8(ct) + 24) ^ s->dk[6];
+	x7 = LOAD32B(CU8(ct) + 28) ^ s->dk[7];
+
+	/* - 1 full rounds */
+	for(i = 8; i < (s->rounds << 3);)
+	{
+		t0 = D(x0, x7, x5, x4) ^ s->dk[i++];
+		t1 = D(x1, x0, x6, x5) ^ s->dk[i++];
+		t2 = D(x2, x1, x7, x6) ^ s->dk[i++];
+		t3 = D(x3, x2, x0, x7) ^ s->dk[i++];
+		t4 = D(x4, x3, x1, x0) ^ s->dk[i++];
+		t5 = D(x5, x4, x2, x1) ^ s->dk[i++];
+		t6 = D(x6, x5, x3, x2) ^ s->dk[i++];
+		t7 = D(x7, x6, x4, x3) ^ s->dk[i++];
+
+		x0 = t0;
+		x1 = t1;
+		x2 = t2;
+		x3 = t3;
+		x4 = t4;
+		x5 = t5;
+		x6 = t6;
+		x7 = t7;
+	}
+
+	/* last round */
+	t0 = DL(x0, x7, x5, x4) ^ s->dk[i++];
+	t1 = DL(x1, x0, x6, x5) ^ s->dk[i++];
+	t2 = DL(x2, x1, x7, x6) ^ s->dk[i++];
+	t3 = DL(x3, x2, x0, x7) ^ s->dk[i++];
+	t4 = DL(x4, x3, x1, x0) ^ s->dk[i++];
+	t5 = DL(x5, x4, x2, x1) ^ s->dk[i++];
+	t6 = DL(x6, x5, x3, x2) ^ s->dk[i++];
+	t7 = DL(x7, x6, x4, x3) ^ s->dk[i];
+
+	STORE32B(t0, U8(pt));
+	STORE32B(t1, U8(pt) + 4);
+	STORE32B(t2, U8(pt) + 8);
+	STORE32B(t3, U8(pt) + 12);
+	STORE32B(t4, U8(pt) + 16);
+	STORE32B(t5, U8(pt) + 20);
+	STORE32B(t6, U8(pt) + 24);
+	STORE32B(t7, U8(pt) + 28);
+}
+
+static void rijndael256_encrypt_blocks
+(
+	const kripto_block *s,
+	const void *pt,
+	void *ct,
+	size_t n
+)
+{
+	for(; n; n--)
+	{
+		rijndael256_encrypt(s, pt, ct);
+		pt = CU8(pt) + 32;
+		ct = U8(ct) + 32;
+	}
+}
+
+static void rijndael256_decrypt_blocks
+(
+	const kripto_block *s,
+	const void *ct,
+	void *pt,
+	size_t n
+)
+{
+	for(; n; n--)
+	{
+		rijndael256_decrypt(s, ct, pt);
+		ct = CU8(ct) + 32;
+		pt = U8(pt) + 32;
+	}
+}
+
+static const struct rijndael_impl table256 =
+{
+	&rijndael256_encrypt,
+	&rijndael256_decrypt,
+	&rijndael256_encrypt_blocks,
+	&rijndael256_decrypt_blocks
+};
+
+static void rijndael256_setup
+(
+	kripto_block *s,
+	const uint8_t *key,
+	unsigned int key_len
+)
+{
+	rijndael_setup(s, key, key_len, 32);
+
+	#ifdef KRIPTO_X86_SIMD
+	if((kripto_cpu() & (KRIPTO_CPU_AES | KRIPTO_CPU_SSE41))
+		== (KRIPTO_CPU_AES | KRIPTO_CPU_SSE41))
+	{
+		s->impl = &aesni256;
+		rijndael_tobytes(s, 32);
+		return;
+	}
+
+	if(kripto_cpu() & KRIPTO_CPU_SSSE3)
+	{
+		s->impl = &ssse3_256;
+		rijndael_tobytes(s, 32);
+		return;
+	}
+	#endif
+
+	s->impl = &table256;
+}
+
+static kripto_block *rijndael256_create
+(
+	unsigned int r,
+	const void *key,
+	unsigned int key_len
+)
+{
+	kripto_block *s;
+
+	if(!r)
+	{
+		r = 6 + ((key_len + 3) >> 2);
+		if(r < 14) r = 14;
+	}
+
+	s = malloc(sizeof(kripto_block) + ((r + 1) << 6));
+	if(!s) return 0;
+
+	s->obj.desc = kripto_block_rijndael256;
+	s->size = sizeof(kripto_block) + ((r + 1) << 6);
+	s->rounds = r;
+	s->k = (uint32_t *)((uint8_t *)s + sizeof(kripto_block));
+	s->dk = s->k + ((r + 1) << 3);
+
+	rijndael256_setup(s, key, key_len);
+
+	return s;
+}
+
+static kripto_block *rijndael256_recreate
+(
+	kripto_block *s,
+	unsigned int r,
+	const void *key,
+	unsigned int key_len
+)
+{
+	if(!r)
+	{
+		r = 6 + ((key_len + 3) >> 2);
+		if(r < 14) r = 14;
 	}
 
 	if(sizeof(kripto_block) + ((r + 1) << 6) > s->size)
@@ -1167,7 +2772,7 @@ static kripto_block *rijndael256_recreate
 	else
 	{
 		s->rounds = r;
-		rijndael_setup(s, key, key_len, 32);
+		rijndael256_setup(s, key, key_len);
 	}
 
 	return s;
@@ -1178,8 +2783,10 @@ static const kripto_block_desc rijndael256 =
 	&rijndael256_create,
 	&rijndael256_recreate,
 	0, /* tweak */
-	&rijndael256_encrypt,
-	&rijndael256_decrypt,
+	&rijndael_encrypt,
+	&rijndael_decrypt,
+	&rijndael_encrypt_blocks,
+	&rijndael_decrypt_blocks,
 	&rijndael_destroy,
 	32, /* block size */
 	32, /* max key */
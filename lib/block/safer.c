@@ -428,6 +428,8 @@ static const kripto_block_desc safer =
 	0, /* tweak */
 	&safer_encrypt,
 	&safer_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&safer_destroy,
 	8, /* block size */
 	16, /* max key */
@@ -441,6 +443,8 @@ static const kripto_block_desc safer_sk =
 	0, /* tweak */
 	&safer_encrypt,
 	&safer_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&safer_destroy,
 	8, /* block size */
 	16, /* max key */
@@ -492,6 +492,8 @@ static const kripto_block_desc seed =
 	0, /* tweak */
 	&seed_encrypt,
 	&seed_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&seed_destroy,
 	16, /* block size */
 	16, /* max key */
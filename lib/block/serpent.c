@@ -728,6 +728,8 @@ static const kripto_block_desc serpent =
 	0, /* tweak */
 	&serpent_encrypt,
 	&serpent_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&serpent_destroy,
 	16, /* block size */
 	32, /* max key */
@@ -215,6 +215,8 @@ static const kripto_block_desc simon128 =
 	0, /* tweak */
 	&simon128_encrypt,
 	&simon128_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&simon128_destroy,
 	16, /* block size */
 	32, /* max key */
@@ -187,6 +187,8 @@ static const kripto_block_desc simon32 =
 	0, /* tweak */
 	&simon32_encrypt,
 	&simon32_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&simon32_destroy,
 	4, /* block size */
 	8, /* max key */
@@ -198,6 +198,8 @@ static const kripto_block_desc simon64 =
 	0, /* tweak */
 	&simon64_encrypt,
 	&simon64_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&simon64_destroy,
 	8, /* block size */
 	16, /* max key */
@@ -292,6 +292,8 @@ static const kripto_block_desc skipjack =
 	0, /* tweak */
 	&skipjack_encrypt,
 	&skipjack_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&skipjack_destroy,
 	8, /* block size */
 	10, /* max key */
@@ -177,6 +177,8 @@ static const kripto_block_desc speck128 =
 	0, /* tweak */
 	&speck128_encrypt,
 	&speck128_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&speck128_destroy,
 	16, /* block size */
 	32, /* max key */
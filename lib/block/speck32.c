@@ -172,6 +172,8 @@ static const kripto_block_desc speck32 =
 	0, /* tweak */
 	&speck32_encrypt,
 	&speck32_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&speck32_destroy,
 	4, /* block size */
 	8, /* max key */
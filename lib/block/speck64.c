@@ -176,6 +176,8 @@ static const kripto_block_desc speck64 =
 	0, /* tweak */
 	&speck64_encrypt,
 	&speck64_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&speck64_destroy,
 	8, /* block size */
 	16, /* max key */
@@ -116,6 +116,8 @@ static const kripto_block_desc tea =
 	0, /* tweak */
 	&tea_encrypt,
 	&tea_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&tea_destroy,
 	8, /* block size */
 	16, /* max key */
@@ -436,6 +436,8 @@ static const kripto_block_desc threefish1024 =
 	&threefish1024_tweak,
 	&threefish1024_encrypt,
 	&threefish1024_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&threefish1024_destroy,
 	128, /* block size */
 	128, /* max key */
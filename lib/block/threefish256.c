@@ -229,6 +229,8 @@ static const kripto_block_desc threefish256 =
 	&threefish256_tweak,
 	&threefish256_encrypt,
 	&threefish256_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&threefish256_destroy,
 	32, /* block size */
 	32, /* max key */
@@ -298,6 +298,8 @@ static const kripto_block_desc threefish512 =
 	&threefish512_tweak,
 	&threefish512_encrypt,
 	&threefish512_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&threefish512_destroy,
 	64, /* block size */
 	64, /* max key */
@@ -1236,6 +1236,8 @@ static const kripto_block_desc twofish =
 	0, /* tweak */
 	&twofish_encrypt,
 	&twofish_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&twofish_destroy,
 	16, /* block size */
 	32, /* max key */
@@ -163,6 +163,8 @@ static const kripto_block_desc xtea =
 	0, /* tweak */
 	&xtea_encrypt,
 	&xtea_decrypt,
+	0, /* encrypt_blocks */
+	0, /* decrypt_blocks */
 	&xtea_destroy,
 	8, /* block size */
 	16, /* max key */
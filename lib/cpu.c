@@ -0,0 +1,95 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ * 
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <kripto/cpu.h>
+
+/* features that must never be used, e.g. -DKRIPTO_CPU_DISABLE=0x0008 */
+#ifndef KRIPTO_CPU_DISABLE
+#define KRIPTO_CPU_DISABLE 0
+#endif
+
+#ifdef KRIPTO_X86_SIMD
+
+#include <cpuid.h>
+
+static unsigned int xgetbv(void)
+{
+	unsigned int eax;
+	unsigned int edx;
+
+	__asm__ (".byte 0x0F, 0x01, 0xD0" : "=a" (eax), "=d" (edx) : "c" (0));
+
+	return eax;
+}
+
+static unsigned int cpu_detect(void)
+{
+	unsigned int eax;
+	unsigned int ebx;
+	unsigned int ecx;
+	unsigned int edx;
+	unsigned int max;
+	unsigned int xcr0 = 0;
+	unsigned int f = 0;
+
+	if(!__get_cpuid(0, &max, &ebx, &ecx, &edx)) return 0;
+	if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 0;
+
+	if(edx & (1U << 26)) f |= KRIPTO_CPU_SSE2;
+	if(ecx & (1U << 9)) f |= KRIPTO_CPU_SSSE3;
+	if(ecx & (1U << 19)) f |= KRIPTO_CPU_SSE41;
+	if(ecx & (1U << 25)) f |= KRIPTO_CPU_AES;
+
+	/* OSXSAVE, OS must save YMM (and ZMM) state */
+	if(ecx & (1U << 27)) xcr0 = xgetbv();
+	if((ecx & (1U << 28)) && (xcr0 & 0x06) == 0x06) f |= KRIPTO_CPU_AVX;
+
+	if(max >= 7)
+	{
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+		if((f & KRIPTO_CPU_AVX) && (ebx & (1U << 5)))
+			f |= KRIPTO_CPU_AVX2;
+
+		if((f & KRIPTO_CPU_AVX2) && (xcr0 & 0xE0) == 0xE0
+		&& (ebx & (1U << 16)) /* F */
+		&& (ebx & (1U << 30)) /* BW */
+		&& (ebx & (1U << 31))) /* VL */
+			f |= KRIPTO_CPU_AVX512;
+
+		if(ebx & (1U << 29)) f |= KRIPTO_CPU_SHA;
+	}
+
+	return f;
+}
+
+/* set once detection has run, a single word so concurrent callers are safe */
+#define CPU_INIT 0x80000000U
+
+unsigned int kripto_cpu(void)
+{
+	static volatile unsigned int f = 0;
+
+	if(!f) f = (cpu_detect() & ~(unsigned int)KRIPTO_CPU_DISABLE) | CPU_INIT;
+
+	return f & ~CPU_INIT;
+}
+
+#else
+
+unsigned int kripto_cpu(void)
+{
+	return 0;
+}
+
+#endif
@@ -11,8 +11,10 @@
  * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
  */
 
+#include <stdint.h>
 #include <assert.h>
 
+#include <kripto/cast.h>
 #include <kripto/hash.h>
 #include <kripto/desc/hash.h>
 
@@ -69,6 +71,53 @@ void kripto_hash_output(kripto_hash *s, void *out, size_t len)
 	s->desc->output(s, out, len);
 }
 
+void kripto_hash_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	assert(dst);
+	assert(src);
+	assert(src->desc);
+	assert(src->desc->copy);
+	assert(dst->desc == src->desc);
+
+	src->desc->copy(dst, src);
+}
+
+size_t kripto_hash_exportsize(const kripto_hash_desc *desc)
+{
+	assert(desc);
+	assert(desc->statesize);
+
+	return desc->statesize + 4;
+}
+
+void kripto_hash_export(const kripto_hash *s, void *out)
+{
+	assert(s);
+	assert(s->desc);
+	assert(s->desc->export_state);
+
+	U8(out)[0] = KRIPTO_HASH_STATE_VERSION;
+	U8(out)[1] = s->desc->statesize;
+	U8(out)[2] = s->desc->statesize >> 8;
+	U8(out)[3] = s->desc->statesize >> 16;
+
+	s->desc->export_state(s, U8(out) + 4);
+}
+
+int kripto_hash_import(kripto_hash *s, const void *in)
+{
+	assert(s);
+	assert(s->desc);
+	assert(s->desc->import_state);
+
+	if(CU8(in)[0] != KRIPTO_HASH_STATE_VERSION) return -1;
+
+	if((CU8(in)[1] | (CU8(in)[2] << 8) | ((unsigned int)CU8(in)[3] << 16))
+		!= s->desc->statesize) return -1;
+
+	return s->desc->import_state(s, CU8(in) + 4);
+}
+
 void kripto_hash_destroy(kripto_hash *s)
 {
 	assert(s);
@@ -95,6 +144,36 @@ int kripto_hash_all
 	return desc->hash_all(rounds, in, in_len, out, out_len);
 }
 
+int kripto_hash_many
+(
+	const kripto_hash_desc *desc,
+	unsigned int rounds,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+)
+{
+	size_t i;
+
+	assert(desc);
+	assert(desc->hash_all);
+	assert(out_len <= kripto_hash_maxout(desc));
+
+	if(desc->hash_many)
+		return desc->hash_many(rounds, in, in_len, out, n, out_len);
+
+	/* generic fallback */
+	for(i = 0; i < n; i++)
+	{
+		if(desc->hash_all(rounds, in[i], in_len[i], out[i], out_len))
+			return -1;
+	}
+
+	return 0;
+}
+
 const kripto_hash_desc *kripto_hash_getdesc(const kripto_hash *s)
 {
 	assert(s);
@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
 
@@ -205,24 +206,50 @@ static void blake256_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		s->buf[s->i++] = CU8(in)[i];
+		if(s->i)
+		{
+			/* fill the buffer */
+			n = 64 - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
+
+			if(s->i < 64) return;
+
+			block = s->buf;
+		}
+		else if(len >= 64)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 64;
+			len -= 64;
+		}
+		else
+		{
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
+		}
 
-		if(s->i == 64)
+		s->len[0] += 512;
+		if(!s->len[0])
 		{
-			s->len[0] += 512;
-			if(!s->len[0])
-			{
-				s->len[1]++;
-				assert(s->len[1]);
-			}
-
-			blake256_process(s, s->buf);
-			s->i = 0;
+			s->len[1]++;
+			assert(s->len[1]);
 		}
+
+		blake256_process(s, block);
+		s->i = 0;
 	}
 }
 
@@ -281,6 +308,43 @@ static kripto_hash *blake256_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void blake256_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void blake256_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->r, p);
+	for(i = 0; i < 8; i++) STORE32L(s->h[i], p + 4 + (i << 2));
+	for(i = 0; i < 2; i++) STORE32L(s->len[i], p + 36 + (i << 2));
+	memcpy(p + 44, s->buf, 64);
+	STORE32L(s->i, p + 108);
+	STORE32L(s->o, p + 112);
+}
+
+static int blake256_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	const uint32_t o = LOAD32L(p + 112);
+	unsigned int i;
+
+	if(!LOAD32L(p)) return -1;
+	if(o > 32 || LOAD32L(p + 108) > (o ? 63 : 32)) return -1;
+
+	s->r = LOAD32L(p);
+	for(i = 0; i < 8; i++) s->h[i] = LOAD32L(p + 4 + (i << 2));
+	for(i = 0; i < 2; i++) s->len[i] = LOAD32L(p + 36 + (i << 2));
+	memcpy(s->buf, p + 44, 64);
+	s->i = LOAD32L(p + 108);
+	s->o = o;
+
+	return 0;
+}
+
 static void blake256_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
@@ -313,10 +377,15 @@ static const kripto_hash_desc blake256 =
 	&blake256_recreate,
 	&blake256_input,
 	&blake256_output,
+	&blake256_copy,
+	&blake256_export,
+	&blake256_import,
 	&blake256_destroy,
 	&blake256_hash,
+	0, /* hash_many */
 	32, /* max output */
-	64 /* block_size */
+	64, /* block_size */
+	116 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_blake256 = &blake256;
@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
 
@@ -21,6 +22,8 @@
 #include <kripto/loadstore.h>
 #include <kripto/rotate.h>
 #include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
 #include <kripto/hash.h>
 #include <kripto/desc/hash.h>
 #include <kripto/object/hash.h>
@@ -98,6 +101,337 @@ static kripto_hash *blake2b_recreate
 	B = ROR64_63(B ^ C);		\
 }
 
+#ifdef KRIPTO_X86_SIMD
+
+/*
+ * Message words of round N as pairs from m[0]...m[7] (words 2i and
+ * 2i + 1 in m[i]): B[0], B[1] first and B[2], B[3] second words of
+ * the column steps, B[4]...B[7] the same for the diagonal steps.
+ */
+
+#define SSE41_MSG_0(B)												\
+{																	\
+	B[0] = _mm_unpacklo_epi64(m[0], m[1]);							\
+	B[1] = _mm_unpacklo_epi64(m[2], m[3]);							\
+	B[2] = _mm_unpackhi_epi64(m[0], m[1]);							\
+	B[3] = _mm_unpackhi_epi64(m[2], m[3]);							\
+	B[4] = _mm_unpacklo_epi64(m[4], m[5]);							\
+	B[5] = _mm_unpacklo_epi64(m[6], m[7]);							\
+	B[6] = _mm_unpackhi_epi64(m[4], m[5]);							\
+	B[7] = _mm_unpackhi_epi64(m[6], m[7]);							\
+}
+
+#define SSE41_MSG_1(B)												\
+{																	\
+	B[0] = _mm_unpacklo_epi64(m[7], m[2]);							\
+	B[1] = _mm_unpackhi_epi64(m[4], m[6]);							\
+	B[2] = _mm_unpacklo_epi64(m[5], m[4]);							\
+	B[3] = _mm_alignr_epi8(m[3], m[7], 8);							\
+	B[4] = _mm_shuffle_epi32(m[0], 0x4E);							\
+	B[5] = _mm_unpackhi_epi64(m[5], m[2]);							\
+	B[6] = _mm_unpacklo_epi64(m[6], m[1]);							\
+	B[7] = _mm_unpackhi_epi64(m[3], m[1]);							\
+}
+
+#define SSE41_MSG_2(B)												\
+{																	\
+	B[0] = _mm_alignr_epi8(m[6], m[5], 8);							\
+	B[1] = _mm_unpackhi_epi64(m[2], m[7]);							\
+	B[2] = _mm_unpacklo_epi64(m[4], m[0]);							\
+	B[3] = _mm_blend_epi16(m[1], m[6], 0xF0);						\
+	B[4] = _mm_blend_epi16(m[5], m[1], 0xF0);						\
+	B[5] = _mm_unpackhi_epi64(m[3], m[4]);							\
+	B[6] = _mm_unpacklo_epi64(m[7], m[3]);							\
+	B[7] = _mm_alignr_epi8(m[2], m[0], 8);							\
+}
+
+#define SSE41_MSG_3(B)												\
+{																	\
+	B[0] = _mm_unpackhi_epi64(m[3], m[1]);							\
+	B[1] = _mm_unpackhi_epi64(m[6], m[5]);							\
+	B[2] = _mm_unpackhi_epi64(m[4], m[0]);							\
+	B[3] = _mm_unpacklo_epi64(m[6], m[7]);							\
+	B[4] = _mm_blend_epi16(m[1], m[2], 0xF0);						\
+	B[5] = _mm_blend_epi16(m[2], m[7], 0xF0);						\
+	B[6] = _mm_unpacklo_epi64(m[3], m[5]);							\
+	B[7] = _mm_unpacklo_epi64(m[0], m[4]);							\
+}
+
+#define SSE41_MSG_4(B)												\
+{																	\
+	B[0] = _mm_unpackhi_epi64(m[4], m[2]);							\
+	B[1] = _mm_unpacklo_epi64(m[1], m[5]);							\
+	B[2] = _mm_blend_epi16(m[0], m[3], 0xF0);						\
+	B[3] = _mm_blend_epi16(m[2], m[7], 0xF0);						\
+	B[4] = _mm_blend_epi16(m[7], m[5], 0xF0);						\
+	B[5] = _mm_blend_epi16(m[3], m[1], 0xF0);						\
+	B[6] = _mm_alignr_epi8(m[6], m[0], 8);							\
+	B[7] = _mm_blend_epi16(m[4], m[6], 0xF0);						\
+}
+
+#define SSE41_MSG_5(B)												\
+{																	\
+	B[0] = _mm_unpacklo_epi64(m[1], m[3]);							\
+	B[1] = _mm_unpacklo_epi64(m[0], m[4]);							\
+	B[2] = _mm_unpacklo_epi64(m[6], m[5]);							\
+	B[3] = _mm_unpackhi_epi64(m[5], m[1]);							\
+	B[4] = _mm_blend_epi16(m[2], m[3], 0xF0);						\
+	B[5] = _mm_unpackhi_epi64(m[7], m[0]);							\
+	B[6] = _mm_unpackhi_epi64(m[6], m[2]);							\
+	B[7] = _mm_blend_epi16(m[7], m[4], 0xF0);						\
+}
+
+#define SSE41_MSG_6(B)												\
+{																	\
+	B[0] = _mm_blend_epi16(m[6], m[0], 0xF0);						\
+	B[1] = _mm_unpacklo_epi64(m[7], m[2]);							\
+	B[2] = _mm_unpackhi_epi64(m[2], m[7]);							\
+	B[3] = _mm_alignr_epi8(m[5], m[6], 8);							\
+	B[4] = _mm_unpacklo_epi64(m[0], m[3]);							\
+	B[5] = _mm_shuffle_epi32(m[4], 0x4E);							\
+	B[6] = _mm_unpackhi_epi64(m[3], m[1]);							\
+	B[7] = _mm_blend_epi16(m[1], m[5], 0xF0);						\
+}
+
+#define SSE41_MSG_7(B)												\
+{																	\
+	B[0] = _mm_unpackhi_epi64(m[6], m[3]);							\
+	B[1] = _mm_blend_epi16(m[6], m[1], 0xF0);						\
+	B[2] = _mm_alignr_epi8(m[7], m[5], 8);							\
+	B[3] = _mm_unpackhi_epi64(m[0], m[4]);							\
+	B[4] = _mm_unpackhi_epi64(m[2], m[7]);							\
+	B[5] = _mm_unpacklo_epi64(m[4], m[1]);							\
+	B[6] = _mm_unpacklo_epi64(m[0], m[2]);							\
+	B[7] = _mm_unpacklo_epi64(m[3], m[5]);							\
+}
+
+#define SSE41_MSG_8(B)												\
+{																	\
+	B[0] = _mm_unpacklo_epi64(m[3], m[7]);							\
+	B[1] = _mm_alignr_epi8(m[0], m[5], 8);							\
+	B[2] = _mm_unpackhi_epi64(m[7], m[4]);							\
+	B[3] = _mm_alignr_epi8(m[4], m[1], 8);							\
+	B[4] = m[6];													\
+	B[5] = _mm_alignr_epi8(m[5], m[0], 8);							\
+	B[6] = _mm_blend_epi16(m[1], m[3], 0xF0);						\
+	B[7] = m[2];													\
+}
+
+#define SSE41_MSG_9(B)												\
+{																	\
+	B[0] = _mm_unpacklo_epi64(m[5], m[4]);							\
+	B[1] = _mm_unpackhi_epi64(m[3], m[0]);							\
+	B[2] = _mm_unpacklo_epi64(m[1], m[2]);							\
+	B[3] = _mm_blend_epi16(m[3], m[2], 0xF0);						\
+	B[4] = _mm_unpackhi_epi64(m[7], m[4]);							\
+	B[5] = _mm_unpackhi_epi64(m[1], m[6]);							\
+	B[6] = _mm_alignr_epi8(m[7], m[5], 8);							\
+	B[7] = _mm_unpacklo_epi64(m[6], m[0]);							\
+}
+
+/* one row of 4 words in 2 registers */
+#define SSE41_G(A, B, C, D, M, R0, R1)								\
+{																	\
+	A[0] = _mm_add_epi64(_mm_add_epi64(A[0], B[0]), M[0]);			\
+	A[1] = _mm_add_epi64(_mm_add_epi64(A[1], B[1]), M[1]);			\
+	D[0] = _mm_shuffle_epi32(_mm_xor_si128(D[0], A[0]), 0xB1);		\
+	D[1] = _mm_shuffle_epi32(_mm_xor_si128(D[1], A[1]), 0xB1);		\
+	C[0] = _mm_add_epi64(C[0], D[0]);								\
+	C[1] = _mm_add_epi64(C[1], D[1]);								\
+	B[0] = _mm_shuffle_epi8(_mm_xor_si128(B[0], C[0]), R0);			\
+	B[1] = _mm_shuffle_epi8(_mm_xor_si128(B[1], C[1]), R0);			\
+																	\
+	A[0] = _mm_add_epi64(_mm_add_epi64(A[0], B[0]), M[2]);			\
+	A[1] = _mm_add_epi64(_mm_add_epi64(A[1], B[1]), M[3]);			\
+	D[0] = _mm_shuffle_epi8(_mm_xor_si128(D[0], A[0]), R1);			\
+	D[1] = _mm_shuffle_epi8(_mm_xor_si128(D[1], A[1]), R1);			\
+	C[0] = _mm_add_epi64(C[0], D[0]);								\
+	C[1] = _mm_add_epi64(C[1], D[1]);								\
+	B[0] = _mm_xor_si128(B[0], C[0]);								\
+	B[1] = _mm_xor_si128(B[1], C[1]);								\
+	B[0] = _mm_xor_si128(_mm_srli_epi64(B[0], 63),					\
+		_mm_add_epi64(B[0], B[0]));									\
+	B[1] = _mm_xor_si128(_mm_srli_epi64(B[1], 63),					\
+		_mm_add_epi64(B[1], B[1]));									\
+}
+
+/* rotate rows B, C and D left by 1, 2 and 3 words */
+#define SSE41_DIAGONALIZE(B, C, D, T)								\
+{																	\
+	T[0] = _mm_alignr_epi8(B[1], B[0], 8);							\
+	T[1] = _mm_alignr_epi8(B[0], B[1], 8);							\
+	B[0] = T[0];													\
+	B[1] = T[1];													\
+	T[0] = C[0];													\
+	C[0] = C[1];													\
+	C[1] = T[0];													\
+	T[0] = _mm_alignr_epi8(D[1], D[0], 8);							\
+	T[1] = _mm_alignr_epi8(D[0], D[1], 8);							\
+	D[0] = T[1];													\
+	D[1] = T[0];													\
+}
+
+#define SSE41_UNDIAGONALIZE(B, C, D, T)								\
+{																	\
+	T[0] = _mm_alignr_epi8(B[0], B[1], 8);							\
+	T[1] = _mm_alignr_epi8(B[1], B[0], 8);							\
+	B[0] = T[0];													\
+	B[1] = T[1];													\
+	T[0] = C[0];													\
+	C[0] = C[1];													\
+	C[1] = T[0];													\
+	T[0] = _mm_alignr_epi8(D[1], D[0], 8);							\
+	T[1] = _mm_alignr_epi8(D[0], D[1], 8);							\
+	D[0] = T[0];													\
+	D[1] = T[1];													\
+}
+
+#define SSE41_ROUND(N)												\
+{																	\
+	SSE41_MSG_##N(b);												\
+	SSE41_G(v[0], v[1], v[2], v[3], b, r24, r16);					\
+	SSE41_DIAGONALIZE(v[1], v[2], v[3], t);							\
+	SSE41_G(v[0], v[1], v[2], v[3], (b + 4), r24, r16);				\
+	SSE41_UNDIAGONALIZE(v[1], v[2], v[3], t);						\
+}
+
+/* a round for each of the 10 permutations, until r */
+#define ROUNDS(ROUND)												\
+{																	\
+	for(i = 0;;)													\
+	{																\
+		ROUND(0); if(++i == r) break;								\
+		ROUND(1); if(++i == r) break;								\
+		ROUND(2); if(++i == r) break;								\
+		ROUND(3); if(++i == r) break;								\
+		ROUND(4); if(++i == r) break;								\
+		ROUND(5); if(++i == r) break;								\
+		ROUND(6); if(++i == r) break;								\
+		ROUND(7); if(++i == r) break;								\
+		ROUND(8); if(++i == r) break;								\
+		ROUND(9); if(++i == r) break;								\
+	}																\
+}
+
+KRIPTO_TARGET("sse4.1")
+static void blake2b_sse41(kripto_hash *s, const uint8_t *data)
+{
+	__m128i v[4][2];
+	__m128i m[8];
+	__m128i b[8];
+	__m128i t[2];
+	const __m128i r16 = _mm_setr_epi8
+	(
+		2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9
+	);
+	const __m128i r24 = _mm_setr_epi8
+	(
+		3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10
+	);
+	const unsigned int r = s->r;
+	unsigned int i;
+
+	for(i = 0; i < 8; i++) m[i] = LOADU(data + (i << 4));
+
+	v[0][0] = LOADU(s->h);
+	v[0][1] = LOADU(s->h + 2);
+	v[1][0] = LOADU(s->h + 4);
+	v[1][1] = LOADU(s->h + 6);
+	v[2][0] = LOADU(iv);
+	v[2][1] = LOADU(iv + 2);
+	v[3][0] = _mm_xor_si128(LOADU(iv + 4),
+		_mm_set_epi64x((long long)s->len[1], (long long)s->len[0]));
+	v[3][1] = _mm_xor_si128(LOADU(iv + 6),
+		_mm_set_epi64x(0, (long long)s->f));
+
+	ROUNDS(SSE41_ROUND);
+
+	STOREU(s->h, _mm_xor_si128(LOADU(s->h),
+		_mm_xor_si128(v[0][0], v[2][0])));
+	STOREU(s->h + 2, _mm_xor_si128(LOADU(s->h + 2),
+		_mm_xor_si128(v[0][1], v[2][1])));
+	STOREU(s->h + 4, _mm_xor_si128(LOADU(s->h + 4),
+		_mm_xor_si128(v[1][0], v[3][0])));
+	STOREU(s->h + 6, _mm_xor_si128(LOADU(s->h + 6),
+		_mm_xor_si128(v[1][1], v[3][1])));
+}
+
+/* the same rows in one register each, message pairs from SSE41_MSG */
+#define AVX2_G(A, B, C, D, M0, M1, R0, R1)							\
+{																	\
+	A = _mm256_add_epi64(_mm256_add_epi64(A, B), M0);				\
+	D = _mm256_shuffle_epi32(_mm256_xor_si256(D, A), 0xB1);			\
+	C = _mm256_add_epi64(C, D);										\
+	B = _mm256_shuffle_epi8(_mm256_xor_si256(B, C), R0);			\
+																	\
+	A = _mm256_add_epi64(_mm256_add_epi64(A, B), M1);				\
+	D = _mm256_shuffle_epi8(_mm256_xor_si256(D, A), R1);			\
+	C = _mm256_add_epi64(C, D);										\
+	B = _mm256_xor_si256(B, C);										\
+	B = _mm256_xor_si256(_mm256_srli_epi64(B, 63),					\
+		_mm256_add_epi64(B, B));									\
+}
+
+#define AVX2_PAIR(L, H)												\
+	_mm256_inserti128_si256(_mm256_castsi128_si256(L), H, 1)
+
+#define AVX2_ROUND(N)												\
+{																	\
+	SSE41_MSG_##N(b);												\
+	AVX2_G(v[0], v[1], v[2], v[3], AVX2_PAIR(b[0], b[1]),			\
+		AVX2_PAIR(b[2], b[3]), r24, r16);							\
+	v[1] = _mm256_permute4x64_epi64(v[1], 0x39);					\
+	v[2] = _mm256_permute4x64_epi64(v[2], 0x4E);					\
+	v[3] = _mm256_permute4x64_epi64(v[3], 0x93);					\
+	AVX2_G(v[0], v[1], v[2], v[3], AVX2_PAIR(b[4], b[5]),			\
+		AVX2_PAIR(b[6], b[7]), r24, r16);							\
+	v[1] = _mm256_permute4x64_epi64(v[1], 0x93);					\
+	v[2] = _mm256_permute4x64_epi64(v[2], 0x4E);					\
+	v[3] = _mm256_permute4x64_epi64(v[3], 0x39);					\
+}
+
+KRIPTO_TARGET("avx2")
+static void blake2b_avx2(kripto_hash *s, const uint8_t *data)
+{
+	__m256i v[4];
+	__m128i m[8];
+	__m128i b[8];
+	const __m256i r16 = _mm256_setr_epi8
+	(
+		2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+		2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9
+	);
+	const __m256i r24 = _mm256_setr_epi8
+	(
+		3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+		3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10
+	);
+	const unsigned int r = s->r;
+	unsigned int i;
+
+	for(i = 0; i < 8; i++) m[i] = LOADU(data + (i << 4));
+
+	v[0] = LOADU256(s->h);
+	v[1] = LOADU256(s->h + 4);
+	v[2] = LOADU256(iv);
+	v[3] = _mm256_xor_si256(LOADU256(iv + 4), _mm256_setr_epi64x
+	(
+		(long long)s->len[0],
+		(long long)s->len[1],
+		(long long)s->f,
+		0
+	));
+
+	ROUNDS(AVX2_ROUND);
+
+	STOREU256(s->h, _mm256_xor_si256(LOADU256(s->h),
+		_mm256_xor_si256(v[0], v[2])));
+	STOREU256(s->h + 4, _mm256_xor_si256(LOADU256(s->h + 4),
+		_mm256_xor_si256(v[1], v[3])));
+}
+
+#endif
+
 static void blake2b_process(kripto_hash *s, const uint8_t *data)
 {
 	uint64_t x0;
@@ -120,6 +454,20 @@ static void blake2b_process(kripto_hash *s, const uint8_t *data)
 	unsigned int r;
 	unsigned int i;
 
+	#ifdef KRIPTO_X86_SIMD
+	if(kripto_cpu() & KRIPTO_CPU_AVX2)
+	{
+		blake2b_avx2(s, data);
+		return;
+	}
+
+	if(kripto_cpu() & KRIPTO_CPU_SSE41)
+	{
+		blake2b_sse41(s, data);
+		return;
+	}
+	#endif
+
 	m[0] = LOAD64L(data);
 	m[1] = LOAD64L(data + 8);
 	m[2] = LOAD64L(data + 16);
@@ -188,24 +536,50 @@ static void blake2b_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		if(s->i == 128)
+		if(s->i)
+		{
+			/* fill the buffer */
+			n = 128 - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
+
+			if(!len) return; /* keep the last block */
+
+			block = s->buf;
+		}
+		else if(len > 128)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 128;
+			len -= 128;
+		}
+		else
 		{
-			s->len[0] += 128;
-			if(!s->len[0])
-			{
-				s->len[1]++;
-				assert(s->len[1]);
-			}
-
-			blake2b_process(s, s->buf);
-			s->i = 0;
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
 		}
 
-		s->buf[s->i++] = CU8(in)[i];
+		s->len[0] += 128;
+		if(!s->len[0])
+		{
+			s->len[1]++;
+			assert(s->len[1]);
+		}
+
+		blake2b_process(s, block);
+		s->i = 0;
 	}
 }
 
@@ -251,6 +625,43 @@ static kripto_hash *blake2b_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void blake2b_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void blake2b_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->r, p);
+	for(i = 0; i < 8; i++) STORE64L(s->h[i], p + 4 + (i << 3));
+	for(i = 0; i < 2; i++) STORE64L(s->len[i], p + 68 + (i << 3));
+	STORE64L(s->f, p + 84);
+	memcpy(p + 92, s->buf, 128);
+	STORE32L(s->i, p + 220);
+}
+
+static int blake2b_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	unsigned int i;
+
+	/* sigma wraps, but the round loops run at least once */
+	if(!LOAD32L(p)) return -1;
+	if(LOAD32L(p + 220) > (LOAD64L(p + 84) ? 64 : 128)) return -1;
+
+	s->r = LOAD32L(p);
+	for(i = 0; i < 8; i++) s->h[i] = LOAD64L(p + 4 + (i << 3));
+	for(i = 0; i < 2; i++) s->len[i] = LOAD64L(p + 68 + (i << 3));
+	s->f = LOAD64L(p + 84);
+	memcpy(s->buf, p + 92, 128);
+	s->i = LOAD32L(p + 220);
+
+	return 0;
+}
+
 static void blake2b_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
@@ -283,10 +694,15 @@ static const kripto_hash_desc blake2b =
 	&blake2b_recreate,
 	&blake2b_input,
 	&blake2b_output,
+	&blake2b_copy,
+	&blake2b_export,
+	&blake2b_import,
 	&blake2b_destroy,
 	&blake2b_hash,
+	0, /* hash_many */
 	64, /* max output */
-	128 /* block_size */
+	128, /* block_size */
+	224 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_blake2b = &blake2b;
@@ -0,0 +1,563 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#include <kripto/cast.h>
+#include <kripto/loadstore.h>
+#include <kripto/rotate.h>
+#include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
+#include <kripto/hash.h>
+#include <kripto/desc/hash.h>
+#include <kripto/object/hash.h>
+
+#include <kripto/hash/blake2bp.h>
+
+/*
+ * BLAKE2bp: 4 BLAKE2b leaves, leaf l takes blocks l, l + 4, l + 8...
+ * of the message, and a root hashes the 4 leaf digests. The leaves
+ * always move together one stripe (4 blocks) at a time until the end.
+ */
+
+#define LEAVES 4
+#define STRIPE (LEAVES << 7)
+
+/* a stripe is compressed once every leaf has input after it */
+#define LOOKAHEAD (STRIPE - 128)
+
+struct kripto_hash
+{
+	struct kripto_hash_object obj;
+	unsigned int r;
+	unsigned int i;
+	int o;
+	uint64_t h[8 * LEAVES]; /* word j of leaf l at [j * LEAVES + l] */
+	uint64_t root[8];
+	uint64_t len; /* bytes of each leaf */
+	uint8_t buf[STRIPE << 1];
+};
+
+static const uint8_t sigma[10][16] =
+{
+	{ 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15},
+	{14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3},
+	{11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4},
+	{ 7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8},
+	{ 9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13},
+	{ 2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9},
+	{12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11},
+	{13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10},
+	{ 6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5},
+	{10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0}
+};
+
+static const uint64_t iv[8] =
+{
+	0x6A09E667F3BCC908, 0xBB67AE8584CAA73B,
+	0x3C6EF372FE94F82B, 0xA54FF53A5F1D36F1,
+	0x510E527FADE682D1, 0x9B05688C2B3E6C1F,
+	0x1F83D9ABFB41BD6B, 0x5BE0CD19137E2179
+};
+
+static kripto_hash *blake2bp_recreate
+(
+	kripto_hash *s,
+	unsigned int r,
+	size_t len
+)
+{
+	unsigned int i;
+	unsigned int l;
+
+	s->r = r;
+	if(!s->r) s->r = 12;
+
+	s->len = s->o = s->i = 0;
+
+	for(i = 0; i < 8; i++)
+	{
+		for(l = 0; l < LEAVES; l++) s->h[i * LEAVES + l] = iv[i];
+		s->root[i] = iv[i];
+	}
+
+	/* digest length, fanout 4, depth 2, node offset, inner length 64 */
+	for(l = 0; l < LEAVES; l++)
+	{
+		s->h[l] ^= 0x0000000002040000 ^ (uint8_t)len;
+		s->h[LEAVES + l] ^= l;
+		s->h[(LEAVES << 1) + l] ^= 0x4000;
+	}
+
+	/* and node depth 1 */
+	s->root[0] ^= 0x0000000002040000 ^ (uint8_t)len;
+	s->root[2] ^= 0x4001;
+
+	return s;
+}
+
+#define G(A, B, C, D, M0, M1)	\
+{								\
+	A += B + (M0);				\
+	D = ROR64_32(D ^ A);		\
+	C += D;						\
+	B = ROR64_24(B ^ C);		\
+								\
+	A += B + (M1);				\
+	D = ROR64_16(D ^ A);		\
+	C += D;						\
+	B = ROR64_63(B ^ C);		\
+}
+
+/* one BLAKE2b compression of h, word j at h[j * n] */
+static void blake2bp_compress
+(
+	uint64_t *h,
+	unsigned int n,
+	const uint8_t *data,
+	uint64_t t,
+	uint64_t f0,
+	uint64_t f1,
+	unsigned int rounds
+)
+{
+	uint64_t x[16];
+	uint64_t m[16];
+	unsigned int r;
+	unsigned int i;
+
+	for(i = 0; i < 16; i++) m[i] = LOAD64L(data + (i << 3));
+
+	for(i = 0; i < 8; i++)
+	{
+		x[i] = h[i * n];
+		x[i + 8] = iv[i];
+	}
+	x[12] ^= t;
+	x[14] ^= f0;
+	x[15] ^= f1;
+
+	for(r = 0, i = 0; r < rounds; r++, i++)
+	{
+		if(i == 10) i = 0;
+
+		G(x[0], x[4], x[8], x[12], m[sigma[i][0]], m[sigma[i][1]]);
+		G(x[1], x[5], x[9], x[13], m[sigma[i][2]], m[sigma[i][3]]);
+		G(x[2], x[6], x[10], x[14], m[sigma[i][4]], m[sigma[i][5]]);
+		G(x[3], x[7], x[11], x[15], m[sigma[i][6]], m[sigma[i][7]]);
+
+		G(x[0], x[5], x[10], x[15], m[sigma[i][8]], m[sigma[i][9]]);
+		G(x[1], x[6], x[11], x[12], m[sigma[i][10]], m[sigma[i][11]]);
+		G(x[2], x[7], x[8], x[13], m[sigma[i][12]], m[sigma[i][13]]);
+		G(x[3], x[4], x[9], x[14], m[sigma[i][14]], m[sigma[i][15]]);
+	}
+
+	for(i = 0; i < 8; i++) h[i * n] ^= x[i] ^ x[i + 8];
+
+	kripto_memwipe(m, 128);
+	kripto_memwipe(x, 128);
+}
+
+#ifdef KRIPTO_X86_SIMD
+
+/* words 4i...4i + 3 of the 4 leaf blocks at P, one leaf per lane */
+#define AVX2_LOAD4(M, P, I, T)										\
+{																	\
+	T[0] = LOADU256(P + ((I) << 5));								\
+	T[1] = LOADU256(P + 128 + ((I) << 5));							\
+	T[2] = LOADU256(P + 256 + ((I) << 5));							\
+	T[3] = LOADU256(P + 384 + ((I) << 5));							\
+	T[4] = _mm256_unpacklo_epi64(T[0], T[1]);						\
+	T[5] = _mm256_unpackhi_epi64(T[0], T[1]);						\
+	T[6] = _mm256_unpacklo_epi64(T[2], T[3]);						\
+	T[7] = _mm256_unpackhi_epi64(T[2], T[3]);						\
+	M[((I) << 2)] = _mm256_permute2x128_si256(T[4], T[6], 0x20);	\
+	M[((I) << 2) + 1] = _mm256_permute2x128_si256(T[5], T[7], 0x20); \
+	M[((I) << 2) + 2] = _mm256_permute2x128_si256(T[4], T[6], 0x31); \
+	M[((I) << 2) + 3] = _mm256_permute2x128_si256(T[5], T[7], 0x31); \
+}
+
+#define AVX2_G(A, B, C, D, M0, M1)									\
+{																	\
+	A = _mm256_add_epi64(_mm256_add_epi64(A, B), M0);				\
+	D = _mm256_shuffle_epi32(_mm256_xor_si256(D, A), 0xB1);			\
+	C = _mm256_add_epi64(C, D);										\
+	B = _mm256_shuffle_epi8(_mm256_xor_si256(B, C), r24);			\
+																	\
+	A = _mm256_add_epi64(_mm256_add_epi64(A, B), M1);				\
+	D = _mm256_shuffle_epi8(_mm256_xor_si256(D, A), r16);			\
+	C = _mm256_add_epi64(C, D);										\
+	B = _mm256_xor_si256(B, C);										\
+	B = _mm256_xor_si256(_mm256_srli_epi64(B, 63),					\
+		_mm256_add_epi64(B, B));									\
+}
+
+#define AVX2_ROUND(N)												\
+{																	\
+	AVX2_G(x[0], x[4], x[8], x[12],									\
+		m[sigma[N][0]], m[sigma[N][1]]);							\
+	AVX2_G(x[1], x[5], x[9], x[13],									\
+		m[sigma[N][2]], m[sigma[N][3]]);							\
+	AVX2_G(x[2], x[6], x[10], x[14],								\
+		m[sigma[N][4]], m[sigma[N][5]]);							\
+	AVX2_G(x[3], x[7], x[11], x[15],								\
+		m[sigma[N][6]], m[sigma[N][7]]);							\
+																	\
+	AVX2_G(x[0], x[5], x[10], x[15],								\
+		m[sigma[N][8]], m[sigma[N][9]]);							\
+	AVX2_G(x[1], x[6], x[11], x[12],								\
+		m[sigma[N][10]], m[sigma[N][11]]);							\
+	AVX2_G(x[2], x[7], x[8], x[13],									\
+		m[sigma[N][12]], m[sigma[N][13]]);							\
+	AVX2_G(x[3], x[4], x[9], x[14],									\
+		m[sigma[N][14]], m[sigma[N][15]]);							\
+}
+
+/* a round for each of the 10 permutations, until r */
+#define ROUNDS(ROUND)												\
+{																	\
+	for(i = 0;;)													\
+	{																\
+		ROUND(0); if(++i == r) break;								\
+		ROUND(1); if(++i == r) break;								\
+		ROUND(2); if(++i == r) break;								\
+		ROUND(3); if(++i == r) break;								\
+		ROUND(4); if(++i == r) break;								\
+		ROUND(5); if(++i == r) break;								\
+		ROUND(6); if(++i == r) break;								\
+		ROUND(7); if(++i == r) break;								\
+		ROUND(8); if(++i == r) break;								\
+		ROUND(9); if(++i == r) break;								\
+	}																\
+}
+
+/* whole stripes, all 4 leaves at once (one per 64-bit lane) */
+KRIPTO_TARGET("avx2")
+static void blake2bp_avx2
+(
+	uint64_t *h,
+	const uint8_t *in,
+	size_t stripes,
+	uint64_t t,
+	unsigned int r
+)
+{
+	__m256i v[8];
+	__m256i x[16];
+	__m256i m[16];
+	__m256i tmp[8];
+	const __m256i r16 = _mm256_setr_epi8
+	(
+		2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+		2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9
+	);
+	const __m256i r24 = _mm256_setr_epi8
+	(
+		3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+		3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10
+	);
+	unsigned int i;
+
+	for(i = 0; i < 8; i++) v[i] = LOADU256(h + (i << 2));
+
+	for(; stripes; stripes--)
+	{
+		t += 128;
+
+		AVX2_LOAD4(m, in, 0, tmp);
+		AVX2_LOAD4(m, in, 1, tmp);
+		AVX2_LOAD4(m, in, 2, tmp);
+		AVX2_LOAD4(m, in, 3, tmp);
+
+		for(i = 0; i < 8; i++)
+		{
+			x[i] = v[i];
+			x[i + 8] = _mm256_set1_epi64x((long long)iv[i]);
+		}
+		x[12] = _mm256_set1_epi64x((long long)(iv[4] ^ t));
+
+		ROUNDS(AVX2_ROUND);
+
+		for(i = 0; i < 8; i++)
+			v[i] = _mm256_xor_si256(v[i], _mm256_xor_si256(x[i], x[i + 8]));
+
+		in += STRIPE;
+	}
+
+	for(i = 0; i < 8; i++) STOREU256(h + (i << 2), v[i]);
+}
+
+#endif
+
+static void blake2bp_stripes
+(
+	kripto_hash *s,
+	const uint8_t *in,
+	size_t stripes
+)
+{
+	uint64_t t;
+	size_t n;
+	unsigned int l;
+
+	#ifdef KRIPTO_X86_SIMD
+	if(kripto_cpu() & KRIPTO_CPU_AVX2)
+	{
+		blake2bp_avx2(s->h, in, stripes, s->len, s->r);
+		s->len += (uint64_t)stripes << 7;
+		return;
+	}
+	#endif
+
+	/* a stripe at a time, every leaf over its own block */
+	t = s->len;
+	for(n = 0; n < stripes; n++)
+	{
+		t += 128;
+
+		for(l = 0; l < LEAVES; l++)
+		{
+			blake2bp_compress
+			(
+				s->h + l,
+				LEAVES,
+				in + n * STRIPE + (l << 7),
+				t,
+				0,
+				0,
+				s->r
+			);
+		}
+	}
+
+	s->len += (uint64_t)stripes << 7;
+}
+
+static void blake2bp_input
+(
+	kripto_hash *s,
+	const void *in,
+	size_t len
+)
+{
+	size_t n;
+
+	/* fill the buffer */
+	while(s->i && len)
+	{
+		if(s->i < STRIPE)
+		{
+			n = STRIPE - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
+		}
+
+		if(s->i + len <= STRIPE + LOOKAHEAD)
+		{
+			memcpy(s->buf + s->i, in, len);
+			s->i += len;
+			return;
+		}
+
+		blake2bp_stripes(s, s->buf, 1);
+
+		s->i -= STRIPE;
+		memmove(s->buf, s->buf + STRIPE, s->i);
+	}
+
+	/* whole stripes straight from in */
+	if(len > STRIPE + LOOKAHEAD)
+	{
+		n = (len - LOOKAHEAD - 1) / STRIPE;
+
+		blake2bp_stripes(s, in, n);
+		in = CU8(in) + n * STRIPE;
+		len -= n * STRIPE;
+	}
+
+	/* buffer the rest */
+	if(len)
+	{
+		memcpy(s->buf + s->i, in, len);
+		s->i += len;
+	}
+}
+
+static void blake2bp_finish(kripto_hash *s)
+{
+	const unsigned int n = s->i;
+	unsigned int a;
+	unsigned int b;
+	unsigned int l;
+
+	memset(s->buf + n, 0, sizeof(s->buf) - n);
+
+	/* last 1 or 2 blocks of each leaf */
+	for(l = 0; l < LEAVES; l++)
+	{
+		a = l << 7;
+		b = a + STRIPE;
+
+		if(n > b)
+		{
+			blake2bp_compress(s->h + l, LEAVES, s->buf + a,
+				s->len + 128, 0, 0, s->r);
+
+			a = b;
+			b = n - b < 128 ? n - b : 128;
+			blake2bp_compress(s->h + l, LEAVES, s->buf + a,
+				s->len + 128 + b, 0xFFFFFFFFFFFFFFFF,
+				l == LEAVES - 1 ? 0xFFFFFFFFFFFFFFFF : 0, s->r);
+		}
+		else
+		{
+			b = n > a ? (n - a < 128 ? n - a : 128) : 0;
+			blake2bp_compress(s->h + l, LEAVES, s->buf + a,
+				s->len + b, 0xFFFFFFFFFFFFFFFF,
+				l == LEAVES - 1 ? 0xFFFFFFFFFFFFFFFF : 0, s->r);
+		}
+	}
+
+	/* root over the leaf digests */
+	for(l = 0; l < LEAVES; l++)
+	{
+		for(a = 0; a < 8; a++)
+			STORE64L(s->h[a * LEAVES + l], s->buf + (l << 6) + (a << 3));
+	}
+
+	blake2bp_compress(s->root, 1, s->buf, 128, 0, 0, s->r);
+	blake2bp_compress(s->root, 1, s->buf + 128, 256,
+		0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFFFFFF, s->r);
+
+	s->i = 0;
+	s->o = -1;
+}
+
+static void blake2bp_output(kripto_hash *s, void *out, size_t len)
+{
+	unsigned int i;
+
+	if(!s->o) blake2bp_finish(s);
+
+	/* little endian */
+	for(i = 0; i < len; s->i++, i++)
+		U8(out)[i] = s->root[s->i >> 3] >> ((s->i & 7) << 3);
+}
+
+static kripto_hash *blake2bp_create(unsigned int r, size_t len)
+{
+	kripto_hash *s;
+
+	s = malloc(sizeof(kripto_hash));
+	if(!s) return 0;
+
+	s->obj.desc = kripto_hash_blake2bp;
+
+	(void)blake2bp_recreate(s, r, len);
+
+	return s;
+}
+
+static void blake2bp_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void blake2bp_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->r, p);
+	for(i = 0; i < 8 * LEAVES; i++) STORE64L(s->h[i], p + 4 + (i << 3));
+	for(i = 0; i < 8; i++) STORE64L(s->root[i], p + 260 + (i << 3));
+	STORE64L(s->len, p + 324);
+	memcpy(p + 332, s->buf, sizeof(s->buf));
+	STORE32L(s->i, p + 1356);
+	p[1360] = s->o != 0;
+}
+
+static int blake2bp_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	unsigned int i;
+
+	/* sigma wraps, but the round loops run at least once */
+	if(!LOAD32L(p)) return -1;
+	if(LOAD32L(p + 1356) > (p[1360] ? 64 : STRIPE + LOOKAHEAD)) return -1;
+
+	s->r = LOAD32L(p);
+	for(i = 0; i < 8 * LEAVES; i++) s->h[i] = LOAD64L(p + 4 + (i << 3));
+	for(i = 0; i < 8; i++) s->root[i] = LOAD64L(p + 260 + (i << 3));
+	s->len = LOAD64L(p + 324);
+	memcpy(s->buf, p + 332, sizeof(s->buf));
+	s->i = LOAD32L(p + 1356);
+	s->o = p[1360] ? -1 : 0;
+
+	return 0;
+}
+
+static void blake2bp_destroy(kripto_hash *s)
+{
+	kripto_memwipe(s, sizeof(kripto_hash));
+	free(s);
+}
+
+static int blake2bp_hash
+(
+	unsigned int r,
+	const void *in,
+	size_t in_len,
+	void *out,
+	size_t out_len
+)
+{
+	kripto_hash s;
+
+	(void)blake2bp_recreate(&s, r, out_len);
+	blake2bp_input(&s, in, in_len);
+	blake2bp_output(&s, out, out_len);
+
+	kripto_memwipe(&s, sizeof(kripto_hash));
+
+	return 0;
+}
+
+static const kripto_hash_desc blake2bp =
+{
+	&blake2bp_create,
+	&blake2bp_recreate,
+	&blake2bp_input,
+	&blake2bp_output,
+	&blake2bp_copy,
+	&blake2bp_export,
+	&blake2bp_import,
+	&blake2bp_destroy,
+	&blake2bp_hash,
+	0, /* hash_many */
+	64, /* max output */
+	128, /* block_size */
+	1361 /* state size */
+};
+
+const kripto_hash_desc *const kripto_hash_blake2bp = &blake2bp;
@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
 
@@ -21,6 +22,8 @@
 #include <kripto/loadstore.h>
 #include <kripto/rotate.h>
 #include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
 #include <kripto/hash.h>
 #include <kripto/desc/hash.h>
 #include <kripto/object/hash.h>
@@ -96,6 +99,215 @@ static kripto_hash *blake2s_recreate
 	B = ROR32_07(B ^ C);		\
 }
 
+#ifdef KRIPTO_X86_SIMD
+
+/*
+ * Message words of round N: B[0], B[1] first and second words of the
+ * column steps, B[2], B[3] the same for the diagonal steps.
+ */
+
+#define SSE41_MSG_0(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[0],								\
+		(int)m[2], (int)m[4], (int)m[6]);							\
+	B[1] = _mm_setr_epi32((int)m[1],								\
+		(int)m[3], (int)m[5], (int)m[7]);							\
+	B[2] = _mm_setr_epi32((int)m[8],								\
+		(int)m[10], (int)m[12], (int)m[14]);						\
+	B[3] = _mm_setr_epi32((int)m[9],								\
+		(int)m[11], (int)m[13], (int)m[15]);						\
+}
+
+#define SSE41_MSG_1(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[14],								\
+		(int)m[4], (int)m[9], (int)m[13]);							\
+	B[1] = _mm_setr_epi32((int)m[10],								\
+		(int)m[8], (int)m[15], (int)m[6]);							\
+	B[2] = _mm_setr_epi32((int)m[1],								\
+		(int)m[0], (int)m[11], (int)m[5]);							\
+	B[3] = _mm_setr_epi32((int)m[12],								\
+		(int)m[2], (int)m[7], (int)m[3]);							\
+}
+
+#define SSE41_MSG_2(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[11],								\
+		(int)m[12], (int)m[5], (int)m[15]);							\
+	B[1] = _mm_setr_epi32((int)m[8],								\
+		(int)m[0], (int)m[2], (int)m[13]);							\
+	B[2] = _mm_setr_epi32((int)m[10],								\
+		(int)m[3], (int)m[7], (int)m[9]);							\
+	B[3] = _mm_setr_epi32((int)m[14],								\
+		(int)m[6], (int)m[1], (int)m[4]);							\
+}
+
+#define SSE41_MSG_3(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[7],								\
+		(int)m[3], (int)m[13], (int)m[11]);							\
+	B[1] = _mm_setr_epi32((int)m[9],								\
+		(int)m[1], (int)m[12], (int)m[14]);							\
+	B[2] = _mm_setr_epi32((int)m[2],								\
+		(int)m[5], (int)m[4], (int)m[15]);							\
+	B[3] = _mm_setr_epi32((int)m[6],								\
+		(int)m[10], (int)m[0], (int)m[8]);							\
+}
+
+#define SSE41_MSG_4(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[9],								\
+		(int)m[5], (int)m[2], (int)m[10]);							\
+	B[1] = _mm_setr_epi32((int)m[0],								\
+		(int)m[7], (int)m[4], (int)m[15]);							\
+	B[2] = _mm_setr_epi32((int)m[14],								\
+		(int)m[11], (int)m[6], (int)m[3]);							\
+	B[3] = _mm_setr_epi32((int)m[1],								\
+		(int)m[12], (int)m[8], (int)m[13]);							\
+}
+
+#define SSE41_MSG_5(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[2],								\
+		(int)m[6], (int)m[0], (int)m[8]);							\
+	B[1] = _mm_setr_epi32((int)m[12],								\
+		(int)m[10], (int)m[11], (int)m[3]);							\
+	B[2] = _mm_setr_epi32((int)m[4],								\
+		(int)m[7], (int)m[15], (int)m[1]);							\
+	B[3] = _mm_setr_epi32((int)m[13],								\
+		(int)m[5], (int)m[14], (int)m[9]);							\
+}
+
+#define SSE41_MSG_6(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[12],								\
+		(int)m[1], (int)m[14], (int)m[4]);							\
+	B[1] = _mm_setr_epi32((int)m[5],								\
+		(int)m[15], (int)m[13], (int)m[10]);						\
+	B[2] = _mm_setr_epi32((int)m[0],								\
+		(int)m[6], (int)m[9], (int)m[8]);							\
+	B[3] = _mm_setr_epi32((int)m[7],								\
+		(int)m[3], (int)m[2], (int)m[11]);							\
+}
+
+#define SSE41_MSG_7(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[13],								\
+		(int)m[7], (int)m[12], (int)m[3]);							\
+	B[1] = _mm_setr_epi32((int)m[11],								\
+		(int)m[14], (int)m[1], (int)m[9]);							\
+	B[2] = _mm_setr_epi32((int)m[5],								\
+		(int)m[15], (int)m[8], (int)m[2]);							\
+	B[3] = _mm_setr_epi32((int)m[0],								\
+		(int)m[4], (int)m[6], (int)m[10]);							\
+}
+
+#define SSE41_MSG_8(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[6],								\
+		(int)m[14], (int)m[11], (int)m[0]);							\
+	B[1] = _mm_setr_epi32((int)m[15],								\
+		(int)m[9], (int)m[3], (int)m[8]);							\
+	B[2] = _mm_setr_epi32((int)m[12],								\
+		(int)m[13], (int)m[1], (int)m[10]);							\
+	B[3] = _mm_setr_epi32((int)m[2],								\
+		(int)m[7], (int)m[4], (int)m[5]);							\
+}
+
+#define SSE41_MSG_9(B)												\
+{																	\
+	B[0] = _mm_setr_epi32((int)m[10],								\
+		(int)m[8], (int)m[7], (int)m[1]);							\
+	B[1] = _mm_setr_epi32((int)m[2],								\
+		(int)m[4], (int)m[6], (int)m[5]);							\
+	B[2] = _mm_setr_epi32((int)m[15],								\
+		(int)m[9], (int)m[3], (int)m[13]);							\
+	B[3] = _mm_setr_epi32((int)m[11],								\
+		(int)m[14], (int)m[12], (int)m[0]);							\
+}
+
+#define SSE41_G(A, B, C, D, M0, M1, R0, R1)							\
+{																	\
+	A = _mm_add_epi32(_mm_add_epi32(A, B), M0);						\
+	D = _mm_shuffle_epi8(_mm_xor_si128(D, A), R0);					\
+	C = _mm_add_epi32(C, D);										\
+	B = _mm_xor_si128(B, C);										\
+	B = _mm_or_si128(_mm_srli_epi32(B, 12), _mm_slli_epi32(B, 20));	\
+																	\
+	A = _mm_add_epi32(_mm_add_epi32(A, B), M1);						\
+	D = _mm_shuffle_epi8(_mm_xor_si128(D, A), R1);					\
+	C = _mm_add_epi32(C, D);										\
+	B = _mm_xor_si128(B, C);										\
+	B = _mm_or_si128(_mm_srli_epi32(B, 7), _mm_slli_epi32(B, 25));	\
+}
+
+#define SSE41_ROUND(N)												\
+{																	\
+	SSE41_MSG_##N(b);												\
+	SSE41_G(v[0], v[1], v[2], v[3], b[0], b[1], r16, r8);			\
+	v[1] = _mm_shuffle_epi32(v[1], 0x39);							\
+	v[2] = _mm_shuffle_epi32(v[2], 0x4E);							\
+	v[3] = _mm_shuffle_epi32(v[3], 0x93);							\
+	SSE41_G(v[0], v[1], v[2], v[3], b[2], b[3], r16, r8);			\
+	v[1] = _mm_shuffle_epi32(v[1], 0x93);							\
+	v[2] = _mm_shuffle_epi32(v[2], 0x4E);							\
+	v[3] = _mm_shuffle_epi32(v[3], 0x39);							\
+}
+
+/* a round for each of the 10 permutations, until r */
+#define ROUNDS(ROUND)												\
+{																	\
+	for(i = 0;;)													\
+	{																\
+		ROUND(0); if(++i == r) break;								\
+		ROUND(1); if(++i == r) break;								\
+		ROUND(2); if(++i == r) break;								\
+		ROUND(3); if(++i == r) break;								\
+		ROUND(4); if(++i == r) break;								\
+		ROUND(5); if(++i == r) break;								\
+		ROUND(6); if(++i == r) break;								\
+		ROUND(7); if(++i == r) break;								\
+		ROUND(8); if(++i == r) break;								\
+		ROUND(9); if(++i == r) break;								\
+	}																\
+}
+
+KRIPTO_TARGET("sse4.1")
+static void blake2s_sse41(kripto_hash *s, const uint8_t *data)
+{
+	__m128i v[4];
+	__m128i b[4];
+	uint32_t m[16];
+	const __m128i r8 = _mm_setr_epi8
+	(
+		1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12
+	);
+	const __m128i r16 = _mm_setr_epi8
+	(
+		2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13
+	);
+	const unsigned int r = s->r;
+	unsigned int i;
+
+	memcpy(m, data, 64);
+
+	v[0] = LOADU(s->h);
+	v[1] = LOADU(s->h + 4);
+	v[2] = LOADU(iv);
+	v[3] = _mm_xor_si128(LOADU(iv + 4),
+		_mm_setr_epi32((int)s->len[0], (int)s->len[1], (int)s->f, 0));
+
+	ROUNDS(SSE41_ROUND);
+
+	STOREU(s->h, _mm_xor_si128(LOADU(s->h), _mm_xor_si128(v[0], v[2])));
+	STOREU(s->h + 4,
+		_mm_xor_si128(LOADU(s->h + 4), _mm_xor_si128(v[1], v[3])));
+
+	kripto_memwipe(m, 64);
+}
+
+#endif
+
 static void blake2s_process(kripto_hash *s, const uint8_t *data)
 {
 	uint32_t x0;
@@ -118,6 +330,14 @@ static void blake2s_process(kripto_hash *s, const uint8_t *data)
 	unsigned int r;
 	unsigned int i;
 
+	#ifdef KRIPTO_X86_SIMD
+	if(kripto_cpu() & KRIPTO_CPU_SSE41)
+	{
+		blake2s_sse41(s, data);
+		return;
+	}
+	#endif
+
 	m[0] = LOAD32L(data);
 	m[1] = LOAD32L(data + 4);
 	m[2] = LOAD32L(data + 8);
@@ -186,24 +406,50 @@ static void blake2s_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		if(s->i == 64)
+		if(s->i)
 		{
-			s->len[0] += 64;
-			if(!s->len[0])
-			{
-				s->len[1]++;
-				assert(s->len[1]);
-			}
-
-			blake2s_process(s, s->buf);
-			s->i = 0;
+			/* fill the buffer */
+			n = 64 - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
+
+			if(!len) return; /* keep the last block */
+
+			block = s->buf;
+		}
+		else if(len > 64)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 64;
+			len -= 64;
+		}
+		else
+		{
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
 		}
 
-		s->buf[s->i++] = CU8(in)[i];
+		s->len[0] += 64;
+		if(!s->len[0])
+		{
+			s->len[1]++;
+			assert(s->len[1]);
+		}
+
+		blake2s_process(s, block);
+		s->i = 0;
 	}
 }
 
@@ -249,6 +495,43 @@ static kripto_hash *blake2s_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void blake2s_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void blake2s_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->r, p);
+	for(i = 0; i < 8; i++) STORE32L(s->h[i], p + 4 + (i << 2));
+	for(i = 0; i < 2; i++) STORE32L(s->len[i], p + 36 + (i << 2));
+	STORE32L(s->f, p + 44);
+	memcpy(p + 48, s->buf, 64);
+	STORE32L(s->i, p + 112);
+}
+
+static int blake2s_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	unsigned int i;
+
+	/* sigma wraps, but the round loops run at least once */
+	if(!LOAD32L(p)) return -1;
+	if(LOAD32L(p + 112) > (LOAD32L(p + 44) ? 32 : 64)) return -1;
+
+	s->r = LOAD32L(p);
+	for(i = 0; i < 8; i++) s->h[i] = LOAD32L(p + 4 + (i << 2));
+	for(i = 0; i < 2; i++) s->len[i] = LOAD32L(p + 36 + (i << 2));
+	s->f = LOAD32L(p + 44);
+	memcpy(s->buf, p + 48, 64);
+	s->i = LOAD32L(p + 112);
+
+	return 0;
+}
+
 static void blake2s_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
@@ -281,10 +564,15 @@ static const kripto_hash_desc blake2s =
 	&blake2s_recreate,
 	&blake2s_input,
 	&blake2s_output,
+	&blake2s_copy,
+	&blake2s_export,
+	&blake2s_import,
 	&blake2s_destroy,
 	&blake2s_hash,
+	0, /* hash_many */
 	32, /* max output */
-	64 /* block_size */
+	64, /* block_size */
+	116 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_blake2s = &blake2s;
@@ -0,0 +1,581 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#include <kripto/cast.h>
+#include <kripto/loadstore.h>
+#include <kripto/rotate.h>
+#include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
+#include <kripto/hash.h>
+#include <kripto/desc/hash.h>
+#include <kripto/object/hash.h>
+
+#include <kripto/hash/blake2sp.h>
+
+/*
+ * BLAKE2sp: 8 BLAKE2s leaves, leaf l takes blocks l, l + 8, l + 16...
+ * of the message, and a root hashes the 8 leaf digests. The leaves
+ * always move together one stripe (8 blocks) at a time until the end.
+ */
+
+#define LEAVES 8
+#define STRIPE (LEAVES << 6)
+
+/* a stripe is compressed once every leaf has input after it */
+#define LOOKAHEAD (STRIPE - 64)
+
+struct kripto_hash
+{
+	struct kripto_hash_object obj;
+	unsigned int r;
+	unsigned int i;
+	int o;
+	uint32_t h[8 * LEAVES]; /* word j of leaf l at [j * LEAVES + l] */
+	uint32_t root[8];
+	uint64_t len; /* bytes of each leaf */
+	uint8_t buf[STRIPE << 1];
+};
+
+static const uint8_t sigma[10][16] =
+{
+	{ 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15},
+	{14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3},
+	{11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4},
+	{ 7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8},
+	{ 9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13},
+	{ 2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9},
+	{12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11},
+	{13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10},
+	{ 6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5},
+	{10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0}
+};
+
+static const uint32_t iv[8] =
+{
+	0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+	0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+static kripto_hash *blake2sp_recreate
+(
+	kripto_hash *s,
+	unsigned int r,
+	size_t len
+)
+{
+	unsigned int i;
+	unsigned int l;
+
+	s->r = r;
+	if(!s->r) s->r = 10;
+
+	s->len = s->o = s->i = 0;
+
+	for(i = 0; i < 8; i++)
+	{
+		for(l = 0; l < LEAVES; l++) s->h[i * LEAVES + l] = iv[i];
+		s->root[i] = iv[i];
+	}
+
+	/* digest length, fanout 8, depth 2, node offset, inner length 32 */
+	for(l = 0; l < LEAVES; l++)
+	{
+		s->h[l] ^= 0x02080000 ^ (uint8_t)len;
+		s->h[(LEAVES << 1) + l] ^= l;
+		s->h[LEAVES * 3 + l] ^= 0x20000000;
+	}
+
+	/* and node depth 1 */
+	s->root[0] ^= 0x02080000 ^ (uint8_t)len;
+	s->root[3] ^= 0x20010000;
+
+	return s;
+}
+
+#define G(A, B, C, D, M0, M1)	\
+{								\
+	A += B + (M0);				\
+	D = ROR32_16(D ^ A);		\
+	C += D;						\
+	B = ROR32_12(B ^ C);		\
+								\
+	A += B + (M1);				\
+	D = ROR32_08(D ^ A);		\
+	C += D;						\
+	B = ROR32_07(B ^ C);		\
+}
+
+/* one BLAKE2s compression of h, word j at h[j * n] */
+static void blake2sp_compress
+(
+	uint32_t *h,
+	unsigned int n,
+	const uint8_t *data,
+	uint64_t t,
+	uint32_t f0,
+	uint32_t f1,
+	unsigned int rounds
+)
+{
+	uint32_t x[16];
+	uint32_t m[16];
+	unsigned int r;
+	unsigned int i;
+
+	for(i = 0; i < 16; i++) m[i] = LOAD32L(data + (i << 2));
+
+	for(i = 0; i < 8; i++)
+	{
+		x[i] = h[i * n];
+		x[i + 8] = iv[i];
+	}
+	x[12] ^= (uint32_t)t;
+	x[13] ^= (uint32_t)(t >> 32);
+	x[14] ^= f0;
+	x[15] ^= f1;
+
+	for(r = 0, i = 0; r < rounds; r++, i++)
+	{
+		if(i == 10) i = 0;
+
+		G(x[0], x[4], x[8], x[12], m[sigma[i][0]], m[sigma[i][1]]);
+		G(x[1], x[5], x[9], x[13], m[sigma[i][2]], m[sigma[i][3]]);
+		G(x[2], x[6], x[10], x[14], m[sigma[i][4]], m[sigma[i][5]]);
+		G(x[3], x[7], x[11], x[15], m[sigma[i][6]], m[sigma[i][7]]);
+
+		G(x[0], x[5], x[10], x[15], m[sigma[i][8]], m[sigma[i][9]]);
+		G(x[1], x[6], x[11], x[12], m[sigma[i][10]], m[sigma[i][11]]);
+		G(x[2], x[7], x[8], x[13], m[sigma[i][12]], m[sigma[i][13]]);
+		G(x[3], x[4], x[9], x[14], m[sigma[i][14]], m[sigma[i][15]]);
+	}
+
+	for(i = 0; i < 8; i++) h[i * n] ^= x[i] ^ x[i + 8];
+
+	kripto_memwipe(m, 64);
+	kripto_memwipe(x, 64);
+}
+
+#ifdef KRIPTO_X86_SIMD
+
+/* words 8i...8i + 7 of the 8 leaf blocks at P, one leaf per lane */
+#define AVX2_LOAD8(M, P, I, T)										\
+{																	\
+	for(j = 0; j < 8; j++)											\
+		T[j] = LOADU256(P + (j << 6) + ((I) << 5));					\
+																	\
+	T[8] = _mm256_unpacklo_epi32(T[0], T[1]);						\
+	T[9] = _mm256_unpackhi_epi32(T[0], T[1]);						\
+	T[10] = _mm256_unpacklo_epi32(T[2], T[3]);						\
+	T[11] = _mm256_unpackhi_epi32(T[2], T[3]);						\
+	T[12] = _mm256_unpacklo_epi32(T[4], T[5]);						\
+	T[13] = _mm256_unpackhi_epi32(T[4], T[5]);						\
+	T[14] = _mm256_unpacklo_epi32(T[6], T[7]);						\
+	T[15] = _mm256_unpackhi_epi32(T[6], T[7]);						\
+																	\
+	T[0] = _mm256_unpacklo_epi64(T[8], T[10]);						\
+	T[1] = _mm256_unpackhi_epi64(T[8], T[10]);						\
+	T[2] = _mm256_unpacklo_epi64(T[9], T[11]);						\
+	T[3] = _mm256_unpackhi_epi64(T[9], T[11]);						\
+	T[4] = _mm256_unpacklo_epi64(T[12], T[14]);						\
+	T[5] = _mm256_unpackhi_epi64(T[12], T[14]);						\
+	T[6] = _mm256_unpacklo_epi64(T[13], T[15]);						\
+	T[7] = _mm256_unpackhi_epi64(T[13], T[15]);						\
+																	\
+	for(j = 0; j < 4; j++)											\
+	{																\
+		M[((I) << 3) + j] =											\
+			_mm256_permute2x128_si256(T[j], T[j + 4], 0x20);		\
+		M[((I) << 3) + j + 4] =										\
+			_mm256_permute2x128_si256(T[j], T[j + 4], 0x31);		\
+	}																\
+}
+
+#define AVX2_ROR(X, N)												\
+	_mm256_or_si256(_mm256_srli_epi32(X, N), _mm256_slli_epi32(X, 32 - (N)))
+
+#define AVX2_G(A, B, C, D, M0, M1)									\
+{																	\
+	A = _mm256_add_epi32(_mm256_add_epi32(A, B), M0);				\
+	D = _mm256_shuffle_epi8(_mm256_xor_si256(D, A), r16);			\
+	C = _mm256_add_epi32(C, D);										\
+	B = AVX2_ROR(_mm256_xor_si256(B, C), 12);						\
+																	\
+	A = _mm256_add_epi32(_mm256_add_epi32(A, B), M1);				\
+	D = _mm256_shuffle_epi8(_mm256_xor_si256(D, A), r8);			\
+	C = _mm256_add_epi32(C, D);										\
+	B = AVX2_ROR(_mm256_xor_si256(B, C), 7);						\
+}
+
+#define AVX2_ROUND(N)												\
+{																	\
+	AVX2_G(x[0], x[4], x[8], x[12],									\
+		m[sigma[N][0]], m[sigma[N][1]]);							\
+	AVX2_G(x[1], x[5], x[9], x[13],									\
+		m[sigma[N][2]], m[sigma[N][3]]);							\
+	AVX2_G(x[2], x[6], x[10], x[14],								\
+		m[sigma[N][4]], m[sigma[N][5]]);							\
+	AVX2_G(x[3], x[7], x[11], x[15],								\
+		m[sigma[N][6]], m[sigma[N][7]]);							\
+																	\
+	AVX2_G(x[0], x[5], x[10], x[15],								\
+		m[sigma[N][8]], m[sigma[N][9]]);							\
+	AVX2_G(x[1], x[6], x[11], x[12],								\
+		m[sigma[N][10]], m[sigma[N][11]]);							\
+	AVX2_G(x[2], x[7], x[8], x[13],									\
+		m[sigma[N][12]], m[sigma[N][13]]);							\
+	AVX2_G(x[3], x[4], x[9], x[14],									\
+		m[sigma[N][14]], m[sigma[N][15]]);							\
+}
+
+/* a round for each of the 10 permutations, until r */
+#define ROUNDS(ROUND)												\
+{																	\
+	for(i = 0;;)													\
+	{																\
+		ROUND(0); if(++i == r) break;								\
+		ROUND(1); if(++i == r) break;								\
+		ROUND(2); if(++i == r) break;								\
+		ROUND(3); if(++i == r) break;								\
+		ROUND(4); if(++i == r) break;								\
+		ROUND(5); if(++i == r) break;								\
+		ROUND(6); if(++i == r) break;								\
+		ROUND(7); if(++i == r) break;								\
+		ROUND(8); if(++i == r) break;								\
+		ROUND(9); if(++i == r) break;								\
+	}																\
+}
+
+/* whole stripes, all 8 leaves at once (one per 32-bit lane) */
+KRIPTO_TARGET("avx2")
+static void blake2sp_avx2
+(
+	uint32_t *h,
+	const uint8_t *in,
+	size_t stripes,
+	uint64_t t,
+	unsigned int r
+)
+{
+	__m256i v[8];
+	__m256i x[16];
+	__m256i m[16];
+	__m256i tmp[16];
+	const __m256i r8 = _mm256_setr_epi8
+	(
+		1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+		1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12
+	);
+	const __m256i r16 = _mm256_setr_epi8
+	(
+		2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+		2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13
+	);
+	unsigned int i;
+	unsigned int j;
+
+	for(i = 0; i < 8; i++) v[i] = LOADU256(h + (i << 3));
+
+	for(; stripes; stripes--)
+	{
+		t += 64;
+
+		AVX2_LOAD8(m, in, 0, tmp);
+		AVX2_LOAD8(m, in, 1, tmp);
+
+		for(i = 0; i < 8; i++)
+		{
+			x[i] = v[i];
+			x[i + 8] = _mm256_set1_epi32((int)iv[i]);
+		}
+		x[12] = _mm256_set1_epi32((int)(iv[4] ^ (uint32_t)t));
+		x[13] = _mm256_set1_epi32((int)(iv[5] ^ (uint32_t)(t >> 32)));
+
+		ROUNDS(AVX2_ROUND);
+
+		for(i = 0; i < 8; i++)
+			v[i] = _mm256_xor_si256(v[i], _mm256_xor_si256(x[i], x[i + 8]));
+
+		in += STRIPE;
+	}
+
+	for(i = 0; i < 8; i++) STOREU256(h + (i << 3), v[i]);
+}
+
+#endif
+
+static void blake2sp_stripes
+(
+	kripto_hash *s,
+	const uint8_t *in,
+	size_t stripes
+)
+{
+	uint64_t t;
+	size_t n;
+	unsigned int l;
+
+	#ifdef KRIPTO_X86_SIMD
+	if(kripto_cpu() & KRIPTO_CPU_AVX2)
+	{
+		blake2sp_avx2(s->h, in, stripes, s->len, s->r);
+		s->len += (uint64_t)stripes << 6;
+		return;
+	}
+	#endif
+
+	/* a stripe at a time, every leaf over its own block */
+	t = s->len;
+	for(n = 0; n < stripes; n++)
+	{
+		t += 64;
+
+		for(l = 0; l < LEAVES; l++)
+		{
+			blake2sp_compress
+			(
+				s->h + l,
+				LEAVES,
+				in + n * STRIPE + (l << 6),
+				t,
+				0,
+				0,
+				s->r
+			);
+		}
+	}
+
+	s->len += (uint64_t)stripes << 6;
+}
+
+static void blake2sp_input
+(
+	kripto_hash *s,
+	const void *in,
+	size_t len
+)
+{
+	size_t n;
+
+	/* fill the buffer */
+	while(s->i && len)
+	{
+		if(s->i < STRIPE)
+		{
+			n = STRIPE - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
+		}
+
+		if(s->i + len <= STRIPE + LOOKAHEAD)
+		{
+			memcpy(s->buf + s->i, in, len);
+			s->i += len;
+			return;
+		}
+
+		blake2sp_stripes(s, s->buf, 1);
+
+		s->i -= STRIPE;
+		memmove(s->buf, s->buf + STRIPE, s->i);
+	}
+
+	/* whole stripes straight from in */
+	if(len > STRIPE + LOOKAHEAD)
+	{
+		n = (len - LOOKAHEAD - 1) / STRIPE;
+
+		blake2sp_stripes(s, in, n);
+		in = CU8(in) + n * STRIPE;
+		len -= n * STRIPE;
+	}
+
+	/* buffer the rest */
+	if(len)
+	{
+		memcpy(s->buf + s->i, in, len);
+		s->i += len;
+	}
+}
+
+static void blake2sp_finish(kripto_hash *s)
+{
+	const unsigned int n = s->i;
+	unsigned int a;
+	unsigned int b;
+	unsigned int l;
+
+	memset(s->buf + n, 0, sizeof(s->buf) - n);
+
+	/* last 1 or 2 blocks of each leaf */
+	for(l = 0; l < LEAVES; l++)
+	{
+		a = l << 6;
+		b = a + STRIPE;
+
+		if(n > b)
+		{
+			blake2sp_compress(s->h + l, LEAVES, s->buf + a,
+				s->len + 64, 0, 0, s->r);
+
+			a = b;
+			b = n - b < 64 ? n - b : 64;
+			blake2sp_compress(s->h + l, LEAVES, s->buf + a,
+				s->len + 64 + b, 0xFFFFFFFF,
+				l == LEAVES - 1 ? 0xFFFFFFFF : 0, s->r);
+		}
+		else
+		{
+			b = n > a ? (n - a < 64 ? n - a : 64) : 0;
+			blake2sp_compress(s->h + l, LEAVES, s->buf + a,
+				s->len + b, 0xFFFFFFFF,
+				l == LEAVES - 1 ? 0xFFFFFFFF : 0, s->r);
+		}
+	}
+
+	/* root over the leaf digests */
+	for(l = 0; l < LEAVES; l++)
+	{
+		for(a = 0; a < 8; a++)
+			STORE32L(s->h[a * LEAVES + l], s->buf + (l << 5) + (a << 2));
+	}
+
+	for(l = 0; l < 3; l++)
+		blake2sp_compress(s->root, 1, s->buf + (l << 6), (l + 1) << 6,
+			0, 0, s->r);
+	blake2sp_compress(s->root, 1, s->buf + 192, 256,
+		0xFFFFFFFF, 0xFFFFFFFF, s->r);
+
+	s->i = 0;
+	s->o = -1;
+}
+
+static void blake2sp_output(kripto_hash *s, void *out, size_t len)
+{
+	unsigned int i;
+
+	if(!s->o) blake2sp_finish(s);
+
+	/* little endian */
+	for(i = 0; i < len; s->i++, i++)
+		U8(out)[i] = s->root[s->i >> 2] >> ((s->i & 3) << 3);
+}
+
+static kripto_hash *blake2sp_create(unsigned int r, size_t len)
+{
+	kripto_hash *s;
+
+	s = malloc(sizeof(kripto_hash));
+	if(!s) return 0;
+
+	s->obj.desc = kripto_hash_blake2sp;
+
+	(void)blake2sp_recreate(s, r, len);
+
+	return s;
+}
+
+static void blake2sp_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void blake2sp_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->r, p);
+	for(i = 0; i < 8 * LEAVES; i++) STORE32L(s->h[i], p + 4 + (i << 2));
+	for(i = 0; i < 8; i++) STORE32L(s->root[i], p + 260 + (i << 2));
+	STORE64L(s->len, p + 292);
+	memcpy(p + 300, s->buf, sizeof(s->buf));
+	STORE32L(s->i, p + 1324);
+	p[1328] = s->o != 0;
+}
+
+static int blake2sp_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	unsigned int i;
+
+	/* sigma wraps, but the round loops run at least once */
+	if(!LOAD32L(p)) return -1;
+	if(LOAD32L(p + 1324) > (p[1328] ? 32 : STRIPE + LOOKAHEAD)) return -1;
+
+	s->r = LOAD32L(p);
+	for(i = 0; i < 8 * LEAVES; i++) s->h[i] = LOAD32L(p + 4 + (i << 2));
+	for(i = 0; i < 8; i++) s->root[i] = LOAD32L(p + 260 + (i << 2));
+	s->len = LOAD64L(p + 292);
+	memcpy(s->buf, p + 300, sizeof(s->buf));
+	s->i = LOAD32L(p + 1324);
+	s->o = p[1328] ? -1 : 0;
+
+	return 0;
+}
+
+static void blake2sp_destroy(kripto_hash *s)
+{
+	kripto_memwipe(s, sizeof(kripto_hash));
+	free(s);
+}
+
+static int blake2sp_hash
+(
+	unsigned int r,
+	const void *in,
+	size_t in_len,
+	void *out,
+	size_t out_len
+)
+{
+	kripto_hash s;
+
+	(void)blake2sp_recreate(&s, r, out_len);
+	blake2sp_input(&s, in, in_len);
+	blake2sp_output(&s, out, out_len);
+
+	kripto_memwipe(&s, sizeof(kripto_hash));
+
+	return 0;
+}
+
+static const kripto_hash_desc blake2sp =
+{
+	&blake2sp_create,
+	&blake2sp_recreate,
+	&blake2sp_input,
+	&blake2sp_output,
+	&blake2sp_copy,
+	&blake2sp_export,
+	&blake2sp_import,
+	&blake2sp_destroy,
+	&blake2sp_hash,
+	0, /* hash_many */
+	32, /* max output */
+	64, /* block_size */
+	1329 /* state size */
+};
+
+const kripto_hash_desc *const kripto_hash_blake2sp = &blake2sp;
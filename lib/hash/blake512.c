@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
 
@@ -209,24 +210,50 @@ static void blake512_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		s->buf[s->i++] = CU8(in)[i];
+		if(s->i)
+		{
+			/* fill the buffer */
+			n = 128 - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
+
+			if(s->i < 128) return;
+
+			block = s->buf;
+		}
+		else if(len >= 128)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 128;
+			len -= 128;
+		}
+		else
+		{
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
+		}
 
-		if(s->i == 128)
+		s->len[0] += 1024;
+		if(!s->len[0])
 		{
-			s->len[0] += 1024;
-			if(!s->len[0])
-			{
-				s->len[1]++;
-				assert(s->len[1]);
-			}
-
-			blake512_process(s, s->buf);
-			s->i = 0;
+			s->len[1]++;
+			assert(s->len[1]);
 		}
+
+		blake512_process(s, block);
+		s->i = 0;
 	}
 }
 
@@ -285,6 +312,43 @@ static kripto_hash *blake512_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void blake512_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void blake512_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->r, p);
+	for(i = 0; i < 8; i++) STORE64L(s->h[i], p + 4 + (i << 3));
+	for(i = 0; i < 2; i++) STORE64L(s->len[i], p + 68 + (i << 3));
+	memcpy(p + 84, s->buf, 128);
+	STORE32L(s->i, p + 212);
+	STORE32L(s->o, p + 216);
+}
+
+static int blake512_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	const uint32_t o = LOAD32L(p + 216);
+	unsigned int i;
+
+	if(!LOAD32L(p)) return -1;
+	if(o > 64 || LOAD32L(p + 212) > (o ? 127 : 64)) return -1;
+
+	s->r = LOAD32L(p);
+	for(i = 0; i < 8; i++) s->h[i] = LOAD64L(p + 4 + (i << 3));
+	for(i = 0; i < 2; i++) s->len[i] = LOAD64L(p + 68 + (i << 3));
+	memcpy(s->buf, p + 84, 128);
+	s->i = LOAD32L(p + 212);
+	s->o = o;
+
+	return 0;
+}
+
 static void blake512_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
@@ -317,10 +381,15 @@ static const kripto_hash_desc blake512 =
 	&blake512_recreate,
 	&blake512_input,
 	&blake512_output,
+	&blake512_copy,
+	&blake512_export,
+	&blake512_import,
 	&blake512_destroy,
 	&blake512_hash,
+	0, /* hash_many */
 	64, /* max output */
-	128 /* block_size */
+	128, /* block_size */
+	220 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_blake512 = &blake512;
@@ -21,20 +21,20 @@
 #include <kripto/loadstore.h>
 #include <kripto/rotate.h>
 #include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
+#include <kripto/lanes.h>
 #include <kripto/hash.h>
 #include <kripto/desc/hash.h>
 #include <kripto/object/hash.h>
 
+#include <kripto/keccak.h>
 #include <kripto/hash/keccak1600.h>
 
 struct kripto_hash
 {
 	struct kripto_hash_object obj;
-	unsigned int r;
-	unsigned int rate;
-	unsigned int i;
-	int o;
-	uint8_t s[200];
+	struct kripto_keccak1600 k;
 };
 
 static const uint64_t rc[48] = 
@@ -65,33 +65,33 @@ static const uint64_t rc[48] =
 	0x0000000080000080, 0x0000000080008003
 };
 
-static void keccak1600_F(kripto_hash *s)
-{
-	uint64_t a0 = LOAD64L(s->s);
-	uint64_t a1 = LOAD64L(s->s + 8);
-	uint64_t a2 = LOAD64L(s->s + 16);
-	uint64_t a3 = LOAD64L(s->s + 24);
-	uint64_t a4 = LOAD64L(s->s + 32);
-	uint64_t a5 = LOAD64L(s->s + 40);
-	uint64_t a6 = LOAD64L(s->s + 48);
-	uint64_t a7 = LOAD64L(s->s + 56);
-	uint64_t a8 = LOAD64L(s->s + 64);
-	uint64_t a9 = LOAD64L(s->s + 72);
-	uint64_t a10 = LOAD64L(s->s + 80);
-	uint64_t a11 = LOAD64L(s->s + 88);
-	uint64_t a12 = LOAD64L(s->s + 96);
-	uint64_t a13 = LOAD64L(s->s + 104);
-	uint64_t a14 = LOAD64L(s->s + 112);
-	uint64_t a15 = LOAD64L(s->s + 120);
-	uint64_t a16 = LOAD64L(s->s + 128);
-	uint64_t a17 = LOAD64L(s->s + 136);
-	uint64_t a18 = LOAD64L(s->s + 144);
-	uint64_t a19 = LOAD64L(s->s + 152);
-	uint64_t a20 = LOAD64L(s->s + 160);
-	uint64_t a21 = LOAD64L(s->s + 168);
-	uint64_t a22 = LOAD64L(s->s + 176);
-	uint64_t a23 = LOAD64L(s->s + 184);
-	uint64_t a24 = LOAD64L(s->s + 192);
+static void keccak1600_F(uint64_t *s, unsigned int r)
+{
+	uint64_t a0 = s[0];
+	uint64_t a1 = s[1];
+	uint64_t a2 = s[2];
+	uint64_t a3 = s[3];
+	uint64_t a4 = s[4];
+	uint64_t a5 = s[5];
+	uint64_t a6 = s[6];
+	uint64_t a7 = s[7];
+	uint64_t a8 = s[8];
+	uint64_t a9 = s[9];
+	uint64_t a10 = s[10];
+	uint64_t a11 = s[11];
+	uint64_t a12 = s[12];
+	uint64_t a13 = s[13];
+	uint64_t a14 = s[14];
+	uint64_t a15 = s[15];
+	uint64_t a16 = s[16];
+	uint64_t a17 = s[17];
+	uint64_t a18 = s[18];
+	uint64_t a19 = s[19];
+	uint64_t a20 = s[20];
+	uint64_t a21 = s[21];
+	uint64_t a22 = s[22];
+	uint64_t a23 = s[23];
+	uint64_t a24 = s[24];
 
 	uint64_t b0;
 	uint64_t b1;
@@ -133,7 +133,7 @@ static void keccak1600_F(kripto_hash *s)
 
 	unsigned int i;
 
-	for(i = 0; i < s->r; i++)
+	for(i = 0; i < r; i++)
 	{
 		c0 = a0 ^ a5 ^ a10 ^ a15 ^ a20;
 		c1 = a1 ^ a6 ^ a11 ^ a16 ^ a21;
@@ -259,38 +259,151 @@ static void keccak1600_F(kripto_hash *s)
 		a24 = b24;
 	}
 
-	STORE64L(a0, s->s);
-	STORE64L(a1, s->s + 8);
-	STORE64L(a2, s->s + 16);
-	STORE64L(a3, s->s + 24);
-	STORE64L(a4, s->s + 32);
-	STORE64L(a5, s->s + 40);
-	STORE64L(a6, s->s + 48);
-	STORE64L(a7, s->s + 56);
-	STORE64L(a8, s->s + 64);
-	STORE64L(a9, s->s + 72);
-	STORE64L(a10, s->s + 80);
-	STORE64L(a11, s->s + 88);
-	STORE64L(a12, s->s + 96);
-	STORE64L(a13, s->s + 104);
-	STORE64L(a14, s->s + 112);
-	STORE64L(a15, s->s + 120);
-	STORE64L(a16, s->s + 128);
-	STORE64L(a17, s->s + 136);
-	STORE64L(a18, s->s + 144);
-	STORE64L(a19, s->s + 152);
-	STORE64L(a20, s->s + 160);
-	STORE64L(a21, s->s + 168);
-	STORE64L(a22, s->s + 176);
-	STORE64L(a23, s->s + 184);
-	STORE64L(a24, s->s + 192);
+	s[0] = a0;
+	s[1] = a1;
+	s[2] = a2;
+	s[3] = a3;
+	s[4] = a4;
+	s[5] = a5;
+	s[6] = a6;
+	s[7] = a7;
+	s[8] = a8;
+	s[9] = a9;
+	s[10] = a10;
+	s[11] = a11;
+	s[12] = a12;
+	s[13] = a13;
+	s[14] = a14;
+	s[15] = a15;
+	s[16] = a16;
+	s[17] = a17;
+	s[18] = a18;
+	s[19] = a19;
+	s[20] = a20;
+	s[21] = a21;
+	s[22] = a22;
+	s[23] = a23;
+	s[24] = a24;
 }
 
-static kripto_hash *keccak1600_recreate
+/* XORs in into the state bytes i...i + n - 1 */
+static void keccak1600_xor
 (
-	kripto_hash *s,
+	uint64_t *s,
+	unsigned int i,
+	const uint8_t *in,
+	size_t n
+)
+{
+	size_t j = 0;
+
+	for(; j < n && (i & 7); j++, i++)
+		s[i >> 3] ^= (uint64_t)in[j] << ((i & 7) << 3);
+
+	for(; j + 8 <= n; j += 8, i += 8)
+		s[i >> 3] ^= LOAD64L(in + j);
+
+	for(; j < n; j++, i++)
+		s[i >> 3] ^= (uint64_t)in[j] << ((i & 7) << 3);
+}
+
+/* out = in ^ state bytes i...i + n - 1, or just the state if !in */
+static void keccak1600_extract
+(
+	const uint64_t *s,
+	unsigned int i,
+	const uint8_t *in,
+	uint8_t *out,
+	size_t n
+)
+{
+	size_t j = 0;
+
+	if(!in)
+	{
+		for(; j < n && (i & 7); j++, i++)
+			out[j] = s[i >> 3] >> ((i & 7) << 3);
+
+		for(; j + 8 <= n; j += 8, i += 8)
+			STORE64L(s[i >> 3], out + j);
+
+		for(; j < n; j++, i++)
+			out[j] = s[i >> 3] >> ((i & 7) << 3);
+	}
+	else
+	{
+		for(; j < n && (i & 7); j++, i++)
+			out[j] = in[j] ^ (uint8_t)(s[i >> 3] >> ((i & 7) << 3));
+
+		for(; j + 8 <= n; j += 8, i += 8)
+			STORE64L(LOAD64L(in + j) ^ s[i >> 3], out + j);
+
+		for(; j < n; j++, i++)
+			out[j] = in[j] ^ (uint8_t)(s[i >> 3] >> ((i & 7) << 3));
+	}
+}
+
+/*
+ * out = in ^ state bytes i...i + n - 1, which then become the
+ * ciphertext: out when encrypting, in when decrypting
+ */
+static void keccak1600_duplex
+(
+	uint64_t *s,
+	unsigned int i,
+	const uint8_t *in,
+	uint8_t *out,
+	size_t n,
+	int decrypt
+)
+{
+	size_t j = 0;
+	uint64_t t;
+	uint8_t k;
+
+	for(; j < n && (i & 7); j++, i++)
+	{
+		k = s[i >> 3] >> ((i & 7) << 3);
+		t = decrypt ? in[j] : in[j] ^ k;
+		out[j] = in[j] ^ k;
+		s[i >> 3] ^= (t ^ k) << ((i & 7) << 3);
+	}
+
+	for(; j + 8 <= n; j += 8, i += 8)
+	{
+		t = LOAD64L(in + j);
+		STORE64L(t ^ s[i >> 3], out + j);
+		s[i >> 3] = decrypt ? t : t ^ s[i >> 3];
+	}
+
+	for(; j < n; j++, i++)
+	{
+		k = s[i >> 3] >> ((i & 7) << 3);
+		t = decrypt ? in[j] : in[j] ^ k;
+		out[j] = in[j] ^ k;
+		s[i >> 3] ^= (t ^ k) << ((i & 7) << 3);
+	}
+}
+
+/* pads at byte i (none there if i is past the state) and permutes */
+static void keccak1600_pad(struct kripto_keccak1600 *s)
+{
+	if(s->i < sizeof(s->s))
+		s->s[s->i >> 3] ^= (uint64_t)0x01 << ((s->i & 7) << 3);
+
+	s->s[(s->rate - 1) >> 3] ^=
+		(uint64_t)0x80 << (((s->rate - 1) & 7) << 3);
+
+	keccak1600_F(s->s, s->r);
+
+	s->i = 0;
+}
+
+void kripto_keccak1600_init
+(
+	struct kripto_keccak1600 *s,
 	unsigned int r,
-	size_t len
+	unsigned int rate
 )
 {
 	s->o = s->i = 0;
@@ -298,73 +411,179 @@ static kripto_hash *keccak1600_recreate
 	s->r = r;
 	if(!s->r) s->r = 24;
 
-	s->rate = 200 - (len << 1);
+	s->rate = rate;
 
-	memset(s->s, 0, 200);
-
-	return s;
+	memset(s->s, 0, sizeof(s->s));
 }
 
-static void keccak1600_input
+void kripto_keccak1600_input
 (
-	kripto_hash *s,
+	struct kripto_keccak1600 *s,
 	const void *in,
 	size_t len
-) 
+)
 {
-	size_t i;
+	size_t n;
 
-	/* switch back to input mode */
-	if(s->o) s->o = s->i = 0;
+	/* switch back to input mode, after a duplex in the same block */
+	if(s->o > 0) s->o = 0;
+	else if(s->o) s->o = s->i = 0;
 
-	/* input */
-	for(i = 0; i < len; i++)
+	while(len)
 	{
 		if(s->i == s->rate)
 		{
-			keccak1600_F(s);
+			keccak1600_F(s->s, s->r);
 			s->i = 0;
 		}
 
-		s->s[s->i++] ^= CU8(in)[i];
+		n = s->rate - s->i;
+		if(n > len) n = len;
+
+		keccak1600_xor(s->s, s->i, in, n);
+		s->i += n;
+		in = CU8(in) + n;
+		len -= n;
 	}
 }
 
-static void keccak1600_output
+static void keccak1600_squeeze
 (
-	kripto_hash *s,
-	void *out,
+	struct kripto_keccak1600 *s,
+	const uint8_t *in,
+	uint8_t *out,
 	size_t len
 )
 {
-	size_t i;
+	size_t n;
 
 	/* switch to output mode */
-	if(!s->o)
+	if(s->o >= 0)
 	{
-		/* pad */
-		s->s[s->i] ^= 0x01;
-		s->s[s->rate - 1] ^= 0x80;
-
-		keccak1600_F(s);
-
-		s->i = 0;
+		keccak1600_pad(s);
 		s->o = -1;
 	}
 
-	/* output */
-	for(i = 0; i < len; i++)
+	while(len)
 	{
 		if(s->i == s->rate)
 		{
-			keccak1600_F(s);
+			keccak1600_F(s->s, s->r);
 			s->i = 0;
 		}
 
-		U8(out)[i] = s->s[s->i++];
+		n = s->rate - s->i;
+		if(n > len) n = len;
+
+		keccak1600_extract(s->s, s->i, in, out, n);
+		s->i += n;
+		if(in) in += n;
+		out += n;
+		len -= n;
 	}
 }
 
+void kripto_keccak1600_output
+(
+	struct kripto_keccak1600 *s,
+	void *out,
+	size_t len
+)
+{
+	keccak1600_squeeze(s, 0, out, len);
+}
+
+void kripto_keccak1600_output_xor
+(
+	struct kripto_keccak1600 *s,
+	const void *in,
+	void *out,
+	size_t len
+)
+{
+	keccak1600_squeeze(s, in, out, len);
+}
+
+static void keccak1600_crypt
+(
+	struct kripto_keccak1600 *s,
+	const uint8_t *in,
+	uint8_t *out,
+	size_t len,
+	int decrypt
+)
+{
+	size_t n;
+
+	while(len)
+	{
+		/* a fresh block of keystream */
+		if(s->o <= 0 || s->i == s->rate)
+		{
+			keccak1600_pad(s);
+			s->o = 1;
+		}
+
+		n = s->rate - s->i;
+		if(n > len) n = len;
+
+		keccak1600_duplex(s->s, s->i, in, out, n, decrypt);
+		s->i += n;
+		in += n;
+		out += n;
+		len -= n;
+	}
+}
+
+void kripto_keccak1600_encrypt
+(
+	struct kripto_keccak1600 *s,
+	const void *pt,
+	void *ct,
+	size_t len
+)
+{
+	keccak1600_crypt(s, pt, ct, len, 0);
+}
+
+void kripto_keccak1600_decrypt
+(
+	struct kripto_keccak1600 *s,
+	const void *ct,
+	void *pt,
+	size_t len
+)
+{
+	keccak1600_crypt(s, ct, pt, len, -1);
+}
+
+static kripto_hash *keccak1600_recreate
+(
+	kripto_hash *s,
+	unsigned int r,
+	size_t len
+)
+{
+	kripto_keccak1600_init(&s->k, r, 200 - (len << 1));
+
+	return s;
+}
+
+static void keccak1600_input
+(
+	kripto_hash *s,
+	const void *in,
+	size_t len
+)
+{
+	kripto_keccak1600_input(&s->k, in, len);
+}
+
+static void keccak1600_output(kripto_hash *s, void *out, size_t len)
+{
+	kripto_keccak1600_output(&s->k, out, len);
+}
+
 static kripto_hash *keccak1600_create(unsigned int r, size_t len)
 {
 	kripto_hash *s;
@@ -379,7 +598,43 @@ static kripto_hash *keccak1600_create(unsigned int r, size_t len)
 	return s;
 }
 
-static void keccak1600_destroy(kripto_hash *s) 
+static void keccak1600_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void keccak1600_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->k.r, p);
+	STORE32L(s->k.rate, p + 4);
+	STORE32L(s->k.i, p + 8);
+	p[12] = s->k.o != 0;
+	for(i = 0; i < 25; i++) STORE64L(s->k.s[i], p + 13 + (i << 3));
+}
+
+static int keccak1600_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	const uint32_t rate = LOAD32L(p + 4);
+	unsigned int i;
+
+	/* rc[] holds 48 rounds */
+	if(!LOAD32L(p) || LOAD32L(p) > 48) return -1;
+	if(!rate || rate > 200 || LOAD32L(p + 8) > rate) return -1;
+
+	s->k.r = LOAD32L(p);
+	s->k.rate = rate;
+	s->k.i = LOAD32L(p + 8);
+	s->k.o = p[12] ? -1 : 0;
+	for(i = 0; i < 25; i++) s->k.s[i] = LOAD64L(p + 13 + (i << 3));
+
+	return 0;
+}
+
+static void keccak1600_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
 	free(s);
@@ -405,16 +660,318 @@ static int keccak1600_hash
 	return 0;
 }
 
+#ifdef KRIPTO_X86_SIMD
+
+/*
+ * Multi-buffer kernels: Keccak-f[1600] on 4 or 8 states at once, one
+ * state per 64-bit lane. Lane j of state l is at [j * lanes + l].
+ */
+
+#define VKECCAK1600(A, B, C, D, XOR, XOR3, CHI, ROL, SET1)			\
+{																	\
+	for(i = 0; i < r; i++)											\
+	{																\
+		C[0] = XOR3(XOR3(A[0], A[5], A[10]), A[15], A[20]);			\
+		C[1] = XOR3(XOR3(A[1], A[6], A[11]), A[16], A[21]);			\
+		C[2] = XOR3(XOR3(A[2], A[7], A[12]), A[17], A[22]);			\
+		C[3] = XOR3(XOR3(A[3], A[8], A[13]), A[18], A[23]);			\
+		C[4] = XOR3(XOR3(A[4], A[9], A[14]), A[19], A[24]);			\
+																	\
+		D[0] = XOR(ROL(C[1], 1), C[4]);								\
+		D[1] = XOR(ROL(C[2], 1), C[0]);								\
+		D[2] = XOR(ROL(C[3], 1), C[1]);								\
+		D[3] = XOR(ROL(C[4], 1), C[2]);								\
+		D[4] = XOR(ROL(C[0], 1), C[3]);								\
+																	\
+		C[0] = XOR(A[0], D[0]);										\
+		C[1] = ROL(XOR(A[6], D[1]), 44);							\
+		C[2] = ROL(XOR(A[12], D[2]), 43);							\
+		C[3] = ROL(XOR(A[18], D[3]), 21);							\
+		C[4] = ROL(XOR(A[24], D[4]), 14);							\
+																	\
+		B[0] = XOR(CHI(C[0], C[1], C[2]), SET1((long long)rc[i]));	\
+		B[1] = CHI(C[1], C[2], C[3]);								\
+		B[2] = CHI(C[2], C[3], C[4]);								\
+		B[3] = CHI(C[3], C[4], C[0]);								\
+		B[4] = CHI(C[4], C[0], C[1]);								\
+																	\
+		C[0] = ROL(XOR(A[3], D[3]), 28);							\
+		C[1] = ROL(XOR(A[9], D[4]), 20);							\
+		C[2] = ROL(XOR(A[10], D[0]), 3);							\
+		C[3] = ROL(XOR(A[16], D[1]), 45);							\
+		C[4] = ROL(XOR(A[22], D[2]), 61);							\
+																	\
+		B[5] = CHI(C[0], C[1], C[2]);								\
+		B[6] = CHI(C[1], C[2], C[3]);								\
+		B[7] = CHI(C[2], C[3], C[4]);								\
+		B[8] = CHI(C[3], C[4], C[0]);								\
+		B[9] = CHI(C[4], C[0], C[1]);								\
+																	\
+		C[0] = ROL(XOR(A[1], D[1]), 1);								\
+		C[1] = ROL(XOR(A[7], D[2]), 6);								\
+		C[2] = ROL(XOR(A[13], D[3]), 25);							\
+		C[3] = ROL(XOR(A[19], D[4]), 8);							\
+		C[4] = ROL(XOR(A[20], D[0]), 18);							\
+																	\
+		B[10] = CHI(C[0], C[1], C[2]);								\
+		B[11] = CHI(C[1], C[2], C[3]);								\
+		B[12] = CHI(C[2], C[3], C[4]);								\
+		B[13] = CHI(C[3], C[4], C[0]);								\
+		B[14] = CHI(C[4], C[0], C[1]);								\
+																	\
+		C[0] = ROL(XOR(A[4], D[4]), 27);							\
+		C[1] = ROL(XOR(A[5], D[0]), 36);							\
+		C[2] = ROL(XOR(A[11], D[1]), 10);							\
+		C[3] = ROL(XOR(A[17], D[2]), 15);							\
+		C[4] = ROL(XOR(A[23], D[3]), 56);							\
+																	\
+		B[15] = CHI(C[0], C[1], C[2]);								\
+		B[16] = CHI(C[1], C[2], C[3]);								\
+		B[17] = CHI(C[2], C[3], C[4]);								\
+		B[18] = CHI(C[3], C[4], C[0]);								\
+		B[19] = CHI(C[4], C[0], C[1]);								\
+																	\
+		C[0] = ROL(XOR(A[2], D[2]), 62);							\
+		C[1] = ROL(XOR(A[8], D[3]), 55);							\
+		C[2] = ROL(XOR(A[14], D[4]), 39);							\
+		C[3] = ROL(XOR(A[15], D[0]), 41);							\
+		C[4] = ROL(XOR(A[21], D[1]), 2);							\
+																	\
+		B[20] = CHI(C[0], C[1], C[2]);								\
+		B[21] = CHI(C[1], C[2], C[3]);								\
+		B[22] = CHI(C[2], C[3], C[4]);								\
+		B[23] = CHI(C[3], C[4], C[0]);								\
+		B[24] = CHI(C[4], C[0], C[1]);								\
+																	\
+		A[0] = B[0];												\
+		A[1] = B[1];												\
+		A[2] = B[2];												\
+		A[3] = B[3];												\
+		A[4] = B[4];												\
+		A[5] = B[5];												\
+		A[6] = B[6];												\
+		A[7] = B[7];												\
+		A[8] = B[8];												\
+		A[9] = B[9];												\
+		A[10] = B[10];												\
+		A[11] = B[11];												\
+		A[12] = B[12];												\
+		A[13] = B[13];												\
+		A[14] = B[14];												\
+		A[15] = B[15];												\
+		A[16] = B[16];												\
+		A[17] = B[17];												\
+		A[18] = B[18];												\
+		A[19] = B[19];												\
+		A[20] = B[20];												\
+		A[21] = B[21];												\
+		A[22] = B[22];												\
+		A[23] = B[23];												\
+		A[24] = B[24];												\
+	}																\
+}
+
+#define AVX2_ROL(X, N) \
+	_mm256_or_si256(_mm256_slli_epi64(X, N), _mm256_srli_epi64(X, 64 - (N)))
+#define AVX2_XOR3(X, Y, Z) _mm256_xor_si256(_mm256_xor_si256(X, Y), Z)
+#define AVX2_CHI(X, Y, Z) _mm256_xor_si256(X, _mm256_andnot_si256(Y, Z))
+
+KRIPTO_TARGET("avx2")
+static void keccak1600_avx2(uint64_t *s, unsigned int r)
+{
+	__m256i a[25];
+	__m256i b[25];
+	__m256i c[5];
+	__m256i d[5];
+	unsigned int i;
+
+	for(i = 0; i < 25; i++) a[i] = LOADU256(s + (i << 2));
+
+	VKECCAK1600(a, b, c, d, _mm256_xor_si256, AVX2_XOR3, AVX2_CHI,
+		AVX2_ROL, _mm256_set1_epi64x);
+
+	for(i = 0; i < 25; i++) STOREU256(s + (i << 2), a[i]);
+}
+
+#define AVX512_XOR3(X, Y, Z) _mm512_ternarylogic_epi64(X, Y, Z, 0x96)
+#define AVX512_CHI(X, Y, Z) _mm512_ternarylogic_epi64(X, Y, Z, 0xD2)
+
+KRIPTO_TARGET("avx512f")
+static void keccak1600_avx512(uint64_t *s, unsigned int r)
+{
+	__m512i a[25];
+	__m512i b[25];
+	__m512i c[5];
+	__m512i d[5];
+	unsigned int i;
+
+	for(i = 0; i < 25; i++) a[i] = LOADU512(s + (i << 3));
+
+	VKECCAK1600(a, b, c, d, _mm512_xor_si512, AVX512_XOR3, AVX512_CHI,
+		_mm512_rol_epi64, _mm512_set1_epi64);
+
+	for(i = 0; i < 25; i++) STOREU512(s + (i << 3), a[i]);
+}
+
+/* the sponge, with the kernel picked for the lanes */
+struct sponge
+{
+	struct kripto_keccak1600 k;
+	void (*kernel)(uint64_t *, unsigned int);
+};
+
+static void lane_load
+(
+	struct kripto_lanes *x,
+	struct kripto_lane *l,
+	const void *in,
+	size_t len
+)
+{
+	const struct sponge *sp = x->arg;
+	const unsigned int rate = sp->k.rate;
+	/* as the sponge, a last full block is padded after its end */
+	const size_t tail = len ? len - (len - 1) / rate * rate : 0;
+
+	l->blocks = len ? (len - 1) / rate + 1 : 1;
+	l->in = in;
+
+	memset(l->pad, 0, 200);
+	if(tail) memcpy(l->pad, CU8(in) + len - tail, tail);
+
+	if(tail < 200) l->pad[tail] ^= 0x01;
+	l->pad[rate - 1] ^= 0x80;
+}
+
+/* XORs the next block into lane j * lanes of a */
+static void lane_next
+(
+	struct kripto_lane *l,
+	uint64_t *a,
+	unsigned int lanes,
+	unsigned int rate
+)
+{
+	const uint8_t *p = l->in;
+	unsigned int j;
+
+	if(!--l->blocks)
+	{
+		/* may reach past the rate */
+		p = l->pad;
+		rate = 200;
+	}
+	else l->in += rate;
+
+	for(j = 0; j + 8 <= rate; j += 8) a[(j >> 3) * lanes] ^= LOAD64L(p + j);
+
+	for(; j < rate; j++)
+		a[(j >> 3) * lanes] ^= (uint64_t)p[j] << ((j & 7) << 3);
+}
+
+static void lane_vector(struct kripto_lanes *x)
+{
+	const struct sponge *sp = x->arg;
+	unsigned int l;
+
+	for(l = 0; l < x->lanes; l++)
+	{
+		if(x->lane[l].blocks)
+			lane_next(x->lane + l, U64(x->h) + l, x->lanes, sp->k.rate);
+	}
+
+	sp->kernel(x->h, sp->k.r);
+}
+
+static void lane_serial(struct kripto_lanes *x, struct kripto_lane *l)
+{
+	struct sponge *sp = x->arg;
+
+	while(l->blocks)
+	{
+		lane_next(l, sp->k.s, 1, sp->k.rate);
+		keccak1600_F(sp->k.s, sp->k.r);
+	}
+}
+
+static int keccak1600_many
+(
+	unsigned int r,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+)
+{
+	struct kripto_lanes x;
+	struct sponge sp;
+	uint64_t a[200];
+	const unsigned int cpu = kripto_cpu();
+	size_t i;
+
+	/* the output is taken from a single block, out_len <= rate */
+	if(out_len * 3 <= 200 && n > 4 && (cpu & KRIPTO_CPU_AVX512))
+	{
+		sp.kernel = &keccak1600_avx512;
+		x.lanes = 8;
+	}
+	else if(out_len * 3 <= 200 && n > 2 && (cpu & KRIPTO_CPU_AVX2))
+	{
+		sp.kernel = &keccak1600_avx2;
+		x.lanes = 4;
+	}
+	else
+	{
+		for(i = 0; i < n; i++)
+			(void)keccak1600_hash(r, in[i], in_len[i], out[i], out_len);
+
+		return 0;
+	}
+
+	/* rounds and rate, every lane starts from the zero state */
+	kripto_keccak1600_init(&sp.k, r, 200 - (out_len << 1));
+
+	x.words = 25;
+	x.word_size = 8;
+	x.big_endian = 0;
+	x.h = a;
+	x.s = sp.k.s;
+	x.arg = &sp;
+	x.load = &lane_load;
+	x.vector = &lane_vector;
+	x.serial = &lane_serial;
+
+	kripto_lanes_run(&x, in, in_len, out, n, out_len);
+
+	kripto_memwipe(&x, sizeof(x));
+	kripto_memwipe(&sp, sizeof(sp));
+	kripto_memwipe(a, sizeof(a));
+
+	return 0;
+}
+
+#endif
+
 static const kripto_hash_desc keccak1600 =
 {
 	&keccak1600_create,
 	&keccak1600_recreate,
 	&keccak1600_input,
 	&keccak1600_output,
+	&keccak1600_copy,
+	&keccak1600_export,
+	&keccak1600_import,
 	&keccak1600_destroy,
 	&keccak1600_hash,
+	#ifdef KRIPTO_X86_SIMD
+	&keccak1600_many,
+	#else
+	0, /* hash_many */
+	#endif
 	SIZE_MAX, /* max output */
-	200 /* block_size */
+	200, /* block_size */
+	213 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_keccak1600 = &keccak1600;
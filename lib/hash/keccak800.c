@@ -25,16 +25,13 @@
 #include <kripto/desc/hash.h>
 #include <kripto/object/hash.h>
 
+#include <kripto/keccak.h>
 #include <kripto/hash/keccak800.h>
 
 struct kripto_hash
 {
 	struct kripto_hash_object obj;
-	unsigned int r;
-	unsigned int rate;
-	unsigned int i;
-	int o;
-	uint8_t s[100];
+	struct kripto_keccak800 k;
 };
 
 static const uint32_t rc[40] = 
@@ -51,33 +48,33 @@ static const uint32_t rc[40] =
 	0x00000080, 0x80008000, 0x00008001, 0x00000009
 };
 
-static void keccak800_F(kripto_hash *s)
+static void keccak800_F(uint32_t *s, unsigned int r)
 {
-	uint32_t a0 = LOAD32L(s->s);
-	uint32_t a1 = LOAD32L(s->s + 4);
-	uint32_t a2 = LOAD32L(s->s + 8);
-	uint32_t a3 = LOAD32L(s->s + 12);
-	uint32_t a4 = LOAD32L(s->s + 16);
-	uint32_t a5 = LOAD32L(s->s + 20);
-	uint32_t a6 = LOAD32L(s->s + 24);
-	uint32_t a7 = LOAD32L(s->s + 28);
-	uint32_t a8 = LOAD32L(s->s + 32);
-	uint32_t a9 = LOAD32L(s->s + 36);
-	uint32_t a10 = LOAD32L(s->s + 40);
-	uint32_t a11 = LOAD32L(s->s + 44);
-	uint32_t a12 = LOAD32L(s->s + 48);
-	uint32_t a13 = LOAD32L(s->s + 52);
-	uint32_t a14 = LOAD32L(s->s + 56);
-	uint32_t a15 = LOAD32L(s->s + 60);
-	uint32_t a16 = LOAD32L(s->s + 64);
-	uint32_t a17 = LOAD32L(s->s + 68);
-	uint32_t a18 = LOAD32L(s->s + 72);
-	uint32_t a19 = LOAD32L(s->s + 76);
-	uint32_t a20 = LOAD32L(s->s + 80);
-	uint32_t a21 = LOAD32L(s->s + 84);
-	uint32_t a22 = LOAD32L(s->s + 88);
-	uint32_t a23 = LOAD32L(s->s + 92);
-	uint32_t a24 = LOAD32L(s->s + 96);
+	uint32_t a0 = s[0];
+	uint32_t a1 = s[1];
+	uint32_t a2 = s[2];
+	uint32_t a3 = s[3];
+	uint32_t a4 = s[4];
+	uint32_t a5 = s[5];
+	uint32_t a6 = s[6];
+	uint32_t a7 = s[7];
+	uint32_t a8 = s[8];
+	uint32_t a9 = s[9];
+	uint32_t a10 = s[10];
+	uint32_t a11 = s[11];
+	uint32_t a12 = s[12];
+	uint32_t a13 = s[13];
+	uint32_t a14 = s[14];
+	uint32_t a15 = s[15];
+	uint32_t a16 = s[16];
+	uint32_t a17 = s[17];
+	uint32_t a18 = s[18];
+	uint32_t a19 = s[19];
+	uint32_t a20 = s[20];
+	uint32_t a21 = s[21];
+	uint32_t a22 = s[22];
+	uint32_t a23 = s[23];
+	uint32_t a24 = s[24];
 
 	uint32_t b0;
 	uint32_t b1;
@@ -119,7 +116,7 @@ static void keccak800_F(kripto_hash *s)
 
 	unsigned int i;
 
-	for(i = 0; i < s->r; i++)
+	for(i = 0; i < r; i++)
 	{
 		c0 = a0 ^ a5 ^ a10 ^ a15 ^ a20;
 		c1 = a1 ^ a6 ^ a11 ^ a16 ^ a21;
@@ -245,38 +242,151 @@ static void keccak800_F(kripto_hash *s)
 		a24 = b24;
 	}
 
-	STORE32L(a0, s->s);
-	STORE32L(a1, s->s + 4);
-	STORE32L(a2, s->s + 8);
-	STORE32L(a3, s->s + 12);
-	STORE32L(a4, s->s + 16);
-	STORE32L(a5, s->s + 20);
-	STORE32L(a6, s->s + 24);
-	STORE32L(a7, s->s + 28);
-	STORE32L(a8, s->s + 32);
-	STORE32L(a9, s->s + 36);
-	STORE32L(a10, s->s + 40);
-	STORE32L(a11, s->s + 44);
-	STORE32L(a12, s->s + 48);
-	STORE32L(a13, s->s + 52);
-	STORE32L(a14, s->s + 56);
-	STORE32L(a15, s->s + 60);
-	STORE32L(a16, s->s + 64);
-	STORE32L(a17, s->s + 68);
-	STORE32L(a18, s->s + 72);
-	STORE32L(a19, s->s + 76);
-	STORE32L(a20, s->s + 80);
-	STORE32L(a21, s->s + 84);
-	STORE32L(a22, s->s + 88);
-	STORE32L(a23, s->s + 92);
-	STORE32L(a24, s->s + 96);
+	s[0] = a0;
+	s[1] = a1;
+	s[2] = a2;
+	s[3] = a3;
+	s[4] = a4;
+	s[5] = a5;
+	s[6] = a6;
+	s[7] = a7;
+	s[8] = a8;
+	s[9] = a9;
+	s[10] = a10;
+	s[11] = a11;
+	s[12] = a12;
+	s[13] = a13;
+	s[14] = a14;
+	s[15] = a15;
+	s[16] = a16;
+	s[17] = a17;
+	s[18] = a18;
+	s[19] = a19;
+	s[20] = a20;
+	s[21] = a21;
+	s[22] = a22;
+	s[23] = a23;
+	s[24] = a24;
 }
 
-static kripto_hash *keccak800_recreate
+/* XORs in into the state bytes i...i + n - 1 */
+static void keccak800_xor
 (
-	kripto_hash *s,
+	uint32_t *s,
+	unsigned int i,
+	const uint8_t *in,
+	size_t n
+)
+{
+	size_t j = 0;
+
+	for(; j < n && (i & 3); j++, i++)
+		s[i >> 2] ^= (uint32_t)in[j] << ((i & 3) << 3);
+
+	for(; j + 4 <= n; j += 4, i += 4)
+		s[i >> 2] ^= LOAD32L(in + j);
+
+	for(; j < n; j++, i++)
+		s[i >> 2] ^= (uint32_t)in[j] << ((i & 3) << 3);
+}
+
+/* out = in ^ state bytes i...i + n - 1, or just the state if !in */
+static void keccak800_extract
+(
+	const uint32_t *s,
+	unsigned int i,
+	const uint8_t *in,
+	uint8_t *out,
+	size_t n
+)
+{
+	size_t j = 0;
+
+	if(!in)
+	{
+		for(; j < n && (i & 3); j++, i++)
+			out[j] = s[i >> 2] >> ((i & 3) << 3);
+
+		for(; j + 4 <= n; j += 4, i += 4)
+			STORE32L(s[i >> 2], out + j);
+
+		for(; j < n; j++, i++)
+			out[j] = s[i >> 2] >> ((i & 3) << 3);
+	}
+	else
+	{
+		for(; j < n && (i & 3); j++, i++)
+			out[j] = in[j] ^ (uint8_t)(s[i >> 2] >> ((i & 3) << 3));
+
+		for(; j + 4 <= n; j += 4, i += 4)
+			STORE32L(LOAD32L(in + j) ^ s[i >> 2], out + j);
+
+		for(; j < n; j++, i++)
+			out[j] = in[j] ^ (uint8_t)(s[i >> 2] >> ((i & 3) << 3));
+	}
+}
+
+/*
+ * out = in ^ state bytes i...i + n - 1, which then become the
+ * ciphertext: out when encrypting, in when decrypting
+ */
+static void keccak800_duplex
+(
+	uint32_t *s,
+	unsigned int i,
+	const uint8_t *in,
+	uint8_t *out,
+	size_t n,
+	int decrypt
+)
+{
+	size_t j = 0;
+	uint32_t t;
+	uint8_t k;
+
+	for(; j < n && (i & 3); j++, i++)
+	{
+		k = s[i >> 2] >> ((i & 3) << 3);
+		t = decrypt ? in[j] : in[j] ^ k;
+		out[j] = in[j] ^ k;
+		s[i >> 2] ^= (t ^ k) << ((i & 3) << 3);
+	}
+
+	for(; j + 4 <= n; j += 4, i += 4)
+	{
+		t = LOAD32L(in + j);
+		STORE32L(t ^ s[i >> 2], out + j);
+		s[i >> 2] = decrypt ? t : t ^ s[i >> 2];
+	}
+
+	for(; j < n; j++, i++)
+	{
+		k = s[i >> 2] >> ((i & 3) << 3);
+		t = decrypt ? in[j] : in[j] ^ k;
+		out[j] = in[j] ^ k;
+		s[i >> 2] ^= (t ^ k) << ((i & 3) << 3);
+	}
+}
+
+/* pads at byte i (none there if i is past the state) and permutes */
+static void keccak800_pad(struct kripto_keccak800 *s)
+{
+	if(s->i < sizeof(s->s))
+		s->s[s->i >> 2] ^= (uint32_t)0x01 << ((s->i & 3) << 3);
+
+	s->s[(s->rate - 1) >> 2] ^=
+		(uint32_t)0x80 << (((s->rate - 1) & 3) << 3);
+
+	keccak800_F(s->s, s->r);
+
+	s->i = 0;
+}
+
+void kripto_keccak800_init
+(
+	struct kripto_keccak800 *s,
 	unsigned int r,
-	size_t len
+	unsigned int rate
 )
 {
 	s->o = s->i = 0;
@@ -284,68 +394,179 @@ static kripto_hash *keccak800_recreate
 	s->r = r;
 	if(!s->r) s->r = 20;
 
-	s->rate = 100 - (len << 1);
-
-	memset(s->s, 0, 200);
+	s->rate = rate;
 
-	return s;
+	memset(s->s, 0, sizeof(s->s));
 }
 
-static void keccak800_input
+void kripto_keccak800_input
 (
-	kripto_hash *s,
+	struct kripto_keccak800 *s,
 	const void *in,
 	size_t len
-) 
+)
 {
-	size_t i;
+	size_t n;
 
-	/* switch back to input mode */
-	if(s->o) s->o = s->i = 0;
+	/* switch back to input mode, after a duplex in the same block */
+	if(s->o > 0) s->o = 0;
+	else if(s->o) s->o = s->i = 0;
 
-	/* input */
-	for(i = 0; i < len; i++)
+	while(len)
 	{
 		if(s->i == s->rate)
 		{
-			keccak800_F(s);
+			keccak800_F(s->s, s->r);
 			s->i = 0;
 		}
 
-		s->s[s->i++] ^= CU8(in)[i];
+		n = s->rate - s->i;
+		if(n > len) n = len;
+
+		keccak800_xor(s->s, s->i, in, n);
+		s->i += n;
+		in = CU8(in) + n;
+		len -= n;
 	}
 }
 
-static void keccak800_output(kripto_hash *s, void *out, size_t len)
+static void keccak800_squeeze
+(
+	struct kripto_keccak800 *s,
+	const uint8_t *in,
+	uint8_t *out,
+	size_t len
+)
 {
-	size_t i;
+	size_t n;
 
 	/* switch to output mode */
-	if(!s->o)
+	if(s->o >= 0)
 	{
-		/* pad */
-		s->s[s->i] ^= 0x01;
-		s->s[s->rate - 1] ^= 0x80;
-
-		keccak800_F(s);
-
-		s->i = 0;
+		keccak800_pad(s);
 		s->o = -1;
 	}
 
-	/* output */
-	for(i = 0; i < len; i++)
+	while(len)
 	{
 		if(s->i == s->rate)
 		{
-			keccak800_F(s);
+			keccak800_F(s->s, s->r);
 			s->i = 0;
 		}
 
-		U8(out)[i] = s->s[s->i++];
+		n = s->rate - s->i;
+		if(n > len) n = len;
+
+		keccak800_extract(s->s, s->i, in, out, n);
+		s->i += n;
+		if(in) in += n;
+		out += n;
+		len -= n;
+	}
+}
+
+void kripto_keccak800_output
+(
+	struct kripto_keccak800 *s,
+	void *out,
+	size_t len
+)
+{
+	keccak800_squeeze(s, 0, out, len);
+}
+
+void kripto_keccak800_output_xor
+(
+	struct kripto_keccak800 *s,
+	const void *in,
+	void *out,
+	size_t len
+)
+{
+	keccak800_squeeze(s, in, out, len);
+}
+
+static void keccak800_crypt
+(
+	struct kripto_keccak800 *s,
+	const uint8_t *in,
+	uint8_t *out,
+	size_t len,
+	int decrypt
+)
+{
+	size_t n;
+
+	while(len)
+	{
+		/* a fresh block of keystream */
+		if(s->o <= 0 || s->i == s->rate)
+		{
+			keccak800_pad(s);
+			s->o = 1;
+		}
+
+		n = s->rate - s->i;
+		if(n > len) n = len;
+
+		keccak800_duplex(s->s, s->i, in, out, n, decrypt);
+		s->i += n;
+		in += n;
+		out += n;
+		len -= n;
 	}
 }
 
+void kripto_keccak800_encrypt
+(
+	struct kripto_keccak800 *s,
+	const void *pt,
+	void *ct,
+	size_t len
+)
+{
+	keccak800_crypt(s, pt, ct, len, 0);
+}
+
+void kripto_keccak800_decrypt
+(
+	struct kripto_keccak800 *s,
+	const void *ct,
+	void *pt,
+	size_t len
+)
+{
+	keccak800_crypt(s, ct, pt, len, -1);
+}
+
+static kripto_hash *keccak800_recreate
+(
+	kripto_hash *s,
+	unsigned int r,
+	size_t len
+)
+{
+	kripto_keccak800_init(&s->k, r, 100 - (len << 1));
+
+	return s;
+}
+
+static void keccak800_input
+(
+	kripto_hash *s,
+	const void *in,
+	size_t len
+)
+{
+	kripto_keccak800_input(&s->k, in, len);
+}
+
+static void keccak800_output(kripto_hash *s, void *out, size_t len)
+{
+	kripto_keccak800_output(&s->k, out, len);
+}
+
 static kripto_hash *keccak800_create(unsigned int r, size_t len)
 {
 	kripto_hash *s;
@@ -360,7 +581,43 @@ static kripto_hash *keccak800_create(unsigned int r, size_t len)
 	return s;
 }
 
-static void keccak800_destroy(kripto_hash *s) 
+static void keccak800_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void keccak800_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->k.r, p);
+	STORE32L(s->k.rate, p + 4);
+	STORE32L(s->k.i, p + 8);
+	p[12] = s->k.o != 0;
+	for(i = 0; i < 25; i++) STORE32L(s->k.s[i], p + 13 + (i << 2));
+}
+
+static int keccak800_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	const uint32_t rate = LOAD32L(p + 4);
+	unsigned int i;
+
+	/* rc[] holds 40 rounds */
+	if(!LOAD32L(p) || LOAD32L(p) > 40) return -1;
+	if(!rate || rate > 100 || LOAD32L(p + 8) > rate) return -1;
+
+	s->k.r = LOAD32L(p);
+	s->k.rate = rate;
+	s->k.i = LOAD32L(p + 8);
+	s->k.o = p[12] ? -1 : 0;
+	for(i = 0; i < 25; i++) s->k.s[i] = LOAD32L(p + 13 + (i << 2));
+
+	return 0;
+}
+
+static void keccak800_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
 	free(s);
@@ -392,10 +649,15 @@ static const kripto_hash_desc keccak800 =
 	&keccak800_recreate,
 	&keccak800_input,
 	&keccak800_output,
+	&keccak800_copy,
+	&keccak800_export,
+	&keccak800_import,
 	&keccak800_destroy,
 	&keccak800_hash,
+	0, /* hash_many */
 	SIZE_MAX, /* max output */
-	100 /* block_size */
+	100, /* block_size */
+	113 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_keccak800 = &keccak800;
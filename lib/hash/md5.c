@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
 
@@ -21,6 +22,9 @@
 #include <kripto/loadstore.h>
 #include <kripto/rotate.h>
 #include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
+#include <kripto/lanes.h>
 #include <kripto/hash.h>
 #include <kripto/desc/hash.h>
 #include <kripto/object/hash.h>
@@ -182,20 +186,46 @@ static void md5_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
 	s->len += len << 3;
 	assert(s->len >= len << 3);
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		s->buf[s->i++] = CU8(in)[i];
+		if(s->i)
+		{
+			/* fill the buffer */
+			n = 64 - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
+
+			if(s->i < 64) return;
 
-		if(s->i == 64)
+			block = s->buf;
+		}
+		else if(len >= 64)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 64;
+			len -= 64;
+		}
+		else
 		{
-			md5_process(s, s->buf);
-			s->i = 0;
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
 		}
+
+		md5_process(s, block);
+		s->i = 0;
 	}
 }
 
@@ -245,6 +275,39 @@ static kripto_hash *md5_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void md5_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void md5_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE64L(s->len, p);
+	for(i = 0; i < 4; i++) STORE32L(s->h[i], p + 8 + (i << 2));
+	memcpy(p + 24, s->buf, 64);
+	STORE32L(s->i, p + 88);
+	p[92] = s->f != 0;
+}
+
+static int md5_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	unsigned int i;
+
+	if(LOAD32L(p + 88) > (p[92] ? 16 : 63)) return -1;
+
+	s->len = LOAD64L(p);
+	for(i = 0; i < 4; i++) s->h[i] = LOAD32L(p + 8 + (i << 2));
+	memcpy(s->buf, p + 24, 64);
+	s->i = LOAD32L(p + 88);
+	s->f = p[92] ? -1 : 0;
+
+	return 0;
+}
+
 static void md5_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
@@ -271,16 +334,316 @@ static int md5_hash
 	return 0;
 }
 
+#ifdef KRIPTO_X86_SIMD
+
+/*
+ * Multi-buffer kernels: one block of 4, 8 or 16 messages at once,
+ * one message per 32-bit lane. Word i of lane l (of the state h and
+ * of the message w) is at [i * lanes + l].
+ */
+
+#define VMD5_STEP(A, B, C, D, F, I, M, S, N, LOAD, SET1, ADD, ROL)	\
+{																	\
+	A = ADD(B, ROL(ADD(ADD(A, F(B, C, D)),							\
+		ADD(SET1((int)k[I]), LOAD(w + (M) * N))), S));				\
+}
+
+#define VMD5(V, N, LOAD, SET1, ADD, ROL, F0, F1, F2, F3)			\
+{																	\
+	for(i = 0; i < 16; i += 4)										\
+	{																\
+		VMD5_STEP(V[0], V[1], V[2], V[3], F0, i, i,					\
+			7, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[3], V[0], V[1], V[2], F0, i + 1, i + 1,			\
+			12, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[2], V[3], V[0], V[1], F0, i + 2, i + 2,			\
+			17, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[1], V[2], V[3], V[0], F0, i + 3, i + 3,			\
+			22, N, LOAD, SET1, ADD, ROL);							\
+	}																\
+																	\
+	for(; i < 32; i += 4)											\
+	{																\
+		VMD5_STEP(V[0], V[1], V[2], V[3], F1, i, (i * 5 + 1) & 15,	\
+			5, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[3], V[0], V[1], V[2], F1, i + 1, (i * 5 + 6) & 15, \
+			9, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[2], V[3], V[0], V[1], F1, i + 2, (i * 5 + 11) & 15, \
+			14, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[1], V[2], V[3], V[0], F1, i + 3, (i * 5 + 16) & 15, \
+			20, N, LOAD, SET1, ADD, ROL);							\
+	}																\
+																	\
+	for(; i < 48; i += 4)											\
+	{																\
+		VMD5_STEP(V[0], V[1], V[2], V[3], F2, i, (i * 3 + 5) & 15,	\
+			4, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[3], V[0], V[1], V[2], F2, i + 1, (i * 3 + 8) & 15, \
+			11, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[2], V[3], V[0], V[1], F2, i + 2, (i * 3 + 11) & 15, \
+			16, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[1], V[2], V[3], V[0], F2, i + 3, (i * 3 + 14) & 15, \
+			23, N, LOAD, SET1, ADD, ROL);							\
+	}																\
+																	\
+	for(; i < 64; i += 4)											\
+	{																\
+		VMD5_STEP(V[0], V[1], V[2], V[3], F3, i, (i * 7) & 15,		\
+			6, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[3], V[0], V[1], V[2], F3, i + 1, (i * 7 + 7) & 15, \
+			10, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[2], V[3], V[0], V[1], F3, i + 2, (i * 7 + 14) & 15, \
+			15, N, LOAD, SET1, ADD, ROL);							\
+		VMD5_STEP(V[1], V[2], V[3], V[0], F3, i + 3, (i * 7 + 21) & 15, \
+			21, N, LOAD, SET1, ADD, ROL);							\
+	}																\
+}
+
+#define SSE2_ROL(X, N)												\
+	_mm_or_si128(_mm_slli_epi32(X, N), _mm_srli_epi32(X, 32 - (N)))
+#define SSE2_XOR3(X, Y, Z) _mm_xor_si128(_mm_xor_si128(X, Y), Z)
+#define SSE2_CH(X, Y, Z)											\
+	_mm_xor_si128(Z, _mm_and_si128(X, _mm_xor_si128(Y, Z)))
+#define SSE2_F0(X, Y, Z) SSE2_CH(X, Y, Z)
+#define SSE2_F1(X, Y, Z) SSE2_CH(Z, X, Y)
+#define SSE2_F3(X, Y, Z) _mm_xor_si128(Y,							\
+	_mm_or_si128(X, _mm_xor_si128(Z, _mm_set1_epi32(-1))))
+
+KRIPTO_TARGET("sse2")
+static void md5_sse2
+(
+	void *state,
+	const uint8_t *const *in,
+	void *scratch,
+	unsigned int r
+)
+{
+	uint32_t *h = state;
+	uint32_t *w = scratch;
+	__m128i v[4];
+	__m128i m[4];
+	__m128i t[4];
+	unsigned int i;
+
+	(void)r;
+
+	for(i = 0; i < 16; i += 4)
+	{
+		m[0] = LOADU(in[0] + (i << 2));
+		m[1] = LOADU(in[1] + (i << 2));
+		m[2] = LOADU(in[2] + (i << 2));
+		m[3] = LOADU(in[3] + (i << 2));
+
+		TRANSPOSE4(m[0], m[1], m[2], m[3], t,
+			_mm_unpacklo_epi32, _mm_unpackhi_epi32,
+			_mm_unpacklo_epi64, _mm_unpackhi_epi64);
+
+		STOREU(w + (i << 2), m[0]);
+		STOREU(w + (i << 2) + 4, m[1]);
+		STOREU(w + (i << 2) + 8, m[2]);
+		STOREU(w + (i << 2) + 12, m[3]);
+	}
+
+	for(i = 0; i < 4; i++) v[i] = LOADU(h + (i << 2));
+
+	VMD5(v, 4, LOADU, _mm_set1_epi32, _mm_add_epi32, SSE2_ROL,
+		SSE2_F0, SSE2_F1, SSE2_XOR3, SSE2_F3);
+
+	for(i = 0; i < 4; i++)
+		STOREU(h + (i << 2), _mm_add_epi32(v[i], LOADU(h + (i << 2))));
+}
+
+#define AVX2_ROL(X, N)												\
+	_mm256_or_si256(_mm256_slli_epi32(X, N), _mm256_srli_epi32(X, 32 - (N)))
+#define AVX2_XOR3(X, Y, Z) _mm256_xor_si256(_mm256_xor_si256(X, Y), Z)
+#define AVX2_CH(X, Y, Z)											\
+	_mm256_xor_si256(Z, _mm256_and_si256(X, _mm256_xor_si256(Y, Z)))
+#define AVX2_F0(X, Y, Z) AVX2_CH(X, Y, Z)
+#define AVX2_F1(X, Y, Z) AVX2_CH(Z, X, Y)
+#define AVX2_F3(X, Y, Z) _mm256_xor_si256(Y,						\
+	_mm256_or_si256(X, _mm256_xor_si256(Z, _mm256_set1_epi32(-1))))
+
+/* 16 bytes of lanes A and B */
+#define AVX2_LOAD2(A, B)											\
+	_mm256_inserti128_si256(_mm256_castsi128_si256(LOADU(A)), LOADU(B), 1)
+
+KRIPTO_TARGET("avx2")
+static void md5_avx2
+(
+	void *state,
+	const uint8_t *const *in,
+	void *scratch,
+	unsigned int r
+)
+{
+	uint32_t *h = state;
+	uint32_t *w = scratch;
+	__m256i v[4];
+	__m256i m[4];
+	__m256i t[4];
+	unsigned int i;
+
+	(void)r;
+
+	for(i = 0; i < 16; i += 4)
+	{
+		m[0] = AVX2_LOAD2(in[0] + (i << 2), in[4] + (i << 2));
+		m[1] = AVX2_LOAD2(in[1] + (i << 2), in[5] + (i << 2));
+		m[2] = AVX2_LOAD2(in[2] + (i << 2), in[6] + (i << 2));
+		m[3] = AVX2_LOAD2(in[3] + (i << 2), in[7] + (i << 2));
+
+		TRANSPOSE4(m[0], m[1], m[2], m[3], t,
+			_mm256_unpacklo_epi32, _mm256_unpackhi_epi32,
+			_mm256_unpacklo_epi64, _mm256_unpackhi_epi64);
+
+		STOREU256(w + (i << 3), m[0]);
+		STOREU256(w + (i << 3) + 8, m[1]);
+		STOREU256(w + (i << 3) + 16, m[2]);
+		STOREU256(w + (i << 3) + 24, m[3]);
+	}
+
+	for(i = 0; i < 4; i++) v[i] = LOADU256(h + (i << 3));
+
+	VMD5(v, 8, LOADU256, _mm256_set1_epi32, _mm256_add_epi32, AVX2_ROL,
+		AVX2_F0, AVX2_F1, AVX2_XOR3, AVX2_F3);
+
+	for(i = 0; i < 4; i++)
+	{
+		STOREU256(h + (i << 3),
+			_mm256_add_epi32(v[i], LOADU256(h + (i << 3))));
+	}
+}
+
+#define AVX512_XOR3(X, Y, Z) _mm512_ternarylogic_epi32(X, Y, Z, 0x96)
+#define AVX512_F0(X, Y, Z) _mm512_ternarylogic_epi32(X, Y, Z, 0xCA)
+#define AVX512_F1(X, Y, Z) _mm512_ternarylogic_epi32(Z, X, Y, 0xCA)
+#define AVX512_F3(X, Y, Z) _mm512_ternarylogic_epi32(X, Y, Z, 0x39)
+
+/* 16 bytes of lanes A, B, C and D */
+#define AVX512_LOAD4(A, B, C, D)									\
+	_mm512_inserti32x4(_mm512_inserti32x4(_mm512_inserti32x4(		\
+	_mm512_castsi128_si512(LOADU(A)), LOADU(B), 1), LOADU(C), 2),	\
+	LOADU(D), 3)
+
+KRIPTO_TARGET("avx512f")
+static void md5_avx512
+(
+	void *state,
+	const uint8_t *const *in,
+	void *scratch,
+	unsigned int r
+)
+{
+	uint32_t *h = state;
+	uint32_t *w = scratch;
+	__m512i v[4];
+	__m512i m[4];
+	__m512i t[4];
+	unsigned int i;
+	unsigned int j;
+
+	(void)r;
+
+	for(i = 0; i < 16; i += 4)
+	{
+		for(j = 0; j < 4; j++)
+		{
+			m[j] = AVX512_LOAD4(in[j] + (i << 2), in[j + 4] + (i << 2),
+				in[j + 8] + (i << 2), in[j + 12] + (i << 2));
+		}
+
+		TRANSPOSE4(m[0], m[1], m[2], m[3], t,
+			_mm512_unpacklo_epi32, _mm512_unpackhi_epi32,
+			_mm512_unpacklo_epi64, _mm512_unpackhi_epi64);
+
+		for(j = 0; j < 4; j++) STOREU512(w + ((i + j) << 4), m[j]);
+	}
+
+	for(i = 0; i < 4; i++) v[i] = LOADU512(h + (i << 4));
+
+	VMD5(v, 16, LOADU512, _mm512_set1_epi32, _mm512_add_epi32,
+		_mm512_rol_epi32, AVX512_F0, AVX512_F1, AVX512_XOR3, AVX512_F3);
+
+	for(i = 0; i < 4; i++)
+	{
+		STOREU512(h + (i << 4),
+			_mm512_add_epi32(v[i], LOADU512(h + (i << 4))));
+	}
+}
+
+static const struct kripto_lanes_md md5_lanes =
+{
+	64, /* block */
+	0, /* little endian */
+	4, /* state words */
+	4, /* word size */
+	&md5_process,
+	{
+		{16, KRIPTO_CPU_AVX512, &md5_avx512},
+		{8, KRIPTO_CPU_AVX2, &md5_avx2},
+		{4, KRIPTO_CPU_SSE2, &md5_sse2},
+		{0, 0, 0}
+	}
+};
+
+static int md5_many
+(
+	unsigned int r,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+)
+{
+	kripto_hash s;
+	size_t i;
+
+	/* initial state */
+	(void)md5_recreate(&s, r, out_len);
+
+	if(kripto_lanes_md(
+		&md5_lanes,
+		&s,
+		s.h,
+		0,
+		in,
+		in_len,
+		out,
+		n,
+		out_len)
+	)
+	{
+		for(i = 0; i < n; i++)
+			(void)md5_hash(r, in[i], in_len[i], out[i], out_len);
+	}
+
+	kripto_memwipe(&s, sizeof(kripto_hash));
+
+	return 0;
+}
+
+#endif
+
 static const kripto_hash_desc md5 =
 {
 	&md5_create,
 	&md5_recreate,
 	&md5_input,
 	&md5_output,
+	&md5_copy,
+	&md5_export,
+	&md5_import,
 	&md5_destroy,
 	&md5_hash,
+	#ifdef KRIPTO_X86_SIMD
+	&md5_many,
+	#else
+	0, /* hash_many */
+	#endif
 	16, /* max output */
-	64 /* block_size */
+	64, /* block_size */
+	93 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_md5 = &md5;
@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
 
@@ -21,6 +22,9 @@
 #include <kripto/loadstore.h>
 #include <kripto/rotate.h>
 #include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
+#include <kripto/lanes.h>
 #include <kripto/hash.h>
 #include <kripto/desc/hash.h>
 #include <kripto/object/hash.h>
@@ -123,6 +127,100 @@ static kripto_hash *sha2_256_recreate
 	return s;
 }
 
+#ifdef KRIPTO_X86_SIMD
+
+#define SHANI_CPU (KRIPTO_CPU_SHA | KRIPTO_CPU_SSSE3 | KRIPTO_CPU_SSE41)
+
+/*
+ * Rounds 4Q...4Q + 3, message words of quad Q are in m[Q & 3].
+ * Meanwhile quad Q + 1 is finished and quad Q + 3 started.
+ */
+#define SHANI_QUAD(Q)												\
+{																	\
+	if(Q < 4)														\
+	{																\
+		m[Q & 3] = _mm_shuffle_epi8(LOADU(in + ((Q & 3) << 4)),		\
+			bswap);													\
+	}																\
+																	\
+	x = _mm_add_epi32(m[Q & 3], LOADU(k + (Q << 2)));				\
+	s1 = _mm_sha256rnds2_epu32(s1, s0, x);							\
+																	\
+	if(Q >= 3 && Q <= 14)											\
+	{																\
+		m[(Q + 1) & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(		\
+			m[(Q + 1) & 3], _mm_alignr_epi8(m[Q & 3],				\
+			m[(Q + 3) & 3], 4)), m[Q & 3]);							\
+	}																\
+																	\
+	x = _mm_shuffle_epi32(x, 0x0E);									\
+	s0 = _mm_sha256rnds2_epu32(s0, s1, x);							\
+																	\
+	if(Q >= 1 && Q <= 12)											\
+	{																\
+		m[(Q + 3) & 3] = _mm_sha256msg1_epu32(m[(Q + 3) & 3],		\
+			m[Q & 3]);												\
+	}																\
+}
+
+/* SHA extensions, default rounds only */
+KRIPTO_TARGET("sha,sse4.1")
+static void sha2_256_shani(uint32_t *h, const uint8_t *in, size_t blocks)
+{
+	__m128i s0;
+	__m128i s1;
+	__m128i t0;
+	__m128i t1;
+	__m128i x;
+	__m128i m[4];
+	const __m128i bswap = _mm_setr_epi8
+	(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+	);
+
+	/* ABEF and CDGH */
+	t0 = _mm_shuffle_epi32(LOADU(h), 0xB1);
+	s1 = _mm_shuffle_epi32(LOADU(h + 4), 0x1B);
+	s0 = _mm_alignr_epi8(t0, s1, 8);
+	s1 = _mm_blend_epi16(s1, t0, 0xF0);
+
+	for(; blocks; blocks--)
+	{
+		t0 = s0;
+		t1 = s1;
+
+		SHANI_QUAD(0);
+		SHANI_QUAD(1);
+		SHANI_QUAD(2);
+		SHANI_QUAD(3);
+		SHANI_QUAD(4);
+		SHANI_QUAD(5);
+		SHANI_QUAD(6);
+		SHANI_QUAD(7);
+		SHANI_QUAD(8);
+		SHANI_QUAD(9);
+		SHANI_QUAD(10);
+		SHANI_QUAD(11);
+		SHANI_QUAD(12);
+		SHANI_QUAD(13);
+		SHANI_QUAD(14);
+		SHANI_QUAD(15);
+
+		s0 = _mm_add_epi32(s0, t0);
+		s1 = _mm_add_epi32(s1, t1);
+
+		in += 64;
+	}
+
+	/* back to ABCD and EFGH */
+	t0 = _mm_shuffle_epi32(s0, 0x1B);
+	s1 = _mm_shuffle_epi32(s1, 0xB1);
+	STOREU(h, _mm_blend_epi16(t0, s1, 0xF0));
+	STOREU(h + 4, _mm_alignr_epi8(s1, t0, 8));
+}
+
+#endif
+
 static void sha2_256_process(kripto_hash *s, const uint8_t *data)
 {
 	uint32_t a = s->h[0];
@@ -137,6 +235,14 @@ static void sha2_256_process(kripto_hash *s, const uint8_t *data)
 	uint32_t w[128];
 	unsigned int i;
 
+	#ifdef KRIPTO_X86_SIMD
+	if(s->r == 64 && (kripto_cpu() & SHANI_CPU) == SHANI_CPU)
+	{
+		sha2_256_shani(s->h, data, 1);
+		return;
+	}
+	#endif
+
 	w[0] = LOAD32B(data);
 	w[1] = LOAD32B(data + 4);
 	w[2] = LOAD32B(data + 8);
@@ -186,6 +292,29 @@ static void sha2_256_process(kripto_hash *s, const uint8_t *data)
 	s->h[7] += h;
 }
 
+/* whole blocks straight from in */
+static void sha2_256_blocks
+(
+	kripto_hash *s,
+	const uint8_t *in,
+	size_t blocks
+)
+{
+	#ifdef KRIPTO_X86_SIMD
+	if(s->r == 64 && (kripto_cpu() & SHANI_CPU) == SHANI_CPU)
+	{
+		sha2_256_shani(s->h, in, blocks);
+		return;
+	}
+	#endif
+
+	for(; blocks; blocks--)
+	{
+		sha2_256_process(s, in);
+		in += 64;
+	}
+}
+
 static void sha2_256_input
 (
 	kripto_hash *s,
@@ -193,20 +322,41 @@ static void sha2_256_input
 	size_t len
 ) 
 {
-	size_t i;
+	size_t n;
 
 	s->len += len << 3;
 	assert(s->len >= len << 3);
 
-	for(i = 0; i < len; i++)
+	/* fill the buffer */
+	if(s->i && len)
 	{
-		s->buf[s->i++] = CU8(in)[i];
+		n = 64 - s->i;
+		if(n > len) n = len;
 
-		if(s->i == 64)
-		{
-			sha2_256_process(s, s->buf);
-			s->i = 0;
-		}
+		memcpy(s->buf + s->i, in, n);
+		s->i += n;
+		in = CU8(in) + n;
+		len -= n;
+
+		if(s->i < 64) return;
+
+		sha2_256_process(s, s->buf);
+		s->i = 0;
+	}
+
+	/* whole blocks straight from in */
+	if(len >= 64)
+	{
+		sha2_256_blocks(s, in, len >> 6);
+		in = CU8(in) + (len & ~(size_t)63);
+		len &= 63;
+	}
+
+	/* buffer the rest */
+	if(len)
+	{
+		memcpy(s->buf, in, len);
+		s->i = len;
 	}
 }
 
@@ -257,6 +407,43 @@ static kripto_hash *sha2_256_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void sha2_256_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void sha2_256_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE64L(s->len, p);
+	for(i = 0; i < 8; i++) STORE32L(s->h[i], p + 8 + (i << 2));
+	memcpy(p + 40, s->buf, 64);
+	STORE32L(s->r, p + 104);
+	STORE32L(s->i, p + 108);
+	p[112] = s->o != 0;
+}
+
+static int sha2_256_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	unsigned int i;
+
+	/* w[] and k[] hold 128 rounds */
+	if(!LOAD32L(p + 104) || LOAD32L(p + 104) > 128) return -1;
+	if(LOAD32L(p + 108) > (p[112] ? 32 : 63)) return -1;
+
+	s->len = LOAD64L(p);
+	for(i = 0; i < 8; i++) s->h[i] = LOAD32L(p + 8 + (i << 2));
+	memcpy(s->buf, p + 40, 64);
+	s->r = LOAD32L(p + 104);
+	s->i = LOAD32L(p + 108);
+	s->o = p[112] ? -1 : 0;
+
+	return 0;
+}
+
 static void sha2_256_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
@@ -283,16 +470,327 @@ static int sha2_256_hash
 	return 0;
 }
 
+#ifdef KRIPTO_X86_SIMD
+
+/*
+ * Multi-buffer kernels: one block of 4, 8 or 16 messages at once,
+ * one message per 32-bit lane. Word i of lane l (of the state h and
+ * of the message schedule w) is at [i * lanes + l].
+ */
+
+#define VSHA2_256(V, T, N, LOAD, STORE, SET1, ADD, CH, MAJ, E0, E1, S0, S1) \
+{																	\
+	for(i = 0; i < r; i++)											\
+	{																\
+		if(i < 16) T = LOAD(w + i * N);								\
+		else														\
+		{															\
+			T = ADD(ADD(LOAD(w + (i & 15) * N),						\
+				S0(LOAD(w + ((i + 1) & 15) * N))),					\
+				ADD(LOAD(w + ((i + 9) & 15) * N),					\
+				S1(LOAD(w + ((i + 14) & 15) * N))));				\
+			STORE(w + (i & 15) * N, T);								\
+		}															\
+																	\
+		T = ADD(ADD(T, SET1((int)k[i])),							\
+			ADD(ADD(V[7], E1(V[4])), CH(V[4], V[5], V[6])));		\
+																	\
+		V[7] = V[6];												\
+		V[6] = V[5];												\
+		V[5] = V[4];												\
+		V[4] = ADD(V[3], T);										\
+		V[3] = V[2];												\
+		V[2] = V[1];												\
+		V[1] = V[0];												\
+		V[0] = ADD(T, ADD(E0(V[1]), MAJ(V[1], V[2], V[3])));		\
+	}																\
+}
+
+#define SSE2_ROR(X, N)												\
+	_mm_or_si128(_mm_srli_epi32(X, N), _mm_slli_epi32(X, 32 - (N)))
+#define SSE2_XOR3(X, Y, Z) _mm_xor_si128(_mm_xor_si128(X, Y), Z)
+#define SSE2_CH(X, Y, Z)											\
+	_mm_xor_si128(Z, _mm_and_si128(X, _mm_xor_si128(Y, Z)))
+#define SSE2_MAJ(X, Y, Z)											\
+	_mm_or_si128(_mm_and_si128(X, Y), _mm_and_si128(Z, _mm_or_si128(X, Y)))
+#define SSE2_E0(X) SSE2_XOR3(SSE2_ROR(X, 2), SSE2_ROR(X, 13), SSE2_ROR(X, 22))
+#define SSE2_E1(X) SSE2_XOR3(SSE2_ROR(X, 6), SSE2_ROR(X, 11), SSE2_ROR(X, 25))
+#define SSE2_S0(X)													\
+	SSE2_XOR3(SSE2_ROR(X, 7), SSE2_ROR(X, 18), _mm_srli_epi32(X, 3))
+#define SSE2_S1(X)													\
+	SSE2_XOR3(SSE2_ROR(X, 17), SSE2_ROR(X, 19), _mm_srli_epi32(X, 10))
+
+/* big endian words, SSE2 has no byte shuffle */
+#define SSE2_BSWAP(X)												\
+{																	\
+	X = _mm_shufflehi_epi16(_mm_shufflelo_epi16(X, 0xB1), 0xB1);	\
+	X = _mm_or_si128(_mm_slli_epi16(X, 8), _mm_srli_epi16(X, 8));	\
+}
+
+KRIPTO_TARGET("sse2")
+static void sha2_256_sse2
+(
+	void *state,
+	const uint8_t *const *in,
+	void *scratch,
+	unsigned int r
+)
+{
+	uint32_t *h = state;
+	uint32_t *w = scratch;
+	__m128i v[8];
+	__m128i x;
+	__m128i m[4];
+	__m128i t[4];
+	unsigned int i;
+
+	for(i = 0; i < 16; i += 4)
+	{
+		m[0] = LOADU(in[0] + (i << 2));
+		m[1] = LOADU(in[1] + (i << 2));
+		m[2] = LOADU(in[2] + (i << 2));
+		m[3] = LOADU(in[3] + (i << 2));
+
+		TRANSPOSE4(m[0], m[1], m[2], m[3], t,
+			_mm_unpacklo_epi32, _mm_unpackhi_epi32,
+			_mm_unpacklo_epi64, _mm_unpackhi_epi64);
+
+		SSE2_BSWAP(m[0]);
+		SSE2_BSWAP(m[1]);
+		SSE2_BSWAP(m[2]);
+		SSE2_BSWAP(m[3]);
+
+		STOREU(w + (i << 2), m[0]);
+		STOREU(w + (i << 2) + 4, m[1]);
+		STOREU(w + (i << 2) + 8, m[2]);
+		STOREU(w + (i << 2) + 12, m[3]);
+	}
+
+	for(i = 0; i < 8; i++) v[i] = LOADU(h + (i << 2));
+
+	VSHA2_256(v, x, 4, LOADU, STOREU,
+		_mm_set1_epi32, _mm_add_epi32, SSE2_CH, SSE2_MAJ,
+		SSE2_E0, SSE2_E1, SSE2_S0, SSE2_S1);
+
+	for(i = 0; i < 8; i++)
+		STOREU(h + (i << 2), _mm_add_epi32(v[i], LOADU(h + (i << 2))));
+}
+
+#define AVX2_ROR(X, N)												\
+	_mm256_or_si256(_mm256_srli_epi32(X, N), _mm256_slli_epi32(X, 32 - (N)))
+#define AVX2_XOR3(X, Y, Z) _mm256_xor_si256(_mm256_xor_si256(X, Y), Z)
+#define AVX2_CH(X, Y, Z)											\
+	_mm256_xor_si256(Z, _mm256_and_si256(X, _mm256_xor_si256(Y, Z)))
+#define AVX2_MAJ(X, Y, Z) _mm256_or_si256(_mm256_and_si256(X, Y),	\
+	_mm256_and_si256(Z, _mm256_or_si256(X, Y)))
+#define AVX2_E0(X) AVX2_XOR3(AVX2_ROR(X, 2), AVX2_ROR(X, 13), AVX2_ROR(X, 22))
+#define AVX2_E1(X) AVX2_XOR3(AVX2_ROR(X, 6), AVX2_ROR(X, 11), AVX2_ROR(X, 25))
+#define AVX2_S0(X)													\
+	AVX2_XOR3(AVX2_ROR(X, 7), AVX2_ROR(X, 18), _mm256_srli_epi32(X, 3))
+#define AVX2_S1(X)													\
+	AVX2_XOR3(AVX2_ROR(X, 17), AVX2_ROR(X, 19), _mm256_srli_epi32(X, 10))
+
+/* 16 bytes of lanes A and B */
+#define AVX2_LOAD2(A, B)											\
+	_mm256_inserti128_si256(_mm256_castsi128_si256(LOADU(A)), LOADU(B), 1)
+
+KRIPTO_TARGET("avx2")
+static void sha2_256_avx2
+(
+	void *state,
+	const uint8_t *const *in,
+	void *scratch,
+	unsigned int r
+)
+{
+	uint32_t *h = state;
+	uint32_t *w = scratch;
+	__m256i v[8];
+	__m256i x;
+	__m256i m[4];
+	__m256i t[4];
+	const __m256i bswap = _mm256_setr_epi8
+	(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+	);
+	unsigned int i;
+
+	for(i = 0; i < 16; i += 4)
+	{
+		m[0] = AVX2_LOAD2(in[0] + (i << 2), in[4] + (i << 2));
+		m[1] = AVX2_LOAD2(in[1] + (i << 2), in[5] + (i << 2));
+		m[2] = AVX2_LOAD2(in[2] + (i << 2), in[6] + (i << 2));
+		m[3] = AVX2_LOAD2(in[3] + (i << 2), in[7] + (i << 2));
+
+		TRANSPOSE4(m[0], m[1], m[2], m[3], t,
+			_mm256_unpacklo_epi32, _mm256_unpackhi_epi32,
+			_mm256_unpacklo_epi64, _mm256_unpackhi_epi64);
+
+		STOREU256(w + (i << 3), _mm256_shuffle_epi8(m[0], bswap));
+		STOREU256(w + (i << 3) + 8, _mm256_shuffle_epi8(m[1], bswap));
+		STOREU256(w + (i << 3) + 16, _mm256_shuffle_epi8(m[2], bswap));
+		STOREU256(w + (i << 3) + 24, _mm256_shuffle_epi8(m[3], bswap));
+	}
+
+	for(i = 0; i < 8; i++) v[i] = LOADU256(h + (i << 3));
+
+	VSHA2_256(v, x, 8, LOADU256, STOREU256,
+		_mm256_set1_epi32, _mm256_add_epi32, AVX2_CH, AVX2_MAJ,
+		AVX2_E0, AVX2_E1, AVX2_S0, AVX2_S1);
+
+	for(i = 0; i < 8; i++)
+	{
+		STOREU256(h + (i << 3),
+			_mm256_add_epi32(v[i], LOADU256(h + (i << 3))));
+	}
+}
+
+#define AVX512_XOR3(X, Y, Z) _mm512_ternarylogic_epi32(X, Y, Z, 0x96)
+#define AVX512_CH(X, Y, Z) _mm512_ternarylogic_epi32(X, Y, Z, 0xCA)
+#define AVX512_MAJ(X, Y, Z) _mm512_ternarylogic_epi32(X, Y, Z, 0xE8)
+#define AVX512_E0(X) AVX512_XOR3(_mm512_ror_epi32(X, 2),			\
+	_mm512_ror_epi32(X, 13), _mm512_ror_epi32(X, 22))
+#define AVX512_E1(X) AVX512_XOR3(_mm512_ror_epi32(X, 6),			\
+	_mm512_ror_epi32(X, 11), _mm512_ror_epi32(X, 25))
+#define AVX512_S0(X) AVX512_XOR3(_mm512_ror_epi32(X, 7),			\
+	_mm512_ror_epi32(X, 18), _mm512_srli_epi32(X, 3))
+#define AVX512_S1(X) AVX512_XOR3(_mm512_ror_epi32(X, 17),			\
+	_mm512_ror_epi32(X, 19), _mm512_srli_epi32(X, 10))
+
+/* 16 bytes of lanes A, B, C and D */
+#define AVX512_LOAD4(A, B, C, D)									\
+	_mm512_inserti32x4(_mm512_inserti32x4(_mm512_inserti32x4(		\
+	_mm512_castsi128_si512(LOADU(A)), LOADU(B), 1), LOADU(C), 2),	\
+	LOADU(D), 3)
+
+KRIPTO_TARGET("avx512f,avx512bw")
+static void sha2_256_avx512
+(
+	void *state,
+	const uint8_t *const *in,
+	void *scratch,
+	unsigned int r
+)
+{
+	uint32_t *h = state;
+	uint32_t *w = scratch;
+	__m512i v[8];
+	__m512i x;
+	__m512i m[4];
+	__m512i t[4];
+	const __m512i bswap = _mm512_broadcast_i32x4(_mm_setr_epi8
+	(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+	));
+	unsigned int i;
+	unsigned int j;
+
+	for(i = 0; i < 16; i += 4)
+	{
+		for(j = 0; j < 4; j++)
+		{
+			m[j] = AVX512_LOAD4(in[j] + (i << 2), in[j + 4] + (i << 2),
+				in[j + 8] + (i << 2), in[j + 12] + (i << 2));
+		}
+
+		TRANSPOSE4(m[0], m[1], m[2], m[3], t,
+			_mm512_unpacklo_epi32, _mm512_unpackhi_epi32,
+			_mm512_unpacklo_epi64, _mm512_unpackhi_epi64);
+
+		for(j = 0; j < 4; j++)
+		{
+			STOREU512(w + ((i + j) << 4),
+				_mm512_shuffle_epi8(m[j], bswap));
+		}
+	}
+
+	for(i = 0; i < 8; i++) v[i] = LOADU512(h + (i << 4));
+
+	VSHA2_256(v, x, 16, LOADU512, STOREU512,
+		_mm512_set1_epi32, _mm512_add_epi32, AVX512_CH, AVX512_MAJ,
+		AVX512_E0, AVX512_E1, AVX512_S0, AVX512_S1);
+
+	for(i = 0; i < 8; i++)
+	{
+		STOREU512(h + (i << 4),
+			_mm512_add_epi32(v[i], LOADU512(h + (i << 4))));
+	}
+}
+
+static const struct kripto_lanes_md sha2_256_lanes =
+{
+	64, /* block */
+	1, /* big endian */
+	8, /* state words */
+	4, /* word size */
+	&sha2_256_process,
+	{
+		{16, KRIPTO_CPU_AVX512, &sha2_256_avx512},
+		{8, KRIPTO_CPU_AVX2, &sha2_256_avx2},
+		{4, KRIPTO_CPU_SSE2, &sha2_256_sse2},
+		{0, 0, 0}
+	}
+};
+
+static int sha2_256_many
+(
+	unsigned int r,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+)
+{
+	kripto_hash s;
+	size_t i;
+
+	/* initial state and rounds */
+	(void)sha2_256_recreate(&s, r, out_len);
+
+	if(kripto_lanes_md(
+		&sha2_256_lanes,
+		&s,
+		s.h,
+		s.r,
+		in,
+		in_len,
+		out,
+		n,
+		out_len)
+	)
+	{
+		for(i = 0; i < n; i++)
+			(void)sha2_256_hash(r, in[i], in_len[i], out[i], out_len);
+	}
+
+	kripto_memwipe(&s, sizeof(kripto_hash));
+
+	return 0;
+}
+
+#endif
+
 static const kripto_hash_desc sha2_256 =
 {
 	&sha2_256_create,
 	&sha2_256_recreate,
 	&sha2_256_input,
 	&sha2_256_output,
+	&sha2_256_copy,
+	&sha2_256_export,
+	&sha2_256_import,
 	&sha2_256_destroy,
 	&sha2_256_hash,
+	#ifdef KRIPTO_X86_SIMD
+	&sha2_256_many,
+	#else
+	0, /* hash_many */
+	#endif
 	32, /* max output */
-	64 /* block_size */
+	64, /* block_size */
+	113 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_sha2_256 = &sha2_256;
@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
 
@@ -21,6 +22,9 @@
 #include <kripto/loadstore.h>
 #include <kripto/rotate.h>
 #include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
+#include <kripto/lanes.h>
 #include <kripto/hash.h>
 #include <kripto/desc/hash.h>
 #include <kripto/object/hash.h>
@@ -171,17 +175,55 @@ static kripto_hash *sha2_512_recreate
 	return s;
 }
 
-static void sha2_512_process(kripto_hash *s, const uint8_t *in)
+/* r rounds from wk[i * n] = w[i] + k[i] */
+static void sha2_512_rounds
+(
+	uint64_t *s,
+	const uint64_t *wk,
+	unsigned int n,
+	unsigned int r
+)
 {
-	uint64_t a = s->h[0];
-	uint64_t b = s->h[1];
-	uint64_t c = s->h[2];
-	uint64_t d = s->h[3];
-	uint64_t e = s->h[4];
-	uint64_t f = s->h[5];
-	uint64_t g = s->h[6];
-	uint64_t h = s->h[7];
+	uint64_t a = s[0];
+	uint64_t b = s[1];
+	uint64_t c = s[2];
+	uint64_t d = s[3];
+	uint64_t e = s[4];
+	uint64_t f = s[5];
+	uint64_t g = s[6];
+	uint64_t h = s[7];
 	uint64_t t;
+	unsigned int i;
+
+	for(i = 0; i < r; i++)
+	{
+		h += E1(e) + CH(e, f, g) + wk[i * n];
+		d += h;
+		h += E0(a) + MAJ(a, b, c);
+
+		t = h;
+		h = g;
+		g = f;
+		f = e;
+		e = d;
+		d = c;
+		c = b;
+		b = a;
+		a = t;
+	}
+
+	s[0] += a;
+	s[1] += b;
+	s[2] += c;
+	s[3] += d;
+	s[4] += e;
+	s[5] += f;
+	s[6] += g;
+	s[7] += h;
+}
+
+static void sha2_512_process(kripto_hash *s, const uint8_t *in)
+{
 	uint64_t w[160];
 	unsigned int i;
 
@@ -205,33 +247,135 @@ static void sha2_512_process(kripto_hash *s, const uint8_t *in)
 	for(i = 16; i < s->r; i++)
 		w[i] = w[i - 16] + S0(w[i - 15]) +  w[i - 7] + S1(w[i - 2]);
 
-	for(i = 0; i < s->r; i++)
+	for(i = 0; i < s->r; i++) w[i] += k[i];
+
+	sha2_512_rounds(s->h, w, 1, s->r);
+
+	kripto_memwipe(w, s->r << 3);
+}
+
+#ifdef KRIPTO_X86_SIMD
+
+#define AVX2_ROR(X, N) \
+	_mm256_or_si256(_mm256_srli_epi64(X, N), _mm256_slli_epi64(X, 64 - (N)))
+#define AVX2_XOR3(X, Y, Z) _mm256_xor_si256(_mm256_xor_si256(X, Y), Z)
+#define AVX2_CH(X, Y, Z) \
+	_mm256_xor_si256(Z, _mm256_and_si256(X, _mm256_xor_si256(Y, Z)))
+#define AVX2_MAJ(X, Y, Z) _mm256_or_si256(_mm256_and_si256(X, Y), \
+	_mm256_and_si256(Z, _mm256_or_si256(X, Y)))
+#define AVX2_E0(X) AVX2_XOR3(AVX2_ROR(X, 28), AVX2_ROR(X, 34), AVX2_ROR(X, 39))
+#define AVX2_E1(X) AVX2_XOR3(AVX2_ROR(X, 14), AVX2_ROR(X, 18), AVX2_ROR(X, 41))
+#define AVX2_S0(X) \
+	AVX2_XOR3(AVX2_ROR(X, 1), AVX2_ROR(X, 8), _mm256_srli_epi64(X, 7))
+#define AVX2_S1(X) \
+	AVX2_XOR3(AVX2_ROR(X, 19), AVX2_ROR(X, 61), _mm256_srli_epi64(X, 6))
+
+/*
+ * Words 4i...4i + 3 of 4 messages, one message per 64-bit lane,
+ * to w[4i]...w[4i + 3], byte swapped with bswap.
+ */
+#define AVX2_LOAD4(W, P, I, T, BSWAP)								\
+{																	\
+	T[0] = LOADU256(P[0] + ((I) << 5));								\
+	T[1] = LOADU256(P[1] + ((I) << 5));								\
+	T[2] = LOADU256(P[2] + ((I) << 5));								\
+	T[3] = LOADU256(P[3] + ((I) << 5));								\
+	T[4] = _mm256_unpacklo_epi64(T[0], T[1]);						\
+	T[5] = _mm256_unpackhi_epi64(T[0], T[1]);						\
+	T[6] = _mm256_unpacklo_epi64(T[2], T[3]);						\
+	T[7] = _mm256_unpackhi_epi64(T[2], T[3]);						\
+	W[((I) << 2)] = _mm256_shuffle_epi8(							\
+		_mm256_permute2x128_si256(T[4], T[6], 0x20), BSWAP);		\
+	W[((I) << 2) + 1] = _mm256_shuffle_epi8(						\
+		_mm256_permute2x128_si256(T[5], T[7], 0x20), BSWAP);		\
+	W[((I) << 2) + 2] = _mm256_shuffle_epi8(						\
+		_mm256_permute2x128_si256(T[4], T[6], 0x31), BSWAP);		\
+	W[((I) << 2) + 3] = _mm256_shuffle_epi8(						\
+		_mm256_permute2x128_si256(T[5], T[7], 0x31), BSWAP);		\
+}
+
+/*
+ * Message schedule of up to 4 blocks at once, one block per 64-bit
+ * lane, then the rounds of each block from the scheduled wk.
+ */
+KRIPTO_TARGET("avx2")
+static void sha2_512_schedule_avx2
+(
+	uint64_t *h,
+	const uint8_t *in,
+	size_t blocks,
+	unsigned int r,
+	uint64_t *wk
+)
+{
+	__m256i w[16];
+	__m256i t[8];
+	const __m256i bswap = _mm256_setr_epi8
+	(
+		7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+		7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+	);
+	const uint8_t *p[4];
+	unsigned int n;
+	unsigned int i;
+
+	for(; blocks; blocks -= n)
 	{
-		h += E1(e) + CH(e, f, g) + k[i] + w[i];
-		d += h;
-		h += E0(a) + MAJ(a, b, c);
+		n = blocks < 4 ? blocks : 4;
 
-		t = h;
-		h = g;
-		g = f;
-		f = e;
-		e = d;
-		d = c;
-		c = b;
-		b = a;
-		a = t;
+		/* lanes past the last block just repeat the first */
+		for(i = 0; i < 4; i++) p[i] = in + ((i < n ? i : 0) << 7);
+
+		AVX2_LOAD4(w, p, 0, t, bswap);
+		AVX2_LOAD4(w, p, 1, t, bswap);
+		AVX2_LOAD4(w, p, 2, t, bswap);
+		AVX2_LOAD4(w, p, 3, t, bswap);
+
+		for(i = 0; i < r; i++)
+		{
+			if(i >= 16)
+			{
+				w[i & 15] = _mm256_add_epi64(
+					_mm256_add_epi64(w[i & 15], AVX2_S0(w[(i + 1) & 15])),
+					_mm256_add_epi64(w[(i + 9) & 15], AVX2_S1(w[(i + 14) & 15])));
+			}
+
+			STOREU256(wk + (i << 2), _mm256_add_epi64(w[i & 15],
+				_mm256_set1_epi64x((long long)k[i])));
+		}
+
+		for(i = 0; i < n; i++) sha2_512_rounds(h, wk + i, 4, r);
+
+		in += n << 7;
 	}
+}
 
-	kripto_memwipe(w, s->r << 2);
+#endif
 
-	s->h[0] += a;
-	s->h[1] += b;
-	s->h[2] += c;
-	s->h[3] += d;
-	s->h[4] += e;
-	s->h[5] += f;
-	s->h[6] += g;
-	s->h[7] += h;
+/* whole blocks straight from in */
+static void sha2_512_blocks
+(
+	kripto_hash *s,
+	const uint8_t *in,
+	size_t blocks
+)
+{
+	#ifdef KRIPTO_X86_SIMD
+	uint64_t wk[640];
+
+	if(blocks > 1 && (kripto_cpu() & KRIPTO_CPU_AVX2))
+	{
+		sha2_512_schedule_avx2(s->h, in, blocks, s->r, wk);
+		kripto_memwipe(wk, s->r << 5);
+		return;
+	}
+	#endif
+
+	for(; blocks; blocks--)
+	{
+		sha2_512_process(s, in);
+		in += 128;
+	}
 }
 
 static void sha2_512_input
@@ -241,21 +385,42 @@ static void sha2_512_input
 	size_t len
 ) 
 {
-	size_t i;
+	size_t n;
 
 	s->len[0] += len << 3;
 	/* TODO: s->len[1] */
 	assert(s->len[0] >= len << 3);
 
-	for(i = 0; i < len; i++)
+	/* fill the buffer */
+	if(s->i && len)
 	{
-		s->buf[s->i++] = CU8(in)[i];
+		n = 128 - s->i;
+		if(n > len) n = len;
 
-		if(s->i == 128)
-		{
-			sha2_512_process(s, s->buf);
-			s->i = 0;
-		}
+		memcpy(s->buf + s->i, in, n);
+		s->i += n;
+		in = CU8(in) + n;
+		len -= n;
+
+		if(s->i < 128) return;
+
+		sha2_512_process(s, s->buf);
+		s->i = 0;
+	}
+
+	/* whole blocks straight from in */
+	if(len >= 128)
+	{
+		sha2_512_blocks(s, in, len >> 7);
+		in = CU8(in) + (len & ~(size_t)127);
+		len &= 127;
+	}
+
+	/* buffer the rest */
+	if(len)
+	{
+		memcpy(s->buf, in, len);
+		s->i = len;
 	}
 }
 
@@ -306,6 +471,43 @@ static kripto_hash *sha2_512_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void sha2_512_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void sha2_512_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	for(i = 0; i < 8; i++) STORE64L(s->h[i], p + (i << 3));
+	for(i = 0; i < 2; i++) STORE64L(s->len[i], p + 64 + (i << 3));
+	memcpy(p + 80, s->buf, 128);
+	STORE32L(s->r, p + 208);
+	STORE32L(s->i, p + 212);
+	p[216] = s->o != 0;
+}
+
+static int sha2_512_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	unsigned int i;
+
+	/* w[] and k[] hold 160 rounds */
+	if(!LOAD32L(p + 208) || LOAD32L(p + 208) > 160) return -1;
+	if(LOAD32L(p + 212) > (p[216] ? 64 : 127)) return -1;
+
+	for(i = 0; i < 8; i++) s->h[i] = LOAD64L(p + (i << 3));
+	for(i = 0; i < 2; i++) s->len[i] = LOAD64L(p + 64 + (i << 3));
+	memcpy(s->buf, p + 80, 128);
+	s->r = LOAD32L(p + 208);
+	s->i = LOAD32L(p + 212);
+	s->o = p[216] ? -1 : 0;
+
+	return 0;
+}
+
 static void sha2_512_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
@@ -332,16 +534,231 @@ static int sha2_512_hash
 	return 0;
 }
 
+#ifdef KRIPTO_X86_SIMD
+
+/*
+ * Multi-buffer kernels: one block of 4 or 8 messages at once, one
+ * message per 64-bit lane. Word i of lane l (of the state h and of
+ * the message schedule w) is at [i * lanes + l].
+ */
+
+#define VSHA2_512(V, T, N, LOAD, STORE, SET1, ADD, CH, MAJ, E0, E1, S0, S1) \
+{																	\
+	for(i = 0; i < r; i++)											\
+	{																\
+		if(i < 16) T = LOAD(w + i * N);								\
+		else														\
+		{															\
+			T = ADD(ADD(LOAD(w + (i & 15) * N),						\
+				S0(LOAD(w + ((i + 1) & 15) * N))),					\
+				ADD(LOAD(w + ((i + 9) & 15) * N),					\
+				S1(LOAD(w + ((i + 14) & 15) * N))));				\
+			STORE(w + (i & 15) * N, T);								\
+		}															\
+																	\
+		T = ADD(ADD(T, SET1((long long)k[i])),						\
+			ADD(ADD(V[7], E1(V[4])), CH(V[4], V[5], V[6])));		\
+																	\
+		V[7] = V[6];												\
+		V[6] = V[5];												\
+		V[5] = V[4];												\
+		V[4] = ADD(V[3], T);										\
+		V[3] = V[2];												\
+		V[2] = V[1];												\
+		V[1] = V[0];												\
+		V[0] = ADD(T, ADD(E0(V[1]), MAJ(V[1], V[2], V[3])));		\
+	}																\
+}
+
+KRIPTO_TARGET("avx2")
+static void sha2_512_avx2
+(
+	void *state,
+	const uint8_t *const *in,
+	void *scratch,
+	unsigned int r
+)
+{
+	uint64_t *h = state;
+	uint64_t *w = scratch;
+	__m256i v[16];
+	__m256i x;
+	__m256i t[8];
+	const __m256i bswap = _mm256_setr_epi8
+	(
+		7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+		7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+	);
+	unsigned int i;
+
+	AVX2_LOAD4(v, in, 0, t, bswap);
+	AVX2_LOAD4(v, in, 1, t, bswap);
+	AVX2_LOAD4(v, in, 2, t, bswap);
+	AVX2_LOAD4(v, in, 3, t, bswap);
+
+	for(i = 0; i < 16; i++) STOREU256(w + (i << 2), v[i]);
+
+	for(i = 0; i < 8; i++) v[i] = LOADU256(h + (i << 2));
+
+	VSHA2_512(v, x, 4, LOADU256, STOREU256,
+		_mm256_set1_epi64x, _mm256_add_epi64, AVX2_CH, AVX2_MAJ,
+		AVX2_E0, AVX2_E1, AVX2_S0, AVX2_S1);
+
+	for(i = 0; i < 8; i++)
+	{
+		STOREU256(h + (i << 2),
+			_mm256_add_epi64(v[i], LOADU256(h + (i << 2))));
+	}
+}
+
+#define AVX512_XOR3(X, Y, Z) _mm512_ternarylogic_epi64(X, Y, Z, 0x96)
+#define AVX512_CH(X, Y, Z) _mm512_ternarylogic_epi64(X, Y, Z, 0xCA)
+#define AVX512_MAJ(X, Y, Z) _mm512_ternarylogic_epi64(X, Y, Z, 0xE8)
+#define AVX512_E0(X) AVX512_XOR3(_mm512_ror_epi64(X, 28),			\
+	_mm512_ror_epi64(X, 34), _mm512_ror_epi64(X, 39))
+#define AVX512_E1(X) AVX512_XOR3(_mm512_ror_epi64(X, 14),			\
+	_mm512_ror_epi64(X, 18), _mm512_ror_epi64(X, 41))
+#define AVX512_S0(X) AVX512_XOR3(_mm512_ror_epi64(X, 1),			\
+	_mm512_ror_epi64(X, 8), _mm512_srli_epi64(X, 7))
+#define AVX512_S1(X) AVX512_XOR3(_mm512_ror_epi64(X, 19),			\
+	_mm512_ror_epi64(X, 61), _mm512_srli_epi64(X, 6))
+
+/* 32 bytes of lanes A and B */
+#define AVX512_LOAD2(A, B)											\
+	_mm512_inserti64x4(_mm512_castsi256_si512(LOADU256(A)), LOADU256(B), 1)
+
+KRIPTO_TARGET("avx512f,avx512bw")
+static void sha2_512_avx512
+(
+	void *state,
+	const uint8_t *const *in,
+	void *scratch,
+	unsigned int r
+)
+{
+	uint64_t *h = state;
+	uint64_t *w = scratch;
+	__m512i v[8];
+	__m512i x;
+	__m512i m[4];
+	__m512i t[4];
+	const __m512i bswap = _mm512_broadcast_i32x4(_mm_setr_epi8
+	(
+		7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+	));
+	const __m512i even = _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13);
+	const __m512i odd = _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15);
+	unsigned int i;
+	unsigned int j;
+
+	for(i = 0; i < 16; i += 4)
+	{
+		/* words i...i + 3 of lanes j and j + 4 */
+		for(j = 0; j < 4; j++)
+			m[j] = AVX512_LOAD2(in[j] + (i << 3), in[j + 4] + (i << 3));
+
+		t[0] = _mm512_unpacklo_epi64(m[0], m[1]);
+		t[1] = _mm512_unpackhi_epi64(m[0], m[1]);
+		t[2] = _mm512_unpacklo_epi64(m[2], m[3]);
+		t[3] = _mm512_unpackhi_epi64(m[2], m[3]);
+
+		m[0] = _mm512_permutex2var_epi64(t[0], even, t[2]);
+		m[1] = _mm512_permutex2var_epi64(t[1], even, t[3]);
+		m[2] = _mm512_permutex2var_epi64(t[0], odd, t[2]);
+		m[3] = _mm512_permutex2var_epi64(t[1], odd, t[3]);
+
+		for(j = 0; j < 4; j++)
+		{
+			STOREU512(w + ((i + j) << 3),
+				_mm512_shuffle_epi8(m[j], bswap));
+		}
+	}
+
+	for(i = 0; i < 8; i++) v[i] = LOADU512(h + (i << 3));
+
+	VSHA2_512(v, x, 8, LOADU512, STOREU512,
+		_mm512_set1_epi64, _mm512_add_epi64, AVX512_CH, AVX512_MAJ,
+		AVX512_E0, AVX512_E1, AVX512_S0, AVX512_S1);
+
+	for(i = 0; i < 8; i++)
+	{
+		STOREU512(h + (i << 3),
+			_mm512_add_epi64(v[i], LOADU512(h + (i << 3))));
+	}
+}
+
+static const struct kripto_lanes_md sha2_512_lanes =
+{
+	128, /* block */
+	1, /* big endian */
+	8, /* state words */
+	8, /* word size */
+	&sha2_512_process,
+	{
+		{8, KRIPTO_CPU_AVX512, &sha2_512_avx512},
+		{4, KRIPTO_CPU_AVX2, &sha2_512_avx2},
+		{0, 0, 0}
+	}
+};
+
+static int sha2_512_many
+(
+	unsigned int r,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+)
+{
+	kripto_hash s;
+	size_t i;
+
+	/* initial state and rounds */
+	(void)sha2_512_recreate(&s, r, out_len);
+
+	if(kripto_lanes_md(
+		&sha2_512_lanes,
+		&s,
+		s.h,
+		s.r,
+		in,
+		in_len,
+		out,
+		n,
+		out_len)
+	)
+	{
+		for(i = 0; i < n; i++)
+			(void)sha2_512_hash(r, in[i], in_len[i], out[i], out_len);
+	}
+
+	kripto_memwipe(&s, sizeof(kripto_hash));
+
+	return 0;
+}
+
+#endif
+
 static const kripto_hash_desc sha2_512 =
 {
 	&sha2_512_create,
 	&sha2_512_recreate,
 	&sha2_512_input,
 	&sha2_512_output,
+	&sha2_512_copy,
+	&sha2_512_export,
+	&sha2_512_import,
 	&sha2_512_destroy,
 	&sha2_512_hash,
+	#ifdef KRIPTO_X86_SIMD
+	&sha2_512_many,
+	#else
+	0, /* hash_many */
+	#endif
 	64, /* max output */
-	128 /* block_size */
+	128, /* block_size */
+	217 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_sha2_512 = &sha2_512;
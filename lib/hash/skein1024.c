@@ -60,15 +60,15 @@ struct kripto_hash
 	}						\
 }
 
-static void skein1024_process(kripto_hash *s) 
+static void skein1024_process(kripto_hash *s, const uint8_t *data)
 {
 	unsigned int i;
 
 	(void)kripto_block_recreate(s->block, s->r, s->h, 128);
 	kripto_block_tweak(s->block, s->tweak, 16);
-	kripto_block_encrypt(s->block, s->buf, s->h);
+	kripto_block_encrypt(s->block, data, s->h);
 
-	for(i = 0; i < 128; i++) s->h[i] ^= s->buf[i];
+	for(i = 0; i < 128; i++) s->h[i] ^= data[i];
 }
 
 static kripto_hash *skein1024_recreate
@@ -101,7 +101,7 @@ static kripto_hash *skein1024_recreate
 	memset(s->buf + 16, 0, 112);
 	s->tweak[0] = 32;
 	s->tweak[15] = 0xC4; /* type CFG, first, final */
-	skein1024_process(s);
+	skein1024_process(s, s->buf);
 
 	/* MSG */
 	s->tweak[0] = 0;
@@ -117,20 +117,46 @@ static void skein1024_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		s->buf[s->i++] = CU8(in)[i];
-
-		if(s->i == 128)
+		if(s->i)
 		{
-			POS_ADD(s->tweak, 128);
+			/* fill the buffer */
+			n = 128 - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
 
-			skein1024_process(s);
-			s->tweak[15] = 0x30; /* type MSG */
-			s->i = 0;
+			if(s->i < 128) return;
+
+			block = s->buf;
+		}
+		else if(len >= 128)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 128;
+			len -= 128;
+		}
+		else
+		{
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
 		}
+
+		POS_ADD(s->tweak, 128);
+
+		skein1024_process(s, block);
+		s->tweak[15] = 0x30; /* type MSG */
+		s->i = 0;
 	}
 }
 
@@ -140,13 +166,13 @@ static void skein1024_finish(kripto_hash *s)
 
 	memset(s->buf + s->i, 0, 128 - s->i);
 	s->tweak[15] |= 0x80; /* add final */
-	skein1024_process(s);
+	skein1024_process(s, s->buf);
 
 	memset(s->buf, 0, 128);
 	memset(s->tweak, 0, 12);
 	s->tweak[0] = 8; /* 8 byte counter */
 	s->tweak[15] = 0xFF; /* type OUT, first, final */
-	skein1024_process(s);
+	skein1024_process(s, s->buf);
 
 	s->i = 0;
 	s->f = -1;
@@ -154,10 +180,10 @@ static void skein1024_finish(kripto_hash *s)
 
 static void skein1024_output(kripto_hash *s, void *out, size_t len)
 {
-	assert(s->i + len <= 128);
-
 	if(!s->f) skein1024_finish(s);
 
+	assert(s->i + len <= 128);
+
 	memcpy(out, s->h + s->i, len);
 	s->i += len;
 }
@@ -183,6 +209,43 @@ static kripto_hash *skein1024_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void skein1024_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	kripto_block *block = dst->block;
+
+	memcpy(dst, src, sizeof(kripto_hash));
+	dst->block = block;
+}
+
+static void skein1024_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+
+	STORE32L(s->r, p);
+	STORE32L(s->i, p + 4);
+	p[8] = s->f != 0;
+	memcpy(p + 9, s->h, 128);
+	memcpy(p + 137, s->buf, 128);
+	memcpy(p + 265, s->tweak, 16);
+}
+
+static int skein1024_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+
+	/* Threefish takes its key schedule words modulo, any rounds will do */
+	if(LOAD32L(p + 4) > 128) return -1;
+
+	s->r = LOAD32L(p);
+	s->i = LOAD32L(p + 4);
+	s->f = p[8] ? -1 : 0;
+	memcpy(s->h, p + 9, 128);
+	memcpy(s->buf, p + 137, 128);
+	memcpy(s->tweak, p + 265, 16);
+
+	return 0;
+}
+
 static void skein1024_destroy(kripto_hash *s)
 {
 	kripto_block_destroy(s->block);
@@ -220,10 +283,15 @@ static const kripto_hash_desc skein1024 =
 	&skein1024_recreate,
 	&skein1024_input,
 	&skein1024_output,
+	&skein1024_copy,
+	&skein1024_export,
+	&skein1024_import,
 	&skein1024_destroy,
 	&skein1024_hash,
+	0, /* hash_many */
 	128, /* max output */
-	128 /* block_size */
+	128, /* block_size */
+	281 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_skein1024 = &skein1024;
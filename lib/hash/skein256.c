@@ -60,15 +60,15 @@ struct kripto_hash
 	}						\
 }
 
-static void skein256_process(kripto_hash *s) 
+static void skein256_process(kripto_hash *s, const uint8_t *data)
 {
 	unsigned int i;
 
 	(void)kripto_block_recreate(s->block, s->r, s->h, 32);
 	kripto_block_tweak(s->block, s->tweak, 16);
-	kripto_block_encrypt(s->block, s->buf, s->h);
+	kripto_block_encrypt(s->block, data, s->h);
 
-	for(i = 0; i < 32; i++) s->h[i] ^= s->buf[i];
+	for(i = 0; i < 32; i++) s->h[i] ^= data[i];
 }
 
 static kripto_hash *skein256_recreate
@@ -101,7 +101,7 @@ static kripto_hash *skein256_recreate
 	memset(s->buf + 16, 0, 16);
 	s->tweak[0] = 32;
 	s->tweak[15] = 0xC4; /* type CFG, first, final */
-	skein256_process(s);
+	skein256_process(s, s->buf);
 
 	/* MSG */
 	s->tweak[0] = 0;
@@ -117,20 +117,46 @@ static void skein256_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		s->buf[s->i++] = CU8(in)[i];
-
-		if(s->i == 32)
+		if(s->i)
 		{
-			POS_ADD(s->tweak, 32);
+			/* fill the buffer */
+			n = 32 - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
 
-			skein256_process(s);
-			s->tweak[15] = 0x30; /* type MSG */
-			s->i = 0;
+			if(s->i < 32) return;
+
+			block = s->buf;
+		}
+		else if(len >= 32)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 32;
+			len -= 32;
+		}
+		else
+		{
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
 		}
+
+		POS_ADD(s->tweak, 32);
+
+		skein256_process(s, block);
+		s->tweak[15] = 0x30; /* type MSG */
+		s->i = 0;
 	}
 }
 
@@ -140,13 +166,13 @@ static void skein256_finish(kripto_hash *s)
 
 	memset(s->buf + s->i, 0, 32 - s->i);
 	s->tweak[15] |= 0x80; /* add final */
-	skein256_process(s);
+	skein256_process(s, s->buf);
 
 	memset(s->buf, 0, 32);
 	memset(s->tweak, 0, 12);
 	s->tweak[0] = 8; /* 8 byte counter */
 	s->tweak[15] = 0xFF; /* type OUT, first, final */
-	skein256_process(s);
+	skein256_process(s, s->buf);
 
 	s->i = 0;
 	s->f = -1;
@@ -154,10 +180,10 @@ static void skein256_finish(kripto_hash *s)
 
 static void skein256_output(kripto_hash *s, void *out, size_t len)
 {
-	assert(s->i + len <= 32);
-
 	if(!s->f) skein256_finish(s);
 
+	assert(s->i + len <= 32);
+
 	memcpy(out, s->h + s->i, len);
 	s->i += len;
 }
@@ -183,6 +209,43 @@ static kripto_hash *skein256_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void skein256_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	kripto_block *block = dst->block;
+
+	memcpy(dst, src, sizeof(kripto_hash));
+	dst->block = block;
+}
+
+static void skein256_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+
+	STORE32L(s->r, p);
+	STORE32L(s->i, p + 4);
+	p[8] = s->f != 0;
+	memcpy(p + 9, s->h, 32);
+	memcpy(p + 41, s->buf, 32);
+	memcpy(p + 73, s->tweak, 16);
+}
+
+static int skein256_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+
+	/* Threefish takes its key schedule words modulo, any rounds will do */
+	if(LOAD32L(p + 4) > 32) return -1;
+
+	s->r = LOAD32L(p);
+	s->i = LOAD32L(p + 4);
+	s->f = p[8] ? -1 : 0;
+	memcpy(s->h, p + 9, 32);
+	memcpy(s->buf, p + 41, 32);
+	memcpy(s->tweak, p + 73, 16);
+
+	return 0;
+}
+
 static void skein256_destroy(kripto_hash *s)
 {
 	kripto_block_destroy(s->block);
@@ -220,10 +283,15 @@ static const kripto_hash_desc skein256 =
 	&skein256_recreate,
 	&skein256_input,
 	&skein256_output,
+	&skein256_copy,
+	&skein256_export,
+	&skein256_import,
 	&skein256_destroy,
 	&skein256_hash,
+	0, /* hash_many */
 	32, /* max output */
-	32 /* block_size */
+	32, /* block_size */
+	89 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_skein256 = &skein256;
@@ -60,15 +60,15 @@ struct kripto_hash
 	}						\
 }
 
-static void skein512_process(kripto_hash *s) 
+static void skein512_process(kripto_hash *s, const uint8_t *data)
 {
 	unsigned int i;
 
 	(void)kripto_block_recreate(s->block, s->r, s->h, 64);
 	kripto_block_tweak(s->block, s->tweak, 16);
-	kripto_block_encrypt(s->block, s->buf, s->h);
+	kripto_block_encrypt(s->block, data, s->h);
 
-	for(i = 0; i < 64; i++) s->h[i] ^= s->buf[i];
+	for(i = 0; i < 64; i++) s->h[i] ^= data[i];
 }
 
 static kripto_hash *skein512_recreate
@@ -101,7 +101,7 @@ static kripto_hash *skein512_recreate
 	memset(s->buf + 16, 0, 48);
 	s->tweak[0] = 32;
 	s->tweak[15] = 0xC4; /* type CFG, first, final */
-	skein512_process(s);
+	skein512_process(s, s->buf);
 
 	/* MSG */
 	s->tweak[0] = 0;
@@ -117,20 +117,46 @@ static void skein512_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		s->buf[s->i++] = CU8(in)[i];
-
-		if(s->i == 64)
+		if(s->i)
 		{
-			POS_ADD(s->tweak, 64);
+			/* fill the buffer */
+			n = 64 - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
 
-			skein512_process(s);
-			s->tweak[15] = 0x30; /* type MSG */
-			s->i = 0;
+			if(s->i < 64) return;
+
+			block = s->buf;
+		}
+		else if(len >= 64)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 64;
+			len -= 64;
+		}
+		else
+		{
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
 		}
+
+		POS_ADD(s->tweak, 64);
+
+		skein512_process(s, block);
+		s->tweak[15] = 0x30; /* type MSG */
+		s->i = 0;
 	}
 }
 
@@ -140,13 +166,13 @@ static void skein512_finish(kripto_hash *s)
 
 	memset(s->buf + s->i, 0, 64 - s->i);
 	s->tweak[15] |= 0x80; /* add final */
-	skein512_process(s);
+	skein512_process(s, s->buf);
 
 	memset(s->buf, 0, 64);
 	memset(s->tweak, 0, 12);
 	s->tweak[0] = 8; /* 8 byte counter */
 	s->tweak[15] = 0xFF; /* type OUT, first, final */
-	skein512_process(s);
+	skein512_process(s, s->buf);
 
 	s->i = 0;
 	s->f = -1;
@@ -154,10 +180,10 @@ static void skein512_finish(kripto_hash *s)
 
 static void skein512_output(kripto_hash *s, void *out, size_t len)
 {
-	assert(s->i + len <= 64);
-
 	if(!s->f) skein512_finish(s);
 
+	assert(s->i + len <= 64);
+
 	memcpy(out, s->h + s->i, len);
 	s->i += len;
 }
@@ -183,6 +209,43 @@ static kripto_hash *skein512_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void skein512_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	kripto_block *block = dst->block;
+
+	memcpy(dst, src, sizeof(kripto_hash));
+	dst->block = block;
+}
+
+static void skein512_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+
+	STORE32L(s->r, p);
+	STORE32L(s->i, p + 4);
+	p[8] = s->f != 0;
+	memcpy(p + 9, s->h, 64);
+	memcpy(p + 73, s->buf, 64);
+	memcpy(p + 137, s->tweak, 16);
+}
+
+static int skein512_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+
+	/* Threefish takes its key schedule words modulo, any rounds will do */
+	if(LOAD32L(p + 4) > 64) return -1;
+
+	s->r = LOAD32L(p);
+	s->i = LOAD32L(p + 4);
+	s->f = p[8] ? -1 : 0;
+	memcpy(s->h, p + 9, 64);
+	memcpy(s->buf, p + 73, 64);
+	memcpy(s->tweak, p + 137, 16);
+
+	return 0;
+}
+
 static void skein512_destroy(kripto_hash *s)
 {
 	kripto_block_destroy(s->block);
@@ -220,10 +283,15 @@ static const kripto_hash_desc skein512 =
 	&skein512_recreate,
 	&skein512_input,
 	&skein512_output,
+	&skein512_copy,
+	&skein512_export,
+	&skein512_import,
 	&skein512_destroy,
 	&skein512_hash,
+	0, /* hash_many */
 	64, /* max output */
-	64 /* block_size */
+	64, /* block_size */
+	153 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_skein512 = &skein512;
@@ -695,20 +695,46 @@ static void tiger_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		if(s->i == 64)
+		if(s->i)
 		{
-			s->len += 512;
-			assert(s->len);
+			/* fill the buffer */
+			n = 64 - s->i;
+			if(n > len) n = len;
 
-			tiger_process(s, s->buf);
-			s->i = 0;
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
+
+			if(!len) return; /* keep the last block */
+
+			block = s->buf;
+		}
+		else if(len > 64)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 64;
+			len -= 64;
+		}
+		else
+		{
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
 		}
 
-		s->buf[s->i++] = CU8(in)[i];
+		s->len += 512;
+		assert(s->len);
+
+		tiger_process(s, block);
+		s->i = 0;
 	}
 }
 
@@ -767,6 +793,42 @@ static kripto_hash *tiger_create(unsigned int r, size_t len)
 	return tiger_recreate(s, r, len);
 }
 
+static void tiger_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void tiger_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->passes, p);
+	for(i = 0; i < 3; i++) STORE64L(s->h[i], p + 4 + (i << 3));
+	memcpy(p + 28, s->buf, 64);
+	STORE64L(s->len, p + 92);
+	STORE32L(s->i, p + 100);
+	p[104] = s->f != 0;
+}
+
+static int tiger_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	unsigned int i;
+
+	if(!LOAD32L(p)) return -1;
+	if(LOAD32L(p + 100) > (p[104] ? 24 : 64)) return -1;
+
+	s->passes = LOAD32L(p);
+	for(i = 0; i < 3; i++) s->h[i] = LOAD64L(p + 4 + (i << 3));
+	memcpy(s->buf, p + 28, 64);
+	s->len = LOAD64L(p + 92);
+	s->i = LOAD32L(p + 100);
+	s->f = p[104] ? -1 : 0;
+
+	return 0;
+}
+
 static void tiger_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
@@ -799,10 +861,15 @@ static const kripto_hash_desc tiger =
 	&tiger_recreate,
 	&tiger_input,
 	&tiger_output,
+	&tiger_copy,
+	&tiger_export,
+	&tiger_import,
 	&tiger_destroy,
 	&tiger_hash,
+	0, /* hash_many */
 	24, /* max output */
-	64 /* block_size */
+	64, /* block_size */
+	105 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_tiger = &tiger;
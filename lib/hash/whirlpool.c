@@ -915,26 +915,52 @@ static void whirlpool_input
 	size_t len
 ) 
 {
-	size_t i;
+	const uint8_t *block;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		if(s->i == 64)
+		if(s->i)
 		{
-			s->len[3] += 512;
-			if(!s->len[3])
-				if(!++s->len[2])
-					if(!++s->len[1])
-					{
-						s->len[0]++;
-						assert(s->len[0]);
-					}
-
-			whirlpool_process(s, s->buf);
-			s->i = 0;
+			/* fill the buffer */
+			n = 64 - s->i;
+			if(n > len) n = len;
+
+			memcpy(s->buf + s->i, in, n);
+			s->i += n;
+			in = CU8(in) + n;
+			len -= n;
+
+			if(!len) return; /* keep the last block */
+
+			block = s->buf;
+		}
+		else if(len > 64)
+		{
+			/* whole block straight from in */
+			block = in;
+			in = CU8(in) + 64;
+			len -= 64;
+		}
+		else
+		{
+			/* buffer the rest */
+			memcpy(s->buf, in, len);
+			s->i = len;
+			return;
 		}
 
-		s->buf[s->i++] = CU8(in)[i];
+		s->len[3] += 512;
+		if(!s->len[3])
+			if(!++s->len[2])
+				if(!++s->len[1])
+				{
+					s->len[0]++;
+					assert(s->len[0]);
+				}
+
+		whirlpool_process(s, block);
+		s->i = 0;
 	}
 }
 
@@ -1001,6 +1027,43 @@ static kripto_hash *whirlpool_create(unsigned int r, size_t len)
 	return s;
 }
 
+static void whirlpool_copy(kripto_hash *dst, const kripto_hash *src)
+{
+	memcpy(dst, src, sizeof(kripto_hash));
+}
+
+static void whirlpool_export(const kripto_hash *s, void *out)
+{
+	uint8_t *p = out;
+	unsigned int i;
+
+	STORE32L(s->r, p);
+	for(i = 0; i < 8; i++) STORE64L(s->h[i], p + 4 + (i << 3));
+	memcpy(p + 68, s->buf, 64);
+	for(i = 0; i < 4; i++) STORE64L(s->len[i], p + 132 + (i << 3));
+	STORE32L(s->i, p + 164);
+	p[168] = s->f != 0;
+}
+
+static int whirlpool_import(kripto_hash *s, const void *in)
+{
+	const uint8_t *p = in;
+	unsigned int i;
+
+	/* rc[] holds 10 rounds */
+	if(!LOAD32L(p) || LOAD32L(p) > 10) return -1;
+	if(LOAD32L(p + 164) > 64) return -1;
+
+	s->r = LOAD32L(p);
+	for(i = 0; i < 8; i++) s->h[i] = LOAD64L(p + 4 + (i << 3));
+	memcpy(s->buf, p + 68, 64);
+	for(i = 0; i < 4; i++) s->len[i] = LOAD64L(p + 132 + (i << 3));
+	s->i = LOAD32L(p + 164);
+	s->f = p[168] ? -1 : 0;
+
+	return 0;
+}
+
 static void whirlpool_destroy(kripto_hash *s)
 {
 	kripto_memwipe(s, sizeof(kripto_hash));
@@ -1033,10 +1096,15 @@ static const kripto_hash_desc whirlpool =
 	&whirlpool_recreate,
 	&whirlpool_input,
 	&whirlpool_output,
+	&whirlpool_copy,
+	&whirlpool_export,
+	&whirlpool_import,
 	&whirlpool_destroy,
 	&whirlpool_hash,
+	0, /* hash_many */
 	64, /* max output */
-	64 /* block_size */
+	64, /* block_size */
+	169 /* state size */
 };
 
 const kripto_hash_desc *const kripto_hash_whirlpool = &whirlpool;
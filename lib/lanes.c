@@ -0,0 +1,263 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <kripto/cast.h>
+#include <kripto/loadstore.h>
+#include <kripto/memwipe.h>
+#include <kripto/cpu.h>
+#include <kripto/hash.h>
+#include <kripto/lanes.h>
+
+/* words of lane l to v */
+static void lane_get(const struct kripto_lanes *x, unsigned int l, void *v)
+{
+	unsigned int i;
+
+	for(i = 0; i < x->words; i++)
+	{
+		memcpy
+		(
+			U8(v) + i * x->word_size,
+			CU8(x->h) + (i * x->lanes + l) * x->word_size,
+			x->word_size
+		);
+	}
+}
+
+/* words of lane l from v */
+static void lane_set(struct kripto_lanes *x, unsigned int l, const void *v)
+{
+	unsigned int i;
+
+	for(i = 0; i < x->words; i++)
+	{
+		memcpy
+		(
+			U8(x->h) + (i * x->lanes + l) * x->word_size,
+			CU8(v) + i * x->word_size,
+			x->word_size
+		);
+	}
+}
+
+static void lane_output
+(
+	const struct kripto_lanes *x,
+	unsigned int l,
+	void *out,
+	size_t len
+)
+{
+	unsigned int shift;
+	size_t w;
+	size_t i;
+
+	for(i = 0; i < len; i++)
+	{
+		w = (i / x->word_size) * x->lanes + l;
+		shift = (i % x->word_size) << 3;
+		if(x->big_endian) shift = ((x->word_size - 1) << 3) - shift;
+
+		if(x->word_size == 4) U8(out)[i] = CU32(x->h)[w] >> shift;
+		else U8(out)[i] = CU64(x->h)[w] >> shift;
+	}
+}
+
+void kripto_lanes_run
+(
+	struct kripto_lanes *x,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+)
+{
+	unsigned int active = 0;
+	unsigned int l;
+	size_t next = 0;
+
+	/* initial state */
+	memcpy(x->iv, x->s, x->words * x->word_size);
+
+	for(l = 0; l < x->lanes; l++)
+	{
+		x->lane[l].blocks = 0;
+		x->lane[l].msg = n;
+	}
+
+	for(;;)
+	{
+		for(l = 0; l < x->lanes; l++)
+		{
+			if(x->lane[l].msg == n && next < n)
+			{
+				x->load(x, x->lane + l, in[next], in_len[next]);
+				x->lane[l].msg = next++;
+				lane_set(x, l, x->iv);
+				active++;
+			}
+		}
+
+		if(!active) break;
+
+		if(next == n && (active << 2) <= x->lanes)
+		{
+			/* too few left to fill a vector */
+			for(l = 0; l < x->lanes; l++)
+			{
+				if(x->lane[l].msg == n) continue;
+
+				lane_get(x, l, x->s);
+				x->serial(x, x->lane + l);
+				lane_set(x, l, x->s);
+			}
+		}
+		else x->vector(x);
+
+		for(l = 0; l < x->lanes; l++)
+		{
+			if(x->lane[l].msg == n || x->lane[l].blocks) continue;
+
+			lane_output(x, l, out[x->lane[l].msg], out_len);
+
+			x->lane[l].msg = n;
+			active--;
+		}
+	}
+}
+
+struct md
+{
+	const struct kripto_lanes_md *desc;
+	void (*kernel)(void *, const uint8_t *const *, void *, unsigned int);
+	kripto_hash *s;
+	unsigned int r;
+	uint64_t w[128];
+};
+
+static const uint8_t zero[128];
+
+static void md_load
+(
+	struct kripto_lanes *x,
+	struct kripto_lane *l,
+	const void *in,
+	size_t len
+)
+{
+	const struct md *md = x->arg;
+	const unsigned int block = md->desc->block;
+	const size_t tail = len & (block - 1);
+	/* room for 0x80 and the length field */
+	const size_t pad = tail < block - (block >> 3) ? block : block << 1;
+
+	l->full = len / block;
+	l->blocks = l->full + pad / block;
+	l->in = l->full ? CU8(in) : l->pad;
+
+	if(tail) memcpy(l->pad, CU8(in) + len - tail, tail);
+	l->pad[tail] = 0x80; /* pad */
+	memset(l->pad + tail + 1, 0, pad - tail - 9);
+
+	if(md->desc->big_endian) STORE64B((uint64_t)len << 3, l->pad + pad - 8);
+	else STORE64L((uint64_t)len << 3, l->pad + pad - 8);
+}
+
+static const uint8_t *md_next(struct kripto_lane *l, unsigned int block)
+{
+	const uint8_t *p = l->in;
+
+	l->blocks--;
+	if(l->full && !--l->full) l->in = l->pad;
+	else l->in += block;
+
+	return p;
+}
+
+static void md_vector(struct kripto_lanes *x)
+{
+	struct md *md = x->arg;
+	const uint8_t *p[16];
+	unsigned int l;
+
+	for(l = 0; l < x->lanes; l++)
+	{
+		p[l] = x->lane[l].blocks ?
+			md_next(x->lane + l, md->desc->block) : zero;
+	}
+
+	md->kernel(x->h, p, md->w, md->r);
+}
+
+static void md_serial(struct kripto_lanes *x, struct kripto_lane *l)
+{
+	const struct md *md = x->arg;
+
+	while(l->blocks) md->desc->process(md->s, md_next(l, md->desc->block));
+}
+
+int kripto_lanes_md
+(
+	const struct kripto_lanes_md *md,
+	kripto_hash *s,
+	void *h,
+	unsigned int r,
+	const void *const *in,
+	const size_t *in_len,
+	void *const *out,
+	size_t n,
+	size_t out_len
+)
+{
+	struct kripto_lanes x;
+	struct md m;
+	uint64_t v[64];
+	const unsigned int cpu = kripto_cpu();
+	unsigned int i;
+
+	for(i = 0; md->kernel[i].lanes; i++)
+	{
+		if(n > md->kernel[i].lanes >> 1 && (cpu & md->kernel[i].cpu))
+			break;
+	}
+
+	if(!md->kernel[i].lanes) return -1;
+
+	m.desc = md;
+	m.kernel = md->kernel[i].f;
+	m.s = s;
+	m.r = r;
+
+	x.lanes = md->kernel[i].lanes;
+	x.words = md->words;
+	x.word_size = md->word_size;
+	x.big_endian = md->big_endian;
+	x.h = v;
+	x.s = h;
+	x.arg = &m;
+	x.load = &md_load;
+	x.vector = &md_vector;
+	x.serial = &md_serial;
+
+	kripto_lanes_run(&x, in, in_len, out, n, out_len);
+
+	kripto_memwipe(&x, sizeof(x));
+	kripto_memwipe(&m, sizeof(m));
+	kripto_memwipe(v, sizeof(v));
+
+	return 0;
+}
@@ -193,3 +193,10 @@ kripto_mac_desc *kripto_mac_hmac(const kripto_hash_desc *hash)
 
 	return (kripto_mac_desc *)s;
 }
+
+const kripto_hash_desc *kripto_mac_hmac_hash(const kripto_mac_desc *desc)
+{
+	if(desc->create != &hmac_create) return 0;
+
+	return EXT(desc)->hash;
+}
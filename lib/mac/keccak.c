@@ -17,9 +17,7 @@
 
 #include <kripto/cast.h>
 #include <kripto/memwipe.h>
-#include <kripto/hash.h>
-#include <kripto/hash/keccak1600.h>
-#include <kripto/hash/keccak800.h>
+#include <kripto/keccak.h>
 #include <kripto/mac.h>
 #include <kripto/desc/mac.h>
 #include <kripto/object/mac.h>
@@ -30,25 +28,33 @@
 struct kripto_mac
 {
 	struct kripto_mac_object obj;
-	kripto_hash *hash;
+	struct kripto_keccak1600 k1600; /* kripto_mac_keccak1600 */
+	struct kripto_keccak800 k800; /* kripto_mac_keccak800 */
 };
 
-static void keccak_input
+static void keccak_destroy(kripto_mac *s)
+{
+	kripto_memwipe(s, sizeof(kripto_mac));
+	free(s);
+}
+
+/* 1600 */
+static void keccak1600_input
 (
 	kripto_mac *s,
 	const void *in,
 	size_t len
-) 
+)
 {
-	kripto_hash_input(s->hash, in, len);
+	kripto_keccak1600_input(&s->k1600, in, len);
 }
 
-static void keccak_tag(kripto_mac *s, void *tag, unsigned int len)
+static void keccak1600_tag(kripto_mac *s, void *tag, unsigned int len)
 {
-	kripto_hash_output(s->hash, tag, len);
+	kripto_keccak1600_output(&s->k1600, tag, len);
 }
 
-static kripto_mac *keccak_recreate
+static kripto_mac *keccak1600_recreate
 (
 	kripto_mac *s,
 	unsigned int r,
@@ -57,9 +63,9 @@ static kripto_mac *keccak_recreate
 	unsigned int tag_len
 )
 {
-	(void)kripto_hash_recreate(s->hash, r, tag_len);
+	kripto_keccak1600_init(&s->k1600, r, 200 - (tag_len << 1));
 
-	kripto_hash_input(s->hash, key, key_len);
+	kripto_keccak1600_input(&s->k1600, key, key_len);
 
 	return s;
 }
@@ -82,14 +88,50 @@ static kripto_mac *keccak1600_create
 
 	s->obj.desc = kripto_mac_keccak1600;
 
-	s->hash = kripto_hash_create(kripto_hash_keccak1600, r, tag_len);
-	if(!s->hash)
-	{
-		free(s);
-		return 0;
-	}
+	return keccak1600_recreate(s, r, key, key_len, tag_len);
+}
+
+static const kripto_mac_desc keccak1600 =
+{
+	&keccak1600_create,
+	&keccak1600_recreate,
+	&keccak1600_input,
+	&keccak1600_tag,
+	&keccak_destroy,
+	99, /* max tag */
+	UINT_MAX /* max key */
+};
+
+const kripto_mac_desc *const kripto_mac_keccak1600 = &keccak1600;
+
+/* 800 */
+static void keccak800_input
+(
+	kripto_mac *s,
+	const void *in,
+	size_t len
+)
+{
+	kripto_keccak800_input(&s->k800, in, len);
+}
 
-	kripto_hash_input(s->hash, key, key_len);
+static void keccak800_tag(kripto_mac *s, void *tag, unsigned int len)
+{
+	kripto_keccak800_output(&s->k800, tag, len);
+}
+
+static kripto_mac *keccak800_recreate
+(
+	kripto_mac *s,
+	unsigned int r,
+	const void *key,
+	unsigned int key_len,
+	unsigned int tag_len
+)
+{
+	kripto_keccak800_init(&s->k800, r, 100 - (tag_len << 1));
+
+	kripto_keccak800_input(&s->k800, key, key_len);
 
 	return s;
 }
@@ -112,43 +154,15 @@ static kripto_mac *keccak800_create
 
 	s->obj.desc = kripto_mac_keccak800;
 
-	s->hash = kripto_hash_create(kripto_hash_keccak800, r, tag_len);
-	if(!s->hash)
-	{
-		free(s);
-		return 0;
-	}
-
-	kripto_hash_input(s->hash, key, key_len);
-
-	return s;
+	return keccak800_recreate(s, r, key, key_len, tag_len);
 }
 
-static void keccak_destroy(kripto_mac *s)
-{
-	kripto_hash_destroy(s->hash);
-	free(s);
-}
-
-static const kripto_mac_desc keccak1600 =
-{
-	&keccak1600_create,
-	&keccak_recreate,
-	&keccak_input,
-	&keccak_tag,
-	&keccak_destroy,
-	99, /* max tag */
-	UINT_MAX /* max key */
-};
-
-const kripto_mac_desc *const kripto_mac_keccak1600 = &keccak1600;
-
 static const kripto_mac_desc keccak800 =
 {
 	&keccak800_create,
-	&keccak_recreate,
-	&keccak_input,
-	&keccak_tag,
+	&keccak800_recreate,
+	&keccak800_input,
+	&keccak800_tag,
 	&keccak_destroy,
 	49, /* max tag */
 	UINT_MAX /* max key */
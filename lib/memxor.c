@@ -0,0 +1,48 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <kripto/memxor.h>
+
+/* a word at a time */
+void kripto_memxor
+(
+	const void *a,
+	const void *b,
+	void *out,
+	size_t len
+)
+{
+	const uint8_t *x = a;
+	const uint8_t *y = b;
+	uint8_t *z = out;
+	uint64_t t;
+	uint64_t u;
+
+	for(; len >= 8; len -= 8)
+	{
+		memcpy(&t, x, 8);
+		memcpy(&u, y, 8);
+		t ^= u;
+		memcpy(z, &t, 8);
+
+		x += 8;
+		y += 8;
+		z += 8;
+	}
+
+	while(len--) *z++ = *x++ ^ *y++;
+}
@@ -18,10 +18,136 @@
 
 #include <kripto/cast.h>
 #include <kripto/memwipe.h>
+#include <kripto/hash.h>
 #include <kripto/mac.h>
+#include <kripto/mac/hmac.h>
 
 #include <kripto/pbkdf2.h>
 
+/* tag = HMAC(h), from a copy of the keyed outer state */
+static void hmac_tag
+(
+	kripto_hash *h,
+	const kripto_hash *outer,
+	uint8_t *tag,
+	unsigned int len
+)
+{
+	kripto_hash_output(h, tag, len);
+
+	kripto_hash_copy(h, outer);
+	kripto_hash_input(h, tag, len);
+	kripto_hash_output(h, tag, len);
+}
+
+/*
+ * Same as the generic loop with kripto_mac_hmac(), but the pass is
+ * padded and hashed into the inner and outer states once, and every
+ * tag then costs only the compressions of its own message.
+ */
+static int pbkdf2_hmac
+(
+	const kripto_hash_desc *hash,
+	unsigned int r,
+	unsigned int iter,
+	const void *pass,
+	unsigned int pass_len,
+	const void *salt,
+	unsigned int salt_len,
+	void *out,
+	size_t out_len
+)
+{
+	unsigned int i;
+	unsigned int x;
+	unsigned int y;
+	unsigned int bs;
+	uint8_t ctr[4] = {0, 0, 0, 0};
+	uint8_t *buf0;
+	uint8_t *buf1;
+	uint8_t *pad;
+	kripto_hash *h[3] = {0, 0, 0};
+
+	x = kripto_hash_maxout(hash);
+	if(out_len < x) x = out_len;
+
+	bs = kripto_hash_blocksize(hash);
+
+	buf0 = malloc((x << 1) + bs);
+	if(!buf0) return -1;
+
+	buf1 = buf0 + x;
+	pad = buf1 + x;
+
+	/* h[0] works, h[1] is inner and h[2] outer */
+	for(i = 0; i < 3; i++)
+	{
+		h[i] = kripto_hash_create(hash, r, x);
+		if(!h[i]) goto err;
+	}
+
+	if(pass_len > bs)
+	{
+		if(kripto_hash_all(hash, r, pass, pass_len, pad, x)) goto err;
+		i = x;
+	}
+	else
+	{
+		memcpy(pad, pass, pass_len);
+		i = pass_len;
+	}
+
+	memset(pad + i, 0, bs - i);
+
+	for(i = 0; i < bs; i++) pad[i] ^= 0x36;
+	kripto_hash_input(h[1], pad, bs);
+
+	for(i = 0; i < bs; i++) pad[i] ^= 0x6A; /* 0x5C ^ 0x36 */
+	kripto_hash_input(h[2], pad, bs);
+
+	for(;;)
+	{
+		for(i = 3; !++ctr[i]; i--)
+			assert(i);
+
+		kripto_hash_copy(h[0], h[1]);
+		kripto_hash_input(h[0], salt, salt_len);
+		kripto_hash_input(h[0], ctr, 4);
+		hmac_tag(h[0], h[2], buf0, x);
+
+		memcpy(buf1, buf0, x);
+
+		for(i = 1; i < iter; i++)
+		{
+			kripto_hash_copy(h[0], h[1]);
+			kripto_hash_input(h[0], buf0, x);
+			hmac_tag(h[0], h[2], buf0, x);
+
+			for(y = 0; y < x; y++)
+				buf1[y] ^= buf0[y];
+		}
+
+		/* output */
+		for(y = 0; y < x && out_len; y++, out_len--, out = U8(out) + 1)
+			*U8(out) = buf1[y];
+
+		if(!out_len) break;
+	}
+
+	for(i = 0; i < 3; i++) kripto_hash_destroy(h[i]);
+	kripto_memwipe(buf0, (x << 1) + bs);
+	free(buf0);
+
+	return 0;
+
+err:
+	for(i = 0; i < 3; i++) if(h[i]) kripto_hash_destroy(h[i]);
+	kripto_memwipe(buf0, (x << 1) + bs);
+	free(buf0);
+
+	return -1;
+}
+
 int kripto_pbkdf2
 (
 	const kripto_mac_desc *mac,
@@ -46,6 +172,22 @@ int kripto_pbkdf2
 	assert(mac);
 	assert(iter);
 
+	if(kripto_mac_hmac_hash(mac))
+	{
+		return pbkdf2_hmac
+		(
+			kripto_mac_hmac_hash(mac),
+			mac_rounds,
+			iter,
+			pass,
+			pass_len,
+			salt,
+			salt_len,
+			out,
+			out_len
+		);
+	}
+
 	x = kripto_mac_maxtag(mac);
 	if(out_len < x) x = out_len;
 
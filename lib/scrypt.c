@@ -11,6 +11,11 @@
  * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
  */
 
+#ifdef KRIPTO_UNIX
+#define _DEFAULT_SOURCE /* MAP_ANONYMOUS */
+#include <sys/mman.h>
+#endif
+
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,11 +25,22 @@
 #include <kripto/cast.h>
 #include <kripto/loadstore.h>
 #include <kripto/rotate.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
+#include <kripto/thread.h>
 #include <kripto/mac.h>
 #include <kripto/pbkdf2.h>
 
 #include <kripto/scrypt.h>
 
+#if defined(MAP_ANONYMOUS) && defined(MAP_FAILED)
+#define KRIPTO_SCRYPT_MMAP
+#endif
+
+#ifndef KRIPTO_SCRYPT_HUGEPAGE_SIZE
+#define KRIPTO_SCRYPT_HUGEPAGE_SIZE 2097152 /* 2MB */
+#endif
+
 #define QR(A, B, C, D)		\
 {							\
 	B ^= ROL32_07(A + D);	\
@@ -33,24 +49,30 @@
 	A ^= ROL32_18(D + C);	\
 }
 
+/*
+ * Blocks are kept with their words in the order
+ * 0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11
+ * so every row of four holds one diagonal of the Salsa20 state.
+ */
+
 static void salsa20_core(uint32_t *x)
 {
 	uint32_t x0 = x[0];
-	uint32_t x1 = x[1];
-	uint32_t x2 = x[2];
-	uint32_t x3 = x[3];
+	uint32_t x1 = x[13];
+	uint32_t x2 = x[10];
+	uint32_t x3 = x[7];
 	uint32_t x4 = x[4];
-	uint32_t x5 = x[5];
-	uint32_t x6 = x[6];
-	uint32_t x7 = x[7];
+	uint32_t x5 = x[1];
+	uint32_t x6 = x[14];
+	uint32_t x7 = x[11];
 	uint32_t x8 = x[8];
-	uint32_t x9 = x[9];
-	uint32_t x10 = x[10];
-	uint32_t x11 = x[11];
+	uint32_t x9 = x[5];
+	uint32_t x10 = x[2];
+	uint32_t x11 = x[15];
 	uint32_t x12 = x[12];
-	uint32_t x13 = x[13];
-	uint32_t x14 = x[14];
-	uint32_t x15 = x[15];
+	uint32_t x13 = x[9];
+	uint32_t x14 = x[6];
+	uint32_t x15 = x[3];
 
 	/* columnround 1 */
 	QR(x0, x4, x8, x12);
@@ -101,107 +123,365 @@ static void salsa20_core(uint32_t *x)
 	QR(x15, x12, x13, x14);
 
 	x[0] += x0;
-	x[1] += x1;
-	x[2] += x2;
-	x[3] += x3;
+	x[13] += x1;
+	x[10] += x2;
+	x[7] += x3;
 	x[4] += x4;
-	x[5] += x5;
-	x[6] += x6;
-	x[7] += x7;
+	x[1] += x5;
+	x[14] += x6;
+	x[11] += x7;
 	x[8] += x8;
-	x[9] += x9;
-	x[10] += x10;
-	x[11] += x11;
+	x[5] += x9;
+	x[2] += x10;
+	x[15] += x11;
 	x[12] += x12;
-	x[13] += x13;
-	x[14] += x14;
-	x[15] += x15;
+	x[9] += x13;
+	x[6] += x14;
+	x[3] += x15;
 }
 
-static void blockmix(uint32_t *b, uint32_t *t, const size_t r)
+/* out = BlockMix(b ^ v), v may be 0 */
+static void blockmix
+(
+	const uint32_t *b,
+	const uint32_t *v,
+	uint32_t *out,
+	const size_t r
+)
 {
 	uint32_t x[16];
 	size_t i;
+	unsigned int j;
 
 	memcpy(x, b + (r << 5) - 16, 64);
 
-	for(i = 0; i < (r << 5);)
+	if(v)
 	{
-		x[0] ^= b[i++];
-		x[1] ^= b[i++];
-		x[2] ^= b[i++];
-		x[3] ^= b[i++];
-		x[4] ^= b[i++];
-		x[5] ^= b[i++];
-		x[6] ^= b[i++];
-		x[7] ^= b[i++];
-		x[8] ^= b[i++];
-		x[9] ^= b[i++];
-		x[10] ^= b[i++];
-		x[11] ^= b[i++];
-		x[12] ^= b[i++];
-		x[13] ^= b[i++];
-		x[14] ^= b[i++];
-		x[15] ^= b[i++];
+		for(j = 0; j < 16; j++)
+			x[j] ^= v[(r << 5) - 16 + j];
+	}
+
+	for(i = 0; i < (r << 1); i++)
+	{
+		for(j = 0; j < 16; j++)
+			x[j] ^= b[(i << 4) + j];
+
+		if(v)
+		{
+			for(j = 0; j < 16; j++)
+				x[j] ^= v[(i << 4) + j];
+		}
 
 		salsa20_core(x);
-		memcpy(t + i - 16, x, 64);
+
+		/* even blocks to the first half, odd to the second */
+		memcpy(out + (((i >> 1) + (i & 1) * r) << 4), x, 64);
 	}
 
-	for(i = 0; i < r; i++)
-	{
-		memcpy(b + (i << 4), t + (i << 5), 64);
-		memcpy(b + ((i + r) << 4), t + (i << 5) + 16, 64);
-	}	
+	kripto_memwipe(x, 64);
 }
 
+#ifdef KRIPTO_X86_SIMD
+
+#define SSE2_ROL(X, N)												\
+	_mm_or_si128(_mm_slli_epi32(X, N), _mm_srli_epi32(X, 32 - (N)))
+
+#define SSE2_QR(A, B, C, D)											\
+{																	\
+	B = _mm_xor_si128(B, SSE2_ROL(_mm_add_epi32(A, D), 7));			\
+	C = _mm_xor_si128(C, SSE2_ROL(_mm_add_epi32(B, A), 9));			\
+	D = _mm_xor_si128(D, SSE2_ROL(_mm_add_epi32(C, B), 13));		\
+	A = _mm_xor_si128(A, SSE2_ROL(_mm_add_epi32(D, C), 18));		\
+}
+
+/* column round, then row round with rows 1...3 rotated into place */
+#define SSE2_DOUBLEROUND(X0, X1, X2, X3)							\
+{																	\
+	SSE2_QR(X0, X1, X2, X3);										\
+	X1 = _mm_shuffle_epi32(X1, 0x93);								\
+	X2 = _mm_shuffle_epi32(X2, 0x4E);								\
+	X3 = _mm_shuffle_epi32(X3, 0x39);								\
+	SSE2_QR(X0, X3, X2, X1);										\
+	X1 = _mm_shuffle_epi32(X1, 0x39);								\
+	X2 = _mm_shuffle_epi32(X2, 0x4E);								\
+	X3 = _mm_shuffle_epi32(X3, 0x93);								\
+}
+
+/*
+ * Same code for every instruction set, VEX encoding alone makes
+ * the AVX2 one faster. One BlockMix is a chain of dependent Salsa20/8
+ * cores, so there is nothing to put in wider vectors.
+ */
+#define BLOCKMIX_SIMD(NAME)											\
+static void NAME													\
+(																	\
+	const uint32_t *b,												\
+	const uint32_t *v,												\
+	uint32_t *out,													\
+	const size_t r													\
+)																	\
+{																	\
+	__m128i x0;														\
+	__m128i x1;														\
+	__m128i x2;														\
+	__m128i x3;														\
+	__m128i y0;														\
+	__m128i y1;														\
+	__m128i y2;														\
+	__m128i y3;														\
+	const uint32_t *p;												\
+	uint32_t *o;													\
+	size_t i;														\
+																	\
+	p = b + (r << 5) - 16;											\
+	x0 = LOADU(p);													\
+	x1 = LOADU(p + 4);												\
+	x2 = LOADU(p + 8);												\
+	x3 = LOADU(p + 12);												\
+																	\
+	if(v)															\
+	{																\
+		p = v + (r << 5) - 16;										\
+		x0 = _mm_xor_si128(x0, LOADU(p));							\
+		x1 = _mm_xor_si128(x1, LOADU(p + 4));						\
+		x2 = _mm_xor_si128(x2, LOADU(p + 8));						\
+		x3 = _mm_xor_si128(x3, LOADU(p + 12));						\
+	}																\
+																	\
+	for(i = 0; i < (r << 1); i++)									\
+	{																\
+		p = b + (i << 4);											\
+		x0 = _mm_xor_si128(x0, LOADU(p));							\
+		x1 = _mm_xor_si128(x1, LOADU(p + 4));						\
+		x2 = _mm_xor_si128(x2, LOADU(p + 8));						\
+		x3 = _mm_xor_si128(x3, LOADU(p + 12));						\
+																	\
+		if(v)														\
+		{															\
+			p = v + (i << 4);										\
+			x0 = _mm_xor_si128(x0, LOADU(p));						\
+			x1 = _mm_xor_si128(x1, LOADU(p + 4));					\
+			x2 = _mm_xor_si128(x2, LOADU(p + 8));					\
+			x3 = _mm_xor_si128(x3, LOADU(p + 12));					\
+		}															\
+																	\
+		y0 = x0;													\
+		y1 = x1;													\
+		y2 = x2;													\
+		y3 = x3;													\
+																	\
+		SSE2_DOUBLEROUND(y0, y1, y2, y3);							\
+		SSE2_DOUBLEROUND(y0, y1, y2, y3);							\
+		SSE2_DOUBLEROUND(y0, y1, y2, y3);							\
+		SSE2_DOUBLEROUND(y0, y1, y2, y3);							\
+																	\
+		x0 = _mm_add_epi32(x0, y0);									\
+		x1 = _mm_add_epi32(x1, y1);									\
+		x2 = _mm_add_epi32(x2, y2);									\
+		x3 = _mm_add_epi32(x3, y3);									\
+																	\
+		o = out + (((i >> 1) + (i & 1) * r) << 4);					\
+		STOREU(o, x0);												\
+		STOREU(o + 4, x1);											\
+		STOREU(o + 8, x2);											\
+		STOREU(o + 12, x3);											\
+	}																\
+}
+
+KRIPTO_TARGET("sse2")
+BLOCKMIX_SIMD(blockmix_sse2)
+
+KRIPTO_TARGET("avx2")
+BLOCKMIX_SIMD(blockmix_avx2)
+
+#endif
+
 static void smix
 (
 	uint8_t *b,
 	const size_t r,
 	uint64_t n,
-	uint32_t *t0,
-	uint32_t *t1,
-	uint32_t *t2
+	uint32_t *v,
+	uint32_t *x,
+	uint32_t *y
 )
 {
+	void (*mix)(const uint32_t *, const uint32_t *, uint32_t *, size_t);
+	uint32_t *t;
 	uint64_t i;
-	uint64_t tn;
 	uint64_t j;
 
-	for(i = 0; i < (r << 5); i++)
-		t1[i] = LOAD32L(b + (i << 2));
+	mix = &blockmix;
 
-	for(i = 0; i < n; i++)
+	#ifdef KRIPTO_X86_SIMD
+	if(kripto_cpu() & KRIPTO_CPU_AVX2) mix = &blockmix_avx2;
+	else if(kripto_cpu() & KRIPTO_CPU_SSE2) mix = &blockmix_sse2;
+	#endif
+
+	for(i = 0; i < (r << 5); i++)
 	{
-		memcpy(t0 + (r << 5) * i, t1, r << 7);
-		blockmix(t1, t2, r);
+		x[i] = LOAD32L(b + ((i & ~(uint64_t)15) << 2)
+			+ ((i * 5 & 15) << 2));
 	}
 
+	/* V[i] = X, X = BlockMix(X), without copying X */
+	memcpy(v, x, r << 7);
+
+	for(i = 1; i < n; i++)
+		mix(v + (r << 5) * (i - 1), 0, v + (r << 5) * i, r);
+
+	mix(v + (r << 5) * (n - 1), 0, x, r);
+
+	/* X and Y take turns holding the state */
 	for(i = 0; i < n; i++)
 	{
-		/* integrify */
-		tn = (((uint64_t)t1[(r << 5) - 15] << 32)
-			| t1[(r << 5) - 16])
+		/* integrify, words 0 and 1 of the last block */
+		j = (((uint64_t)x[(r << 5) - 3] << 32)
+			| x[(r << 5) - 16])
 			& (n - 1);
 
-		for(j = 0; j < (r << 5); j++)
-			t1[j] ^= t0[(r << 5) * tn + j];
+		mix(x, v + (r << 5) * j, y, r);
 
-		blockmix(t1, t2, r);
+		t = x;
+		x = y;
+		y = t;
 	}
 
 	for(i = 0; i < (r << 5); i++)
-		STORE32L(t1[i], b + (i << 2));
+	{
+		STORE32L(x[i], b + ((i & ~(uint64_t)15) << 2)
+			+ ((i * 5 & 15) << 2));
+	}
 }
 
-int kripto_scrypt
+struct kripto_scrypt_ctx
+{
+	uint8_t *b;
+	size_t len;
+	size_t map;
+	uint64_t n;
+	size_t r;
+	uint32_t p;
+	unsigned int threads;
+};
+
+/* lanes of part i, with V, X and Y of their own */
+static void smix_job(void *arg, unsigned int i)
+{
+	const kripto_scrypt_ctx *ctx = arg;
+	const size_t start = kripto_thread_part(ctx->p, ctx->threads, i);
+	const size_t end = kripto_thread_part(ctx->p, ctx->threads, i + 1);
+	uint32_t *v;
+	size_t k;
+
+	v = (uint32_t *)(ctx->b + (ctx->r << 7) * ctx->p)
+		+ ((ctx->r << 5) * ctx->n + (ctx->r << 6)) * i;
+
+	for(k = start; k < end; k++)
+	{
+		smix
+		(
+			ctx->b + (ctx->r << 7) * k,
+			ctx->r,
+			ctx->n,
+			v,
+			v + (ctx->r << 5) * ctx->n,
+			v + (ctx->r << 5) * (ctx->n + 1)
+		);
+	}
+}
+
+kripto_scrypt_ctx *kripto_scrypt_ctx_create
 (
-	const kripto_mac_desc *mac,
-	unsigned int mac_rounds,
 	uint64_t n,
 	uint32_t r,
 	uint32_t p,
+	unsigned int threads,
+	unsigned int flags
+)
+{
+	kripto_scrypt_ctx *ctx;
+
+	/* n must be a power of 2, r and p at least 1 */
+	if(!n || (n & (n - 1)) || !r || !p) return 0;
+
+	#ifndef KRIPTO_THREADS
+	threads = 1;
+	#endif
+
+	if(threads > p) threads = p;
+	if(!threads) threads = 1;
+
+	ctx = malloc(sizeof(kripto_scrypt_ctx));
+	if(!ctx) return 0;
+
+	ctx->n = n;
+	ctx->r = r;
+	ctx->p = p;
+	ctx->threads = threads;
+	ctx->len = (ctx->r << 7) * p
+		+ ((ctx->r << 7) * n + (ctx->r << 8)) * threads;
+	ctx->map = 0;
+
+	#ifdef KRIPTO_SCRYPT_MMAP
+	if(flags & KRIPTO_SCRYPT_HUGEPAGES)
+	{
+		ctx->map = (ctx->len + KRIPTO_SCRYPT_HUGEPAGE_SIZE - 1)
+			& ~(size_t)(KRIPTO_SCRYPT_HUGEPAGE_SIZE - 1);
+
+		#ifdef MAP_HUGETLB
+		ctx->b = mmap
+		(
+			0,
+			ctx->map,
+			PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+			-1,
+			0
+		);
+		if(ctx->b != MAP_FAILED) return ctx;
+		#endif
+
+		/* no reserved huge pages, ask for transparent ones */
+		ctx->b = mmap
+		(
+			0,
+			ctx->map,
+			PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS,
+			-1,
+			0
+		);
+		if(ctx->b != MAP_FAILED)
+		{
+			#ifdef MADV_HUGEPAGE
+			(void)madvise(ctx->b, ctx->map, MADV_HUGEPAGE);
+			#endif
+
+			return ctx;
+		}
+
+		ctx->map = 0;
+	}
+	#else
+	(void)flags;
+	#endif
+
+	ctx->b = malloc(ctx->len);
+	if(!ctx->b)
+	{
+		free(ctx);
+		return 0;
+	}
+
+	return ctx;
+}
+
+int kripto_scrypt_ctx_run
+(
+	kripto_scrypt_ctx *ctx,
+	const kripto_mac_desc *mac,
+	unsigned int mac_rounds,
 	const void *pass,
 	unsigned int pass_len,
 	const void *salt,
@@ -210,19 +490,6 @@ int kripto_scrypt
 	size_t out_len
 )
 {
-	uint8_t *b;
-	uint32_t *t0;
-	uint32_t *t1;
-	uint32_t *t2;
-	uint32_t i;
-
-	b = malloc((r << 7) * p + (r << 7) * n + (r << 8));
-	if(!b) return -1;
-
-	t0 = (uint32_t *)(b + (r << 7) * p);
-	t1 = t0 + (r << 5);
-	t2 = t1 + (r << 5);
-
 	if(kripto_pbkdf2
 	(
 		mac,
@@ -232,12 +499,11 @@ int kripto_scrypt
 		pass_len,
 		salt,
 		salt_len,
-		b,
-		p * (r << 7)
+		ctx->b,
+		(ctx->r << 7) * ctx->p
 	)) goto err;
 
-	for(i = 0; i < p; i++)
-		smix(b + (r << 7) * i, r, n, t0, t1, t2);
+	kripto_thread_run(&smix_job, ctx, ctx->threads);
 
 	if(kripto_pbkdf2
 	(
@@ -246,20 +512,102 @@ int kripto_scrypt
 		1,
 		pass,
 		pass_len,
-		b,
-		p * (r << 7),
+		ctx->b,
+		(ctx->r << 7) * ctx->p,
 		out,
 		out_len
 	)) goto err;
 
-	kripto_memwipe(b, (r << 7) * p + (r << 7) * n + (r << 8));
-	free(b);
+	kripto_memwipe(ctx->b, ctx->len);
 
 	return 0;
 
 err:
-	kripto_memwipe(b, (r << 7) * p + (r << 7) * n + (r << 8));
-	free(b);
+	kripto_memwipe(ctx->b, ctx->len);
 
 	return -1;
 }
+
+void kripto_scrypt_ctx_destroy(kripto_scrypt_ctx *ctx)
+{
+	#ifdef KRIPTO_SCRYPT_MMAP
+	if(ctx->map) (void)munmap(ctx->b, ctx->map);
+	else free(ctx->b);
+	#else
+	free(ctx->b);
+	#endif
+
+	free(ctx);
+}
+
+int kripto_scrypt_ex
+(
+	const kripto_mac_desc *mac,
+	unsigned int mac_rounds,
+	uint64_t n,
+	uint32_t r,
+	uint32_t p,
+	unsigned int threads,
+	const void *pass,
+	unsigned int pass_len,
+	const void *salt,
+	unsigned int salt_len,
+	void *out,
+	size_t out_len
+)
+{
+	kripto_scrypt_ctx *ctx;
+	int ret;
+
+	ctx = kripto_scrypt_ctx_create(n, r, p, threads, 0);
+	if(!ctx) return -1;
+
+	ret = kripto_scrypt_ctx_run
+	(
+		ctx,
+		mac,
+		mac_rounds,
+		pass,
+		pass_len,
+		salt,
+		salt_len,
+		out,
+		out_len
+	);
+
+	kripto_scrypt_ctx_destroy(ctx);
+
+	return ret;
+}
+
+int kripto_scrypt
+(
+	const kripto_mac_desc *mac,
+	unsigned int mac_rounds,
+	uint64_t n,
+	uint32_t r,
+	uint32_t p,
+	const void *pass,
+	unsigned int pass_len,
+	const void *salt,
+	unsigned int salt_len,
+	void *out,
+	size_t out_len
+)
+{
+	return kripto_scrypt_ex
+	(
+		mac,
+		mac_rounds,
+		n,
+		r,
+		p,
+		1,
+		pass,
+		pass_len,
+		salt,
+		salt_len,
+		out,
+		out_len
+	);
+}
@@ -100,6 +100,46 @@ void kripto_stream_decrypt
 	s->desc->decrypt(s, ct, pt, len);
 }
 
+void kripto_stream_encrypt_parallel
+(
+	kripto_stream *s,
+	const void *pt,
+	void *ct,
+	size_t len,
+	unsigned int threads
+)
+{
+	assert(s);
+	assert(s->desc);
+	assert(s->desc->encrypt);
+	assert(len % kripto_stream_multof(s) == 0);
+
+	if(s->desc->encrypt_parallel && threads > 1)
+		s->desc->encrypt_parallel(s, pt, ct, len, threads);
+	else
+		s->desc->encrypt(s, pt, ct, len);
+}
+
+void kripto_stream_decrypt_parallel
+(
+	kripto_stream *s,
+	const void *ct,
+	void *pt,
+	size_t len,
+	unsigned int threads
+)
+{
+	assert(s);
+	assert(s->desc);
+	assert(s->desc->decrypt);
+	assert(len % kripto_stream_multof(s) == 0);
+
+	if(s->desc->decrypt_parallel && threads > 1)
+		s->desc->decrypt_parallel(s, ct, pt, len, threads);
+	else
+		s->desc->decrypt(s, ct, pt, len);
+}
+
 void kripto_stream_prng
 (
 	kripto_stream *s,
@@ -114,6 +154,15 @@ void kripto_stream_prng
 	s->desc->prng(s, out, len);
 }
 
+void kripto_stream_seek(kripto_stream *s, uint64_t offset)
+{
+	assert(s);
+	assert(s->desc);
+	assert(s->desc->seek);
+
+	s->desc->seek(s, offset);
+}
+
 void kripto_stream_destroy(kripto_stream *s)
 {
 	assert(s);
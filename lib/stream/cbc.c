@@ -14,9 +14,12 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
+#include <assert.h>
 
 #include <kripto/cast.h>
 #include <kripto/memwipe.h>
+#include <kripto/memxor.h>
+#include <kripto/thread.h>
 #include <kripto/block.h>
 #include <kripto/stream.h>
 #include <kripto/desc/stream.h>
@@ -24,12 +27,19 @@
 
 #include <kripto/stream/cbc.h>
 
+/* ciphertext blocks decrypted per block cipher call */
+#define CBC_BLOCKS 16
+
+/* IV + last ciphertext block + decrypted blocks */
+#define CBC_SIZE(BS) ((BS) * (CBC_BLOCKS + 2))
+
 struct kripto_stream
 {
 	struct kripto_stream_object obj;
 	kripto_block *block;
 	unsigned int blocksize;
 	uint8_t *iv;
+	uint8_t *last;
 	uint8_t *buf;
 };
 
@@ -67,31 +77,161 @@ static void cbc_decrypt
 	size_t len
 )
 {
-	size_t i;
-	unsigned int n;
+	size_t n;
+	unsigned int i;
 
-	for(i = 0; i < len; i += n)
+	for(; len; len -= n)
 	{
-		for(n = 0; n < s->blocksize; n++)
-			s->buf[n] = CU8(ct)[n];
+		n = len;
+		if(n > CBC_BLOCKS * s->blocksize) n = CBC_BLOCKS * s->blocksize;
 
-		kripto_block_decrypt(s->block, ct, pt);
+		kripto_block_decrypt_blocks(s->block, ct, s->buf, n / s->blocksize);
 
-		for(n = 0; n < s->blocksize; n++)
+		/* next IV, before it can be overwritten (in place) */
+		memcpy(s->last, CU8(ct) + n - s->blocksize, s->blocksize);
+
+		/* backwards, so every block is chained with ciphertext
+		that was not yet overwritten */
+		for(i = n - s->blocksize; i; i -= s->blocksize)
 		{
-			U8(pt)[n] ^=  s->iv[n];
-			s->iv[n] = s->buf[n];
+			kripto_memxor(s->buf + i, CU8(ct) + i - s->blocksize,
+				U8(pt) + i, s->blocksize);
 		}
 
+		kripto_memxor(s->buf, s->iv, pt, s->blocksize);
+		memcpy(s->iv, s->last, s->blocksize);
+
 		ct = CU8(ct) + n;
 		pt = U8(pt) + n;
 	}
 }
 
+/*
+ * Every lane is its own CBC chain, but one block from each is encrypted
+ * in a single multi-block call, so the cipher has independent blocks to
+ * work on. Lanes are processed CBC_BLOCKS at a time.
+ */
+void kripto_stream_cbc_encrypt_multi
+(
+	kripto_stream **s,
+	const void *const *pt,
+	void *const *ct,
+	const size_t *len,
+	unsigned int lanes
+)
+{
+	size_t pos[CBC_BLOCKS];
+	unsigned int lane[CBC_BLOCKS];
+	unsigned int i;
+	unsigned int j;
+	unsigned int k;
+	unsigned int n;
+
+	for(i = 0; i < lanes; i++)
+	{
+		assert(s[i]);
+		assert(s[i]->obj.desc->encrypt == &cbc_encrypt);
+		assert(s[i]->blocksize == s[0]->blocksize);
+		assert(len[i] % s[i]->blocksize == 0);
+	}
+
+	for(i = 0; i < lanes; i += n)
+	{
+		n = lanes - i;
+		if(n > CBC_BLOCKS) n = CBC_BLOCKS;
+
+		for(j = 0; j < n; j++) pos[j] = 0;
+
+		for(;;)
+		{
+			/* next block of every lane with data left */
+			for(j = 0, k = 0; j < n; j++)
+			{
+				if(pos[j] == len[i + j]) continue;
+
+				kripto_memxor(CU8(pt[i + j]) + pos[j], s[i + j]->iv,
+					s[0]->buf + k * s[0]->blocksize, s[0]->blocksize);
+
+				lane[k++] = j;
+			}
+
+			if(!k) break;
+
+			kripto_block_encrypt_blocks(s[0]->block, s[0]->buf, s[0]->buf, k);
+
+			for(j = 0; j < k; j++)
+			{
+				memcpy(s[i + lane[j]]->iv, s[0]->buf + j * s[0]->blocksize,
+					s[0]->blocksize);
+				memcpy(U8(ct[i + lane[j]]) + pos[lane[j]],
+					s[0]->buf + j * s[0]->blocksize, s[0]->blocksize);
+
+				pos[lane[j]] += s[0]->blocksize;
+			}
+		}
+	}
+}
+
+static void cbc_decrypt_job(void *arg, unsigned int i)
+{
+	const struct kripto_thread_blocks *job = arg;
+	const size_t start = kripto_thread_part(job->blocks, job->n, i);
+	const size_t end = kripto_thread_part(job->blocks, job->n, i + 1);
+	const kripto_stream *s = job->s;
+	kripto_stream w = *s;
+
+	w.iv = job->mem + i * job->size;
+	w.last = w.iv + w.blocksize;
+	w.buf = w.last + w.blocksize;
+
+	cbc_decrypt
+	(
+		&w,
+		job->in + start * w.blocksize,
+		job->out + start * w.blocksize,
+		(end - start) * w.blocksize
+	);
+}
+
+static void cbc_decrypt_parallel
+(
+	kripto_stream *s,
+	const void *ct,
+	void *pt,
+	size_t len,
+	unsigned int threads
+)
+{
+	struct kripto_thread_blocks job;
+
+	if(kripto_thread_blocks_init
+	(
+		&job,
+		s,
+		ct,
+		pt,
+		len,
+		s->blocksize,
+		CBC_SIZE(s->blocksize),
+		threads
+	)) goto serial;
+
+	/* IV of each part is the ciphertext block before it */
+	kripto_thread_blocks_chain(&job, s->iv, s->blocksize);
+	memcpy(s->iv, job.in + len - s->blocksize, s->blocksize);
+
+	kripto_thread_blocks_run(&job, &cbc_decrypt_job);
+
+	return;
+
+serial:
+	cbc_decrypt(s, ct, pt, len);
+}
+
 static void cbc_destroy(kripto_stream *s)
 {
 	kripto_block_destroy(s->block);
-	kripto_memwipe(s, sizeof(kripto_stream) + (s->blocksize << 1));
+	kripto_memwipe(s, sizeof(kripto_stream) + CBC_SIZE(s->blocksize));
 	free(s);
 }
 
@@ -115,22 +255,23 @@ static kripto_stream *cbc_create
 {
 	kripto_stream *s;
 
-	s = malloc(sizeof(kripto_stream) + (desc->maxiv << 1));
+	s = malloc(sizeof(kripto_stream) + CBC_SIZE(desc->maxiv));
 	if(!s) return 0;
 
+	s->blocksize = desc->maxiv;
+
 	s->obj.desc = desc;
 	s->obj.multof = s->blocksize;
 
-	s->blocksize = desc->maxiv;
-
 	s->iv = (uint8_t *)s + sizeof(kripto_stream);
-	s->buf = s->iv + s->blocksize;
+	s->last = s->iv + s->blocksize;
+	s->buf = s->last + s->blocksize;
 
 	/* block cipher */
 	s->block = kripto_block_create(EXT(desc)->block, rounds, key, key_len);
 	if(!s->block)
 	{
-		kripto_memwipe(s, sizeof(kripto_stream) + (s->blocksize << 1));
+		kripto_memwipe(s, sizeof(kripto_stream) + CBC_SIZE(s->blocksize));
 		free(s);
 		return 0;
 	}
@@ -156,7 +297,7 @@ static kripto_stream *cbc_recreate
 	s->block = kripto_block_recreate(s->block, rounds, key, key_len);
 	if(!s->block)
 	{
-		kripto_memwipe(s, sizeof(kripto_stream) + (s->blocksize << 1));
+		kripto_memwipe(s, sizeof(kripto_stream) + CBC_SIZE(s->blocksize));
 		free(s);
 		return 0;
 	}
@@ -181,7 +322,10 @@ kripto_stream_desc *kripto_stream_cbc(const kripto_block_desc *block)
 	s->desc.recreate = &cbc_recreate;
 	s->desc.encrypt = &cbc_encrypt;
 	s->desc.decrypt = &cbc_decrypt;
+	s->desc.encrypt_parallel = 0;
+	s->desc.decrypt_parallel = &cbc_decrypt_parallel;
 	s->desc.prng = 0;
+	s->desc.seek = 0;
 	s->desc.destroy = &cbc_destroy;
 	s->desc.maxkey = kripto_block_maxkey(block);
 	s->desc.maxiv = kripto_block_size(block);
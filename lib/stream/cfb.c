@@ -17,6 +17,8 @@
 
 #include <kripto/cast.h>
 #include <kripto/memwipe.h>
+#include <kripto/memxor.h>
+#include <kripto/thread.h>
 #include <kripto/block.h>
 #include <kripto/stream.h>
 #include <kripto/desc/stream.h>
@@ -24,11 +26,18 @@
 
 #include <kripto/stream/cfb.h>
 
+/* ciphertext blocks encrypted per block cipher call */
+#define CFB_BLOCKS 16
+
+/* feedback + keystream blocks */
+#define CFB_SIZE(BS) ((BS) * (CFB_BLOCKS + 1))
+
 struct kripto_stream
 {
 	struct kripto_stream_object obj;
 	kripto_block *block;
 	uint8_t *prev;
+	uint8_t *buf;
 	unsigned int blocksize;
 	unsigned int used;
 };
@@ -64,20 +73,119 @@ static void cfb_decrypt
 )
 {
 	size_t i;
+	size_t n;
+	uint8_t t;
 
-	for(i = 0; i < len; i++)
+	/* finish partial block */
+	for(i = 0; i < len && s->used < s->blocksize; i++)
+	{
+		t = CU8(ct)[i];
+		U8(pt)[i] = s->prev[s->used] ^ t;
+		s->prev[s->used++] = t;
+	}
+
+	/* full blocks, keystream is previous ciphertext encrypted */
+	for(; len - i >= s->blocksize; i += n)
+	{
+		n = (len - i) / s->blocksize;
+		if(n > CFB_BLOCKS) n = CFB_BLOCKS;
+
+		kripto_block_encrypt(s->block, s->prev, s->buf);
+		kripto_block_encrypt_blocks(s->block, CU8(ct) + i,
+			s->buf + s->blocksize, n - 1);
+
+		n *= s->blocksize;
+		memcpy(s->prev, CU8(ct) + i + n - s->blocksize, s->blocksize);
+
+		kripto_memxor(CU8(ct) + i, s->buf, U8(pt) + i, n);
+	}
+
+	for(; i < len; i++)
 	{
 		if(s->used == s->blocksize)
 		{
-			kripto_block_encrypt(s->block, s->prev, pt);
+			kripto_block_encrypt(s->block, s->prev, s->prev);
 			s->used = 0;
 		}
 
-		U8(pt)[i] ^= CU8(ct)[i];
-		s->prev[s->used++] = CU8(ct)[i];
+		t = CU8(ct)[i];
+		U8(pt)[i] = s->prev[s->used] ^ t;
+		s->prev[s->used++] = t;
 	}
 }
 
+static void cfb_decrypt_job(void *arg, unsigned int i)
+{
+	const struct kripto_thread_blocks *job = arg;
+	const size_t start = kripto_thread_part(job->blocks, job->n, i);
+	const size_t end = kripto_thread_part(job->blocks, job->n, i + 1);
+	const kripto_stream *s = job->s;
+	kripto_stream w = *s;
+
+	w.prev = job->mem + i * job->size;
+	w.buf = w.prev + w.blocksize;
+	w.used = w.blocksize;
+
+	cfb_decrypt
+	(
+		&w,
+		job->in + start * w.blocksize,
+		job->out + start * w.blocksize,
+		(end - start) * w.blocksize
+	);
+}
+
+static void cfb_decrypt_parallel
+(
+	kripto_stream *s,
+	const void *ct,
+	void *pt,
+	size_t len,
+	unsigned int threads
+)
+{
+	struct kripto_thread_blocks job;
+	size_t n;
+
+	/* finish partial block */
+	n = s->blocksize - s->used;
+	if(n > len) n = len;
+	if(n)
+	{
+		cfb_decrypt(s, ct, pt, n);
+		ct = CU8(ct) + n;
+		pt = U8(pt) + n;
+		len -= n;
+	}
+
+	if(kripto_thread_blocks_init
+	(
+		&job,
+		s,
+		ct,
+		pt,
+		len,
+		s->blocksize,
+		CFB_SIZE(s->blocksize),
+		threads
+	)) goto serial;
+
+	/* feedback of each part is the ciphertext block before it */
+	kripto_thread_blocks_chain(&job, s->prev, s->blocksize);
+
+	n = job.blocks * s->blocksize;
+	memcpy(s->prev, job.in + n - s->blocksize, s->blocksize);
+
+	kripto_thread_blocks_run(&job, &cfb_decrypt_job);
+
+	ct = CU8(ct) + n;
+	pt = U8(pt) + n;
+	len -= n;
+
+serial:
+	cfb_decrypt(s, ct, pt, len);
+}
+
 static void cfb_prng
 (
 	kripto_stream *s,
@@ -102,7 +210,7 @@ static void cfb_prng
 static void cfb_destroy(kripto_stream *s)
 {
 	kripto_block_destroy(s->block);
-	kripto_memwipe(s, sizeof(kripto_stream) + s->blocksize);
+	kripto_memwipe(s, sizeof(kripto_stream) + CFB_SIZE(s->blocksize));
 	free(s);
 }
 
@@ -126,7 +234,7 @@ static kripto_stream *cfb_create
 {
 	kripto_stream *s;
 
-	s = malloc(sizeof(kripto_stream) + desc->maxiv);
+	s = malloc(sizeof(kripto_stream) + CFB_SIZE(desc->maxiv));
 	if(!s) return 0;
 
 	s->obj.desc = desc;
@@ -135,12 +243,13 @@ static kripto_stream *cfb_create
 	s->used = s->blocksize = desc->maxiv;
 
 	s->prev = (uint8_t *)s + sizeof(kripto_stream);
+	s->buf = s->prev + s->blocksize;
 
 	/* block cipher */
 	s->block = kripto_block_create(EXT(desc)->block, rounds, key, key_len);
 	if(!s->block)
 	{
-		kripto_memwipe(s, sizeof(kripto_stream) + s->blocksize);
+		kripto_memwipe(s, sizeof(kripto_stream) + CFB_SIZE(s->blocksize));
 		free(s);
 		return 0;
 	}
@@ -166,7 +275,7 @@ static kripto_stream *cfb_recreate
 	s->block = kripto_block_recreate(s->block, rounds, key, key_len);
 	if(!s->block)
 	{
-		kripto_memwipe(s, sizeof(kripto_stream) + s->blocksize);
+		kripto_memwipe(s, sizeof(kripto_stream) + CFB_SIZE(s->blocksize));
 		free(s);
 		return 0;
 	}
@@ -193,7 +302,10 @@ kripto_stream_desc *kripto_stream_cfb(const kripto_block_desc *block)
 	s->desc.recreate = &cfb_recreate;
 	s->desc.encrypt = &cfb_encrypt;
 	s->desc.decrypt = &cfb_decrypt;
+	s->desc.encrypt_parallel = 0;
+	s->desc.decrypt_parallel = &cfb_decrypt_parallel;
 	s->desc.prng = &cfb_prng;
+	s->desc.seek = 0;
 	s->desc.destroy = &cfb_destroy;
 	s->desc.maxkey = kripto_block_maxkey(block);
 	s->desc.maxiv = kripto_block_size(block);
@@ -13,11 +13,15 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 #include <kripto/loadstore.h>
 #include <kripto/rotate.h>
 #include <kripto/memwipe.h>
+#include <kripto/memxor.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
 #include <kripto/stream.h>
 #include <kripto/desc/stream.h>
 #include <kripto/object/stream.h>
@@ -117,28 +121,349 @@ static void chacha_core
 	STORE32L(x15, U8(out) + 60);
 }
 
-static void chacha_crypt
+#ifdef KRIPTO_X86_SIMD
+
+/*
+ * 4, 8 or 16 blocks at once, vector i holds word i of every block.
+ * Keystream is transposed back to block order and XORed with in
+ * (or just stored, when in is 0) directly in out.
+ */
+
+#define VQR(A, B, C, D, ADD, XOR, ROL16, ROL12, ROL8, ROL7)	\
+{																\
+	A = ADD(A, B); D = ROL16(XOR(D, A));						\
+	C = ADD(C, D); B = ROL12(XOR(B, C));						\
+	A = ADD(A, B); D = ROL8(XOR(D, A));							\
+	C = ADD(C, D); B = ROL7(XOR(B, C));							\
+}
+
+#define VROUNDS(V, R, ADD, XOR, ROL16, ROL12, ROL8, ROL7)			\
+{																	\
+	for(i = 0; i < R; i++)											\
+	{																\
+		VQR(V[0], V[4], V[8], V[12], ADD, XOR, ROL16, ROL12, ROL8, ROL7);	\
+		VQR(V[1], V[5], V[9], V[13], ADD, XOR, ROL16, ROL12, ROL8, ROL7);	\
+		VQR(V[2], V[6], V[10], V[14], ADD, XOR, ROL16, ROL12, ROL8, ROL7);	\
+		VQR(V[3], V[7], V[11], V[15], ADD, XOR, ROL16, ROL12, ROL8, ROL7);	\
+																	\
+		if(++i == R) break;											\
+																	\
+		VQR(V[0], V[5], V[10], V[15], ADD, XOR, ROL16, ROL12, ROL8, ROL7);	\
+		VQR(V[1], V[6], V[11], V[12], ADD, XOR, ROL16, ROL12, ROL8, ROL7);	\
+		VQR(V[2], V[7], V[8], V[13], ADD, XOR, ROL16, ROL12, ROL8, ROL7);	\
+		VQR(V[3], V[4], V[9], V[14], ADD, XOR, ROL16, ROL12, ROL8, ROL7);	\
+	}																\
+}
+
+/* counters of n consecutive blocks, low words then high words */
+static void chacha_counters(const uint32_t *x, uint32_t *c, unsigned int n)
+{
+	unsigned int i;
+
+	for(i = 0; i < n; i++)
+	{
+		c[i] = x[12] + i;
+		c[i + n] = x[13] + (c[i] < i);
+	}
+}
+
+#define SSE2_ROL(X, N) \
+	_mm_or_si128(_mm_slli_epi32(X, N), _mm_srli_epi32(X, 32 - (N)))
+#define SSE2_ROL16(X) SSE2_ROL(X, 16)
+#define SSE2_ROL12(X) SSE2_ROL(X, 12)
+#define SSE2_ROL8(X) SSE2_ROL(X, 8)
+#define SSE2_ROL7(X) SSE2_ROL(X, 7)
+
+#define SSE2_OUT(OFF, V)											\
+{																	\
+	if(in) V = _mm_xor_si128(V, LOADU(in + (OFF)));					\
+	STOREU(out + (OFF), V);											\
+}
+
+KRIPTO_TARGET("sse2")
+static void chacha_sse2
+(
+	unsigned int r,
+	const uint32_t *x,
+	const uint8_t *in,
+	uint8_t *out
+)
+{
+	__m128i v[16];
+	__m128i k[16];
+	__m128i t[4];
+	uint32_t c[8];
+	unsigned int i;
+
+	for(i = 0; i < 16; i++) k[i] = _mm_set1_epi32((int)x[i]);
+	chacha_counters(x, c, 4);
+	k[12] = LOADU(c);
+	k[13] = LOADU(c + 4);
+
+	for(i = 0; i < 16; i++) v[i] = k[i];
+
+	VROUNDS(v, r, _mm_add_epi32, _mm_xor_si128,
+		SSE2_ROL16, SSE2_ROL12, SSE2_ROL8, SSE2_ROL7);
+
+	for(i = 0; i < 16; i++) v[i] = _mm_add_epi32(v[i], k[i]);
+
+	for(i = 0; i < 16; i += 4)
+	{
+		TRANSPOSE4(v[i], v[i + 1], v[i + 2], v[i + 3], t,
+			_mm_unpacklo_epi32, _mm_unpackhi_epi32,
+			_mm_unpacklo_epi64, _mm_unpackhi_epi64);
+
+		SSE2_OUT((i << 2), v[i]);
+		SSE2_OUT((i << 2) + 64, v[i + 1]);
+		SSE2_OUT((i << 2) + 128, v[i + 2]);
+		SSE2_OUT((i << 2) + 192, v[i + 3]);
+	}
+}
+
+#define AVX2_ROL(X, N) \
+	_mm256_or_si256(_mm256_slli_epi32(X, N), _mm256_srli_epi32(X, 32 - (N)))
+#define AVX2_ROL16(X) _mm256_shuffle_epi8(X, rol16)
+#define AVX2_ROL12(X) AVX2_ROL(X, 12)
+#define AVX2_ROL8(X) _mm256_shuffle_epi8(X, rol8)
+#define AVX2_ROL7(X) AVX2_ROL(X, 7)
+
+#define AVX2_OUT(OFF, V)											\
+{																	\
+	if(in) V = _mm256_xor_si256(V, LOADU256(in + (OFF)));			\
+	STOREU256(out + (OFF), V);										\
+}
+
+KRIPTO_TARGET("avx2")
+static void chacha_avx2
+(
+	unsigned int r,
+	const uint32_t *x,
+	const uint8_t *in,
+	uint8_t *out
+)
+{
+	const __m256i rol16 = _mm256_set_epi8
+	(
+		13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+		13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2
+	);
+	const __m256i rol8 = _mm256_set_epi8
+	(
+		14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+		14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3
+	);
+	__m256i v[16];
+	__m256i k[16];
+	__m256i t[4];
+	uint32_t c[16];
+	unsigned int i;
+
+	for(i = 0; i < 16; i++) k[i] = _mm256_set1_epi32((int)x[i]);
+	chacha_counters(x, c, 8);
+	k[12] = LOADU256(c);
+	k[13] = LOADU256(c + 8);
+
+	for(i = 0; i < 16; i++) v[i] = k[i];
+
+	VROUNDS(v, r, _mm256_add_epi32, _mm256_xor_si256,
+		AVX2_ROL16, AVX2_ROL12, AVX2_ROL8, AVX2_ROL7);
+
+	for(i = 0; i < 16; i++) v[i] = _mm256_add_epi32(v[i], k[i]);
+
+	/* lane 0 of v[4g + j] is now block j, lane 1 block j + 4 */
+	for(i = 0; i < 16; i += 4)
+	{
+		TRANSPOSE4(v[i], v[i + 1], v[i + 2], v[i + 3], t,
+			_mm256_unpacklo_epi32, _mm256_unpackhi_epi32,
+			_mm256_unpacklo_epi64, _mm256_unpackhi_epi64);
+	}
+
+	for(i = 0; i < 4; i++)
+	{
+		k[0] = _mm256_permute2x128_si256(v[i], v[i + 4], 0x20);
+		k[1] = _mm256_permute2x128_si256(v[i + 8], v[i + 12], 0x20);
+		k[2] = _mm256_permute2x128_si256(v[i], v[i + 4], 0x31);
+		k[3] = _mm256_permute2x128_si256(v[i + 8], v[i + 12], 0x31);
+
+		AVX2_OUT((i << 6), k[0]);
+		AVX2_OUT((i << 6) + 32, k[1]);
+		AVX2_OUT((i << 6) + 256, k[2]);
+		AVX2_OUT((i << 6) + 288, k[3]);
+	}
+}
+
+#define AVX512_ROL16(X) _mm512_rol_epi32(X, 16)
+#define AVX512_ROL12(X) _mm512_rol_epi32(X, 12)
+#define AVX512_ROL8(X) _mm512_rol_epi32(X, 8)
+#define AVX512_ROL7(X) _mm512_rol_epi32(X, 7)
+
+#define AVX512_OUT(OFF, V)											\
+{																	\
+	if(in) V = _mm512_xor_si512(V, LOADU512(in + (OFF)));			\
+	STOREU512(out + (OFF), V);										\
+}
+
+KRIPTO_TARGET("avx512f")
+static void chacha_avx512
+(
+	unsigned int r,
+	const uint32_t *x,
+	const uint8_t *in,
+	uint8_t *out
+)
+{
+	__m512i v[16];
+	__m512i k[16];
+	__m512i t[4];
+	uint32_t c[32];
+	unsigned int i;
+
+	for(i = 0; i < 16; i++) k[i] = _mm512_set1_epi32((int)x[i]);
+	chacha_counters(x, c, 16);
+	k[12] = LOADU512(c);
+	k[13] = LOADU512(c + 16);
+
+	for(i = 0; i < 16; i++) v[i] = k[i];
+
+	VROUNDS(v, r, _mm512_add_epi32, _mm512_xor_si512,
+		AVX512_ROL16, AVX512_ROL12, AVX512_ROL8, AVX512_ROL7);
+
+	for(i = 0; i < 16; i++) v[i] = _mm512_add_epi32(v[i], k[i]);
+
+	/* lane l of v[4g + j] is now words 4g...4g + 3 of block j + 4l */
+	for(i = 0; i < 16; i += 4)
+	{
+		TRANSPOSE4(v[i], v[i + 1], v[i + 2], v[i + 3], t,
+			_mm512_unpacklo_epi32, _mm512_unpackhi_epi32,
+			_mm512_unpacklo_epi64, _mm512_unpackhi_epi64);
+	}
+
+	/* 4x4 transpose of 128-bit lanes */
+	for(i = 0; i < 4; i++)
+	{
+		t[0] = _mm512_shuffle_i32x4(v[i], v[i + 4], 0x44);
+		t[1] = _mm512_shuffle_i32x4(v[i + 8], v[i + 12], 0x44);
+		t[2] = _mm512_shuffle_i32x4(v[i], v[i + 4], 0xEE);
+		t[3] = _mm512_shuffle_i32x4(v[i + 8], v[i + 12], 0xEE);
+
+		k[0] = _mm512_shuffle_i32x4(t[0], t[1], 0x88);
+		k[1] = _mm512_shuffle_i32x4(t[0], t[1], 0xDD);
+		k[2] = _mm512_shuffle_i32x4(t[2], t[3], 0x88);
+		k[3] = _mm512_shuffle_i32x4(t[2], t[3], 0xDD);
+
+		AVX512_OUT((i << 6), k[0]);
+		AVX512_OUT((i << 6) + 256, k[1]);
+		AVX512_OUT((i << 6) + 512, k[2]);
+		AVX512_OUT((i << 6) + 768, k[3]);
+	}
+}
+
+#endif
+
+static void chacha_add(kripto_stream *s, unsigned int n)
+{
+	s->x[12] += n;
+	if(s->x[12] < n) s->x[13]++;
+}
+
+/* keystream of n whole blocks, XORed with in unless it is 0 */
+static void chacha_blocks
 (
 	kripto_stream *s,
-	const void *in,
-	void *out,
-	size_t len
+	const uint8_t *in,
+	uint8_t *out,
+	size_t n
 )
 {
-	size_t i;
+	#ifdef KRIPTO_X86_SIMD
+	const unsigned int cpu = kripto_cpu();
 
-	for(i = 0; i < len; i++)
+	if(cpu & KRIPTO_CPU_AVX512)
 	{
-		if(s->used == 64)
+		for(; n >= 16; n -= 16)
 		{
-			chacha_core(s->r, s->x, s->buf);
-			s->used = 0;
+			chacha_avx512(s->r, s->x, in, out);
+			chacha_add(s, 16);
+			if(in) in += 1024;
+			out += 1024;
+		}
+	}
 
-			if(!++s->x[12])
-				++s->x[13];
+	if(cpu & KRIPTO_CPU_AVX2)
+	{
+		for(; n >= 8; n -= 8)
+		{
+			chacha_avx2(s->r, s->x, in, out);
+			chacha_add(s, 8);
+			if(in) in += 512;
+			out += 512;
 		}
+	}
 
-		U8(out)[i] = CU8(in)[i] ^ s->buf[s->used++];
+	if(cpu & KRIPTO_CPU_SSE2)
+	{
+		for(; n >= 4; n -= 4)
+		{
+			chacha_sse2(s->r, s->x, in, out);
+			chacha_add(s, 4);
+			if(in) in += 256;
+			out += 256;
+		}
+	}
+	#endif
+
+	for(; n; n--)
+	{
+		if(in)
+		{
+			chacha_core(s->r, s->x, s->buf);
+			kripto_memxor(in, s->buf, out, 64);
+			in += 64;
+		}
+		else
+		{
+			chacha_core(s->r, s->x, out);
+		}
+
+		chacha_add(s, 1);
+		out += 64;
+	}
+}
+
+static void chacha_crypt
+(
+	kripto_stream *s,
+	const void *in,
+	void *out,
+	size_t len
+)
+{
+	size_t n;
+
+	/* rest of the buffered block */
+	n = 64 - s->used;
+	if(n > len) n = len;
+	kripto_memxor(in, s->buf + s->used, out, n);
+	s->used += n;
+	len -= n;
+	in = CU8(in) + n;
+	out = U8(out) + n;
+
+	n = len >> 6;
+	if(n)
+	{
+		chacha_blocks(s, CU8(in), U8(out), n);
+		in = CU8(in) + (n << 6);
+		out = U8(out) + (n << 6);
+		len &= 63;
+	}
+
+	if(len)
+	{
+		chacha_core(s->r, s->x, s->buf);
+		chacha_add(s, 1);
+		kripto_memxor(in, s->buf, out, len);
+		s->used = len;
 	}
 }
 
@@ -149,20 +474,44 @@ static void chacha_prng
 	size_t len
 )
 {
-	size_t i;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	n = 64 - s->used;
+	if(n > len) n = len;
+	memcpy(out, s->buf + s->used, n);
+	s->used += n;
+	len -= n;
+	out = U8(out) + n;
+
+	n = len >> 6;
+	if(n)
 	{
-		if(s->used == 64)
-		{
-			chacha_core(s->r, s->x, s->buf);
-			s->used = 0;
+		chacha_blocks(s, 0, U8(out), n);
+		out = U8(out) + (n << 6);
+		len &= 63;
+	}
 
-			if(!++s->x[12])
-				++s->x[13];
-		}
+	if(len)
+	{
+		chacha_core(s->r, s->x, s->buf);
+		chacha_add(s, 1);
+		memcpy(out, s->buf, len);
+		s->used = len;
+	}
+}
+
+static void chacha_seek(kripto_stream *s, uint64_t offset)
+{
+	s->x[12] = (uint32_t)(offset >> 6);
+	s->x[13] = (uint32_t)(offset >> 38);
+	s->used = 64;
+
+	if(offset & 63)
+	{
+		chacha_core(s->r, s->x, s->buf);
+		s->used = offset & 63;
 
-		U8(out)[i] = s->buf[s->used++];
+		chacha_add(s, 1);
 	}
 }
 
@@ -290,7 +639,10 @@ static const struct kripto_stream_desc chacha =
 	&chacha_recreate,
 	&chacha_crypt,
 	&chacha_crypt,
+	0, /* encrypt_parallel */
+	0, /* decrypt_parallel */
 	&chacha_prng,
+	&chacha_seek,
 	&chacha_destroy,
 	32, /* max key */
 	24 /* max iv */
@@ -16,7 +16,10 @@
 #include <stdlib.h>
 
 #include <kripto/cast.h>
+#include <kripto/loadstore.h>
 #include <kripto/memwipe.h>
+#include <kripto/memxor.h>
+#include <kripto/thread.h>
 #include <kripto/block.h>
 #include <kripto/stream.h>
 #include <kripto/desc/stream.h>
@@ -24,16 +27,125 @@
 
 #include <kripto/stream/ctr.h>
 
+/* counter blocks encrypted per block cipher call, 4 to 16 */
+#define CTR_BLOCKS(BS) ((BS) <= 16 ? 16 : ((BS) <= 32 ? 8 : 4))
+
+/* IV + counter + counter blocks + keystream */
+#define CTR_SIZE(BS) ((BS) * 2 + (CTR_BLOCKS(BS) * (BS) << 1))
+
 struct kripto_stream
 {
 	struct kripto_stream_object obj;
 	kripto_block *block;
+	uint8_t *iv;
 	uint8_t *x;
+	uint8_t *ctr;
 	uint8_t *buf;
+	uint64_t c;
+	uint64_t mask;
+	uint64_t fixed;
 	unsigned int blocksize;
+	unsigned int low;
+	unsigned int bufsize;
 	unsigned int used;
 };
 
+static void ctr_refill(kripto_stream *s)
+{
+	unsigned int i;
+	unsigned int n;
+	const unsigned int high = s->blocksize - s->low;
+	uint64_t v;
+
+	for(i = 0; i < s->bufsize; i += s->blocksize)
+	{
+		if(high) memcpy(s->ctr + i, s->x, high);
+
+		v = s->fixed | s->c;
+		if(s->low == 8)
+		{
+			STORE64B(v, s->ctr + i + high);
+		}
+		else
+		{
+			for(n = s->blocksize; n--; v >>= 8)
+				s->ctr[i + n] = (uint8_t)v;
+		}
+
+		s->c = (s->c + 1) & s->mask;
+		if(!s->c && high)
+		{
+			for(n = high - 1; n; n--)
+				if(++s->x[n]) break;
+		}
+	}
+
+	kripto_block_encrypt_blocks
+	(
+		s->block,
+		s->ctr,
+		s->buf,
+		s->bufsize / s->blocksize
+	);
+
+	s->used = 0;
+}
+
+/*
+ * The counter is big endian and spans every byte but the first. Its low
+ * (up to 8) bytes are kept in c, carries out of them go to the bytes
+ * in x. The last low bytes of a counter block are fixed | c.
+ */
+static void ctr_add(kripto_stream *s, uint64_t blocks)
+{
+	unsigned int i;
+	const uint64_t c = s->c;
+
+	s->c = (c + blocks) & s->mask;
+	if(s->c < c && s->blocksize > 9)
+	{
+		for(i = s->blocksize - 9; i; i--)
+			if(++s->x[i]) break;
+	}
+}
+
+static void ctr_seek(kripto_stream *s, uint64_t offset)
+{
+	unsigned int i;
+	uint64_t v = 0;
+
+	memcpy(s->x, s->iv, s->blocksize);
+
+	for(i = s->blocksize - s->low; i < s->blocksize; i++)
+		v = (v << 8) | s->x[i];
+
+	s->fixed = v & ~s->mask;
+	s->c = v & s->mask;
+	ctr_add(s, offset / s->blocksize);
+
+	s->used = s->bufsize;
+
+	offset %= s->blocksize;
+	if(offset)
+	{
+		ctr_refill(s);
+		s->used = offset;
+	}
+}
+
+static void ctr_iv(kripto_stream *s, const void *iv, unsigned int iv_len)
+{
+	if(iv_len) memcpy(s->iv, iv, iv_len);
+	memset(s->iv + iv_len, 0, s->blocksize - iv_len);
+
+	s->low = s->blocksize < 8 ? s->blocksize : 8;
+
+	if(s->blocksize > 8) s->mask = UINT64_MAX;
+	else s->mask = ((uint64_t)1 << ((s->blocksize - 1) << 3)) - 1;
+
+	ctr_seek(s, 0);
+}
+
 static void ctr_crypt
 (
 	kripto_stream *s,
@@ -42,24 +154,98 @@ static void ctr_crypt
 	size_t len
 )
 {
-	size_t i;
-	unsigned int n;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		if(s->used == s->blocksize)
-		{
-			kripto_block_encrypt(s->block, s->x, s->buf);
-			s->used = 0;
+		if(s->used == s->bufsize) ctr_refill(s);
 
-			for(n = s->blocksize - 1; n; n--)
-				if(++s->x[n]) break;
-		}
+		n = s->bufsize - s->used;
+		if(n > len) n = len;
+
+		kripto_memxor(in, s->buf + s->used, out, n);
 
-		U8(out)[i] = CU8(in)[i] ^ s->buf[s->used++];
+		s->used += n;
+		in = CU8(in) + n;
+		out = U8(out) + n;
+		len -= n;
 	}
 }
 
+/* each thread runs its own copy of the counter, started at its part */
+static void ctr_job(void *arg, unsigned int i)
+{
+	const struct kripto_thread_blocks *job = arg;
+	const size_t start = kripto_thread_part(job->blocks, job->n, i);
+	const size_t end = kripto_thread_part(job->blocks, job->n, i + 1);
+	const kripto_stream *s = job->s;
+	kripto_stream w = *s;
+
+	w.x = job->mem + i * job->size;
+	w.ctr = w.x + w.blocksize;
+	w.buf = w.ctr + w.bufsize;
+	memcpy(w.x, s->x, w.blocksize);
+
+	ctr_add(&w, start);
+	w.used = w.bufsize;
+
+	ctr_crypt
+	(
+		&w,
+		job->in + start * w.blocksize,
+		job->out + start * w.blocksize,
+		(end - start) * w.blocksize
+	);
+}
+
+static void ctr_crypt_parallel
+(
+	kripto_stream *s,
+	const void *in,
+	void *out,
+	size_t len,
+	unsigned int threads
+)
+{
+	struct kripto_thread_blocks job;
+	size_t n;
+
+	/* buffered keystream first */
+	n = s->bufsize - s->used;
+	if(n > len) n = len;
+	if(n)
+	{
+		ctr_crypt(s, in, out, n);
+		in = CU8(in) + n;
+		out = U8(out) + n;
+		len -= n;
+	}
+
+	if(kripto_thread_blocks_init
+	(
+		&job,
+		s,
+		in,
+		out,
+		len,
+		s->blocksize,
+		CTR_SIZE(s->blocksize),
+		threads
+	)) goto serial;
+
+	kripto_thread_blocks_run(&job, &ctr_job);
+
+	ctr_add(s, job.blocks);
+
+	n = job.blocks * s->blocksize;
+	in = CU8(in) + n;
+	out = U8(out) + n;
+	len -= n;
+
+serial:
+	ctr_crypt(s, in, out, len);
+}
+
 static void ctr_prng
 (
 	kripto_stream *s,
@@ -67,28 +253,27 @@ static void ctr_prng
 	size_t len
 )
 {
-	size_t i;
-	unsigned int n;
+	size_t n;
 
-	for(i = 0; i < len; i++)
+	while(len)
 	{
-		if(s->used == s->blocksize)
-		{
-			kripto_block_encrypt(s->block, s->x, s->buf);
-			s->used = 0;
+		if(s->used == s->bufsize) ctr_refill(s);
 
-			for(n = s->blocksize - 1; n; n--)
-				if(++s->x[n]) break;
-		}
+		n = s->bufsize - s->used;
+		if(n > len) n = len;
 
-		U8(out)[i] = s->buf[s->used++];
+		memcpy(out, s->buf + s->used, n);
+
+		s->used += n;
+		out = U8(out) + n;
+		len -= n;
 	}
 }
 
 static void ctr_destroy(kripto_stream *s)
 {
 	kripto_block_destroy(s->block);
-	kripto_memwipe(s, sizeof(kripto_stream) + (s->blocksize << 1));
+	kripto_memwipe(s, sizeof(kripto_stream) + CTR_SIZE(s->blocksize));
 	free(s);
 }
 
@@ -112,29 +297,31 @@ static kripto_stream *ctr_create
 {
 	kripto_stream *s;
 
-	s = malloc(sizeof(kripto_stream) + (desc->maxiv << 1));
+	s = malloc(sizeof(kripto_stream) + CTR_SIZE(desc->maxiv));
 	if(!s) return 0;
 
 	s->obj.desc = desc;
 	s->obj.multof = 1;
 
-	s->used = s->blocksize = desc->maxiv;
+	s->blocksize = desc->maxiv;
+	s->bufsize = CTR_BLOCKS(s->blocksize) * s->blocksize;
 
-	s->x = (uint8_t *)s + sizeof(kripto_stream);
-	s->buf = s->x + s->blocksize;
+	s->ctr = (uint8_t *)s + sizeof(kripto_stream);
+	s->buf = s->ctr + s->bufsize;
+	s->iv = s->buf + s->bufsize;
+	s->x = s->iv + s->blocksize;
 
 	/* block cipher */
 	s->block = kripto_block_create(EXT(desc)->block, rounds, key, key_len);
 	if(!s->block)
 	{
-		kripto_memwipe(s, sizeof(kripto_stream) + (s->blocksize << 1));
+		kripto_memwipe(s, sizeof(kripto_stream) + CTR_SIZE(s->blocksize));
 		free(s);
 		return 0;
 	}
 
 	/* IV (nonce) */
-	if(iv_len) memcpy(s->x, iv, iv_len);
-	memset(s->x + iv_len, 0, s->blocksize - iv_len);
+	ctr_iv(s, iv, iv_len);
 
 	return s;
 }
@@ -153,16 +340,13 @@ static kripto_stream *ctr_recreate
 	s->block = kripto_block_recreate(s->block, rounds, key, key_len);
 	if(!s->block)
 	{
-		kripto_memwipe(s, sizeof(kripto_stream) + (s->blocksize << 1));
+		kripto_memwipe(s, sizeof(kripto_stream) + CTR_SIZE(s->blocksize));
 		free(s);
 		return 0;
 	}
 
 	/* IV (nonce) */
-	if(iv_len) memcpy(s->x, iv, iv_len);
-	memset(s->x + iv_len, 0, s->blocksize - iv_len);
-
-	s->used = s->blocksize;
+	ctr_iv(s, iv, iv_len);
 
 	return s;
 }
@@ -180,7 +364,10 @@ kripto_stream_desc *kripto_stream_ctr(const kripto_block_desc *block)
 	s->desc.recreate = &ctr_recreate;
 	s->desc.encrypt = &ctr_crypt;
 	s->desc.decrypt = &ctr_crypt;
+	s->desc.encrypt_parallel = &ctr_crypt_parallel;
+	s->desc.decrypt_parallel = &ctr_crypt_parallel;
 	s->desc.prng = &ctr_prng;
+	s->desc.seek = &ctr_seek;
 	s->desc.destroy = &ctr_destroy;
 	s->desc.maxkey = kripto_block_maxkey(block);
 	s->desc.maxiv = kripto_block_size(block);
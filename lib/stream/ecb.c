@@ -17,6 +17,7 @@
 
 #include <kripto/cast.h>
 #include <kripto/memwipe.h>
+#include <kripto/thread.h>
 #include <kripto/block.h>
 #include <kripto/stream.h>
 #include <kripto/desc/stream.h>
@@ -39,10 +40,7 @@ static void ecb_encrypt
 	size_t len
 )
 {
-	size_t i;
-
-	for(i = 0; i < len; i += s->blocksize)
-		kripto_block_encrypt(s->block, CU8(pt) + i, U8(ct) + i);
+	kripto_block_encrypt_blocks(s->block, pt, ct, len / s->blocksize);
 }
 
 static void ecb_decrypt
@@ -53,10 +51,89 @@ static void ecb_decrypt
 	size_t len
 )
 {
-	size_t i;
+	kripto_block_decrypt_blocks(s->block, ct, pt, len / s->blocksize);
+}
+
+static void ecb_encrypt_job(void *arg, unsigned int i)
+{
+	const struct kripto_thread_blocks *job = arg;
+	const size_t start = kripto_thread_part(job->blocks, job->n, i);
+	const size_t end = kripto_thread_part(job->blocks, job->n, i + 1);
+	const kripto_stream *s = job->s;
+
+	kripto_block_encrypt_blocks
+	(
+		s->block,
+		job->in + start * s->blocksize,
+		job->out + start * s->blocksize,
+		end - start
+	);
+}
+
+static void ecb_decrypt_job(void *arg, unsigned int i)
+{
+	const struct kripto_thread_blocks *job = arg;
+	const size_t start = kripto_thread_part(job->blocks, job->n, i);
+	const size_t end = kripto_thread_part(job->blocks, job->n, i + 1);
+	const kripto_stream *s = job->s;
+
+	kripto_block_decrypt_blocks
+	(
+		s->block,
+		job->in + start * s->blocksize,
+		job->out + start * s->blocksize,
+		end - start
+	);
+}
+
+static void ecb_encrypt_parallel
+(
+	kripto_stream *s,
+	const void *pt,
+	void *ct,
+	size_t len,
+	unsigned int threads
+)
+{
+	struct kripto_thread_blocks job;
+
+	if(kripto_thread_blocks_init
+	(
+		&job,
+		s,
+		pt,
+		ct,
+		len,
+		s->blocksize,
+		0, /* no workspace */
+		threads
+	)) ecb_encrypt(s, pt, ct, len);
+	else kripto_thread_blocks_run(&job, &ecb_encrypt_job);
+}
 
-	for(i = 0; i < len; i += s->blocksize)
-		kripto_block_decrypt(s->block, CU8(ct) + i, U8(pt) + i);
+static void ecb_decrypt_parallel
+(
+	kripto_stream *s,
+	const void *ct,
+	void *pt,
+	size_t len,
+	unsigned int threads
+)
+{
+	struct kripto_thread_blocks job;
+
+	if(kripto_thread_blocks_init
+	(
+		&job,
+		s,
+		ct,
+		pt,
+		len,
+		s->blocksize,
+		0, /* no workspace */
+		threads
+	)) ecb_decrypt(s, ct, pt, len);
+	else kripto_thread_blocks_run(&job, &ecb_decrypt_job);
 }
 
 static void ecb_destroy(kripto_stream *s)
@@ -147,7 +224,10 @@ kripto_stream_desc *kripto_stream_ecb(const kripto_block_desc *block)
 	s->desc.recreate = &ecb_recreate;
 	s->desc.encrypt = &ecb_encrypt;
 	s->desc.decrypt = &ecb_decrypt;
+	s->desc.encrypt_parallel = &ecb_encrypt_parallel;
+	s->desc.decrypt_parallel = &ecb_decrypt_parallel;
 	s->desc.prng = 0;
+	s->desc.seek = 0;
 	s->desc.destroy = &ecb_destroy;
 	s->desc.maxkey = kripto_block_maxkey(block);
 	s->desc.maxiv = 0;
@@ -17,9 +17,7 @@
 
 #include <kripto/cast.h>
 #include <kripto/memwipe.h>
-#include <kripto/hash.h>
-#include <kripto/hash/keccak1600.h>
-#include <kripto/hash/keccak800.h>
+#include <kripto/keccak.h>
 #include <kripto/stream.h>
 #include <kripto/desc/stream.h>
 #include <kripto/object/stream.h>
@@ -30,10 +28,18 @@
 struct kripto_stream
 {
 	struct kripto_stream_object obj;
-	kripto_hash *hash;
+	struct kripto_keccak1600 k1600; /* kripto_stream_keccak1600 */
+	struct kripto_keccak800 k800; /* kripto_stream_keccak800 */
 };
 
-static void keccak_crypt
+static void keccak_destroy(kripto_stream *s)
+{
+	kripto_memwipe(s, sizeof(kripto_stream));
+	free(s);
+}
+
+/* 1600 */
+static void keccak1600_crypt
 (
 	kripto_stream *s,
 	const void *in,
@@ -41,34 +47,15 @@ static void keccak_crypt
 	size_t len
 )
 {
-	size_t i;
-	uint8_t buf[64];
-	unsigned int n;
-
-	for(i = 0, n = 64; i < len; i++)
-	{
-		if(n == 64)
-		{
-			if(len - i < 64)
-				kripto_hash_output(s->hash, buf, len - i);
-			else
-				kripto_hash_output(s->hash, buf, 64);
-
-			n = 0;
-		}
-
-		U8(out)[i] = CU8(in)[i] ^ buf[n++];
-	}
-
-	kripto_memwipe(buf, 64);
+	kripto_keccak1600_output_xor(&s->k1600, in, out, len);
 }
 
-static void keccak_prng(kripto_stream *s, void *out, size_t len)
+static void keccak1600_prng(kripto_stream *s, void *out, size_t len)
 {
-	kripto_hash_output(s->hash, out, len);
+	kripto_keccak1600_output(&s->k1600, out, len);
 }
 
-static kripto_stream *keccak_recreate
+static kripto_stream *keccak1600_recreate
 (
 	kripto_stream *s,
 	unsigned int r,
@@ -78,21 +65,14 @@ static kripto_stream *keccak_recreate
 	unsigned int iv_len
 )
 {
-	(void)kripto_hash_recreate(s->hash, r, key_len);
+	kripto_keccak1600_init(&s->k1600, r, 200 - (key_len << 1));
 
-	kripto_hash_input(s->hash, key, key_len);
-	kripto_hash_input(s->hash, iv, iv_len);
+	kripto_keccak1600_input(&s->k1600, key, key_len);
+	kripto_keccak1600_input(&s->k1600, iv, iv_len);
 
 	return s;
 }
 
-static void keccak_destroy(kripto_stream *s)
-{
-	kripto_hash_destroy(s->hash);
-	free(s);
-}
-
-/* 1600 */
 static kripto_stream *keccak1600_create
 (
 	const kripto_stream_desc *desc,
@@ -113,26 +93,19 @@ static kripto_stream *keccak1600_create
 	s->obj.desc = kripto_stream_keccak1600;
 	s->obj.multof = 1;
 
-	s->hash = kripto_hash_create(kripto_hash_keccak1600, r, key_len);
-	if(!s->hash)
-	{
-		free(s);
-		return 0;
-	}
-
-	kripto_hash_input(s->hash, key, key_len);
-	kripto_hash_input(s->hash, iv, iv_len);
-
-	return s;
+	return keccak1600_recreate(s, r, key, key_len, iv, iv_len);
 }
 
 static const kripto_stream_desc keccak1600 =
 {
 	&keccak1600_create,
-	&keccak_recreate,
-	&keccak_crypt,
-	&keccak_crypt,
-	&keccak_prng,
+	&keccak1600_recreate,
+	&keccak1600_crypt,
+	&keccak1600_crypt,
+	0, /* encrypt_parallel */
+	0, /* decrypt_parallel */
+	&keccak1600_prng,
+	0, /* seek */
 	&keccak_destroy,
 	99, /* max key */
 	UINT_MAX /* max iv */
@@ -141,6 +114,40 @@ static const kripto_stream_desc keccak1600 =
 const kripto_stream_desc *const kripto_stream_keccak1600 = &keccak1600;
 
 /* 800 */
+static void keccak800_crypt
+(
+	kripto_stream *s,
+	const void *in,
+	void *out,
+	size_t len
+)
+{
+	kripto_keccak800_output_xor(&s->k800, in, out, len);
+}
+
+static void keccak800_prng(kripto_stream *s, void *out, size_t len)
+{
+	kripto_keccak800_output(&s->k800, out, len);
+}
+
+static kripto_stream *keccak800_recreate
+(
+	kripto_stream *s,
+	unsigned int r,
+	const void *key,
+	unsigned int key_len,
+	const void *iv,
+	unsigned int iv_len
+)
+{
+	kripto_keccak800_init(&s->k800, r, 100 - (key_len << 1));
+
+	kripto_keccak800_input(&s->k800, key, key_len);
+	kripto_keccak800_input(&s->k800, iv, iv_len);
+
+	return s;
+}
+
 static kripto_stream *keccak800_create
 (
 	const kripto_stream_desc *desc,
@@ -161,26 +168,19 @@ static kripto_stream *keccak800_create
 	s->obj.desc = kripto_stream_keccak800;
 	s->obj.multof = 1;
 
-	s->hash = kripto_hash_create(kripto_hash_keccak800, r, key_len);
-	if(!s->hash)
-	{
-		free(s);
-		return 0;
-	}
-
-	kripto_hash_input(s->hash, key, key_len);
-	kripto_hash_input(s->hash, iv, iv_len);
-
-	return s;
+	return keccak800_recreate(s, r, key, key_len, iv, iv_len);
 }
 
 static const kripto_stream_desc keccak800 =
 {
 	&keccak800_create,
-	&keccak_recreate,
-	&keccak_crypt,
-	&keccak_crypt,
-	&keccak_prng,
+	&keccak800_recreate,
+	&keccak800_crypt,
+	&keccak800_crypt,
+	0, /* encrypt_parallel */
+	0, /* decrypt_parallel */
+	&keccak800_prng,
+	0, /* seek */
 	&keccak_destroy,
 	49, /* max key */
 	UINT_MAX /* max iv */
@@ -170,7 +170,10 @@ kripto_stream_desc *kripto_stream_ofb(const kripto_block_desc *block)
 	s->desc.recreate = &ofb_recreate;
 	s->desc.encrypt = &ofb_crypt;
 	s->desc.decrypt = &ofb_crypt;
+	s->desc.encrypt_parallel = 0;
+	s->desc.decrypt_parallel = 0;
 	s->desc.prng = &ofb_prng;
+	s->desc.seek = 0;
 	s->desc.destroy = &ofb_destroy;
 	s->desc.maxkey = kripto_block_maxkey(block);
 	s->desc.maxiv = kripto_block_size(block);
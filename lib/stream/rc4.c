@@ -252,7 +252,10 @@ static const struct kripto_stream_desc rc4_desc =
 	&rc4_recreate,
 	&rc4_crypt,
 	&rc4_crypt,
+	0, /* encrypt_parallel */
+	0, /* decrypt_parallel */
 	&rc4_prng,
+	0, /* seek */
 	&rc4_destroy,
 	256, /* max key */
 	0 /* max iv */
@@ -267,7 +270,10 @@ static const struct kripto_stream_desc rc4i =
 	&rc4i_recreate,
 	&rc4_crypt,
 	&rc4_crypt,
+	0, /* encrypt_parallel */
+	0, /* decrypt_parallel */
 	&rc4_prng,
+	0, /* seek */
 	&rc4_destroy,
 	256, /* max key */
 	256 /* max iv */
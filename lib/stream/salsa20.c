@@ -13,11 +13,15 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 #include <kripto/loadstore.h>
 #include <kripto/rotate.h>
 #include <kripto/memwipe.h>
+#include <kripto/memxor.h>
+#include <kripto/cpu.h>
+#include <kripto/simd.h>
 #include <kripto/stream.h>
 #include <kripto/desc/stream.h>
 #include <kripto/object/stream.h>
@@ -117,28 +121,262 @@ static void salsa20_core
 	STORE32L(x15, U8(out) + 60);
 }
 
-static void salsa20_crypt
+#ifdef KRIPTO_X86_SIMD
+
+/*
+ * 4 or 8 blocks at once, vector i holds word i of every block.
+ * Keystream is transposed back to block order and XORed with in
+ * (or just stored, when in is 0) directly in out.
+ */
+
+#define VQR(A, B, C, D, ADD, XOR, ROL7, ROL9, ROL13, ROL18)		\
+{																\
+	B = XOR(B, ROL7(ADD(A, D)));								\
+	C = XOR(C, ROL9(ADD(B, A)));								\
+	D = XOR(D, ROL13(ADD(C, B)));								\
+	A = XOR(A, ROL18(ADD(D, C)));								\
+}
+
+#define VROUNDS(V, R, ADD, XOR, ROL7, ROL9, ROL13, ROL18)			\
+{																	\
+	for(i = 0; i < R; i++)											\
+	{																\
+		VQR(V[0], V[4], V[8], V[12], ADD, XOR, ROL7, ROL9, ROL13, ROL18);	\
+		VQR(V[5], V[9], V[13], V[1], ADD, XOR, ROL7, ROL9, ROL13, ROL18);	\
+		VQR(V[10], V[14], V[2], V[6], ADD, XOR, ROL7, ROL9, ROL13, ROL18);	\
+		VQR(V[15], V[3], V[7], V[11], ADD, XOR, ROL7, ROL9, ROL13, ROL18);	\
+																	\
+		if(++i == R) break;											\
+																	\
+		VQR(V[0], V[1], V[2], V[3], ADD, XOR, ROL7, ROL9, ROL13, ROL18);	\
+		VQR(V[5], V[6], V[7], V[4], ADD, XOR, ROL7, ROL9, ROL13, ROL18);	\
+		VQR(V[10], V[11], V[8], V[9], ADD, XOR, ROL7, ROL9, ROL13, ROL18);	\
+		VQR(V[15], V[12], V[13], V[14], ADD, XOR, ROL7, ROL9, ROL13, ROL18);	\
+	}																\
+}
+
+/* counters of n consecutive blocks, low words then high words */
+static void salsa20_counters(const uint32_t *x, uint32_t *c, unsigned int n)
+{
+	unsigned int i;
+
+	for(i = 0; i < n; i++)
+	{
+		c[i] = x[8] + i;
+		c[i + n] = x[9] + (c[i] < i);
+	}
+}
+
+#define SSE2_ROL(X, N) \
+	_mm_or_si128(_mm_slli_epi32(X, N), _mm_srli_epi32(X, 32 - (N)))
+#define SSE2_ROL7(X) SSE2_ROL(X, 7)
+#define SSE2_ROL9(X) SSE2_ROL(X, 9)
+#define SSE2_ROL13(X) SSE2_ROL(X, 13)
+#define SSE2_ROL18(X) SSE2_ROL(X, 18)
+
+#define SSE2_OUT(OFF, V)											\
+{																	\
+	if(in) V = _mm_xor_si128(V, LOADU(in + (OFF)));					\
+	STOREU(out + (OFF), V);											\
+}
+
+KRIPTO_TARGET("sse2")
+static void salsa20_sse2
+(
+	unsigned int r,
+	const uint32_t *x,
+	const uint8_t *in,
+	uint8_t *out
+)
+{
+	__m128i v[16];
+	__m128i k[16];
+	__m128i t[4];
+	uint32_t c[8];
+	unsigned int i;
+
+	for(i = 0; i < 16; i++) k[i] = _mm_set1_epi32((int)x[i]);
+	salsa20_counters(x, c, 4);
+	k[8] = LOADU(c);
+	k[9] = LOADU(c + 4);
+
+	for(i = 0; i < 16; i++) v[i] = k[i];
+
+	VROUNDS(v, r, _mm_add_epi32, _mm_xor_si128,
+		SSE2_ROL7, SSE2_ROL9, SSE2_ROL13, SSE2_ROL18);
+
+	for(i = 0; i < 16; i++) v[i] = _mm_add_epi32(v[i], k[i]);
+
+	for(i = 0; i < 16; i += 4)
+	{
+		TRANSPOSE4(v[i], v[i + 1], v[i + 2], v[i + 3], t,
+			_mm_unpacklo_epi32, _mm_unpackhi_epi32,
+			_mm_unpacklo_epi64, _mm_unpackhi_epi64);
+
+		SSE2_OUT((i << 2), v[i]);
+		SSE2_OUT((i << 2) + 64, v[i + 1]);
+		SSE2_OUT((i << 2) + 128, v[i + 2]);
+		SSE2_OUT((i << 2) + 192, v[i + 3]);
+	}
+}
+
+#define AVX2_ROL(X, N) \
+	_mm256_or_si256(_mm256_slli_epi32(X, N), _mm256_srli_epi32(X, 32 - (N)))
+#define AVX2_ROL7(X) AVX2_ROL(X, 7)
+#define AVX2_ROL9(X) AVX2_ROL(X, 9)
+#define AVX2_ROL13(X) AVX2_ROL(X, 13)
+#define AVX2_ROL18(X) AVX2_ROL(X, 18)
+
+#define AVX2_OUT(OFF, V)											\
+{																	\
+	if(in) V = _mm256_xor_si256(V, LOADU256(in + (OFF)));			\
+	STOREU256(out + (OFF), V);										\
+}
+
+KRIPTO_TARGET("avx2")
+static void salsa20_avx2
+(
+	unsigned int r,
+	const uint32_t *x,
+	const uint8_t *in,
+	uint8_t *out
+)
+{
+	__m256i v[16];
+	__m256i k[16];
+	__m256i t[4];
+	uint32_t c[16];
+	unsigned int i;
+
+	for(i = 0; i < 16; i++) k[i] = _mm256_set1_epi32((int)x[i]);
+	salsa20_counters(x, c, 8);
+	k[8] = LOADU256(c);
+	k[9] = LOADU256(c + 8);
+
+	for(i = 0; i < 16; i++) v[i] = k[i];
+
+	VROUNDS(v, r, _mm256_add_epi32, _mm256_xor_si256,
+		AVX2_ROL7, AVX2_ROL9, AVX2_ROL13, AVX2_ROL18);
+
+	for(i = 0; i < 16; i++) v[i] = _mm256_add_epi32(v[i], k[i]);
+
+	/* lane 0 of v[4g + j] is now block j, lane 1 block j + 4 */
+	for(i = 0; i < 16; i += 4)
+	{
+		TRANSPOSE4(v[i], v[i + 1], v[i + 2], v[i + 3], t,
+			_mm256_unpacklo_epi32, _mm256_unpackhi_epi32,
+			_mm256_unpacklo_epi64, _mm256_unpackhi_epi64);
+	}
+
+	for(i = 0; i < 4; i++)
+	{
+		k[0] = _mm256_permute2x128_si256(v[i], v[i + 4], 0x20);
+		k[1] = _mm256_permute2x128_si256(v[i + 8], v[i + 12], 0x20);
+		k[2] = _mm256_permute2x128_si256(v[i], v[i + 4], 0x31);
+		k[3] = _mm256_permute2x128_si256(v[i + 8], v[i + 12], 0x31);
+
+		AVX2_OUT((i << 6), k[0]);
+		AVX2_OUT((i << 6) + 32, k[1]);
+		AVX2_OUT((i << 6) + 256, k[2]);
+		AVX2_OUT((i << 6) + 288, k[3]);
+	}
+}
+
+#endif
+
+static void salsa20_add(kripto_stream *s, unsigned int n)
+{
+	s->x[8] += n;
+	if(s->x[8] < n) s->x[9]++;
+}
+
+/* keystream of n whole blocks, XORed with in unless it is 0 */
+static void salsa20_blocks
 (
 	kripto_stream *s,
-	const void *in,
-	void *out,
-	size_t len
+	const uint8_t *in,
+	uint8_t *out,
+	size_t n
 )
 {
-	size_t i;
+	#ifdef KRIPTO_X86_SIMD
+	const unsigned int cpu = kripto_cpu();
 
-	for(i = 0; i < len; i++)
+	if(cpu & KRIPTO_CPU_AVX2)
 	{
-		if(s->used == 64)
+		for(; n >= 8; n -= 8)
 		{
-			salsa20_core(s->r, s->x, s->buf);
-			s->used = 0;
+			salsa20_avx2(s->r, s->x, in, out);
+			salsa20_add(s, 8);
+			if(in) in += 512;
+			out += 512;
+		}
+	}
 
-			if(!++s->x[8])
-				++s->x[9];
+	if(cpu & KRIPTO_CPU_SSE2)
+	{
+		for(; n >= 4; n -= 4)
+		{
+			salsa20_sse2(s->r, s->x, in, out);
+			salsa20_add(s, 4);
+			if(in) in += 256;
+			out += 256;
+		}
+	}
+	#endif
+
+	for(; n; n--)
+	{
+		if(in)
+		{
+			salsa20_core(s->r, s->x, s->buf);
+			kripto_memxor(in, s->buf, out, 64);
+			in += 64;
+		}
+		else
+		{
+			salsa20_core(s->r, s->x, out);
 		}
 
-		U8(out)[i] = CU8(in)[i] ^ s->buf[s->used++];
+		salsa20_add(s, 1);
+		out += 64;
+	}
+}
+
+static void salsa20_crypt
+(
+	kripto_stream *s,
+	const void *in,
+	void *out,
+	size_t len
+)
+{
+	size_t n;
+
+	/* rest of the buffered block */
+	n = 64 - s->used;
+	if(n > len) n = len;
+	kripto_memxor(in, s->buf + s->used, out, n);
+	s->used += n;
+	len -= n;
+	in = CU8(in) + n;
+	out = U8(out) + n;
+
+	n = len >> 6;
+	if(n)
+	{
+		salsa20_blocks(s, CU8(in), U8(out), n);
+		in = CU8(in) + (n << 6);
+		out = U8(out) + (n << 6);
+		len &= 63;
+	}
+
+	if(len)
+	{
+		salsa20_core(s->r, s->x, s->buf);
+		salsa20_add(s, 1);
+		kripto_memxor(in, s->buf, out, len);
+		s->used = len;
 	}
 }
 
@@ -149,20 +387,44 @@ static void salsa20_prng
 	size_t len
 )
 {
-	size_t i;
+	size_t n;
+
+	n = 64 - s->used;
+	if(n > len) n = len;
+	memcpy(out, s->buf + s->used, n);
+	s->used += n;
+	len -= n;
+	out = U8(out) + n;
 
-	for(i = 0; i < len; i++)
+	n = len >> 6;
+	if(n)
 	{
-		if(s->used == 64)
-		{
-			salsa20_core(s->r, s->x, s->buf);
-			s->used = 0;
+		salsa20_blocks(s, 0, U8(out), n);
+		out = U8(out) + (n << 6);
+		len &= 63;
+	}
 
-			if(!++s->x[8])
-				++s->x[9];
-		}
+	if(len)
+	{
+		salsa20_core(s->r, s->x, s->buf);
+		salsa20_add(s, 1);
+		memcpy(out, s->buf, len);
+		s->used = len;
+	}
+}
+
+static void salsa20_seek(kripto_stream *s, uint64_t offset)
+{
+	s->x[8] = (uint32_t)(offset >> 6);
+	s->x[9] = (uint32_t)(offset >> 38);
+	s->used = 64;
+
+	if(offset & 63)
+	{
+		salsa20_core(s->r, s->x, s->buf);
+		s->used = offset & 63;
 
-		U8(out)[i] = s->buf[s->used++];
+		salsa20_add(s, 1);
 	}
 }
 
@@ -308,7 +570,10 @@ static const struct kripto_stream_desc salsa20 =
 	&salsa20_recreate,
 	&salsa20_crypt,
 	&salsa20_crypt,
+	0, /* encrypt_parallel */
+	0, /* decrypt_parallel */
 	&salsa20_prng,
+	&salsa20_seek,
 	&salsa20_destroy,
 	32, /* max key */
 	24 /* max iv */
@@ -74,7 +74,7 @@ static kripto_stream *skein1024_recreate
 	unsigned int i;
 
 	s->r = r;
-	s->i = 0;
+	s->i = 128;
 	memset(k, 0, 128);
 	memset(s->ctr, 0, 128);
 
@@ -88,10 +88,11 @@ static kripto_stream *skein1024_recreate
 		else block = key_len;
 
 		memcpy(s->buf, key, block);
-		memset(s->buf, 0, 128 - block);
+		memset(s->buf + block, 0, 128 - block);
 
 		POS_ADD(tweak, block);
 
+		key = CU8(key) + block;
 		key_len -= block;
 
 		if(!key_len) tweak[15] |= 0x80; /* add final */
@@ -136,10 +137,11 @@ static kripto_stream *skein1024_recreate
 		else block = iv_len;
 
 		memcpy(s->buf, iv, block);
-		memset(s->buf, 0, 128 - block);
+		memset(s->buf + block, 0, 128 - block);
 
 		POS_ADD(tweak, block);
 
+		iv = CU8(iv) + block;
 		iv_len -= block;
 
 		if(!iv_len) tweak[15] |= 0x80; /* add final */
@@ -165,6 +167,28 @@ static kripto_stream *skein1024_recreate
 	return s;
 }
 
+static void skein1024_output(kripto_stream *s)
+{
+	unsigned int i;
+
+	kripto_block_encrypt(s->block, s->ctr, s->buf);
+	for(i = 0; i < 128; i++) s->buf[i] ^= s->ctr[i];
+
+	if(!++s->ctr[0])
+	if(!++s->ctr[1])
+	if(!++s->ctr[2])
+	if(!++s->ctr[3])
+	if(!++s->ctr[4])
+	if(!++s->ctr[5])
+	if(!++s->ctr[6])
+	{
+		s->ctr[7]++;
+		assert(s->ctr[7]);
+	}
+
+	s->i = 0;
+}
+
 static void skein1024_crypt
 (
 	kripto_stream *s,
@@ -177,26 +201,7 @@ static void skein1024_crypt
 
 	for(i = 0; i < len; i++)
 	{
-		if(s->i == 128)
-		{
-			kripto_block_encrypt(s->block, s->ctr, s->buf);
-			for(s->i = 0; s->i < 128; s->i++)
-				s->buf[s->i] ^= s->ctr[s->i];
-
-			if(!++s->ctr[0])
-			if(!++s->ctr[1])
-			if(!++s->ctr[2])
-			if(!++s->ctr[3])
-			if(!++s->ctr[4])
-			if(!++s->ctr[5])
-			if(!++s->ctr[6])
-			{
-				s->ctr[7]++;
-				assert(s->ctr[7]);
-			}
-
-			s->i = 0;
-		}
+		if(s->i == 128) skein1024_output(s);
 
 		U8(out)[i] = CU8(in)[i] ^ s->buf[s->i++];
 	}
@@ -208,31 +213,24 @@ static void skein1024_prng(kripto_stream *s, void *out, size_t len)
 
 	for(i = 0; i < len; i++)
 	{
-		if(s->i == 128)
-		{
-			kripto_block_encrypt(s->block, s->ctr, s->buf);
-			for(s->i = 0; s->i < 128; s->i++)
-				s->buf[s->i] ^= s->ctr[s->i];
-
-			if(!++s->ctr[0])
-			if(!++s->ctr[1])
-			if(!++s->ctr[2])
-			if(!++s->ctr[3])
-			if(!++s->ctr[4])
-			if(!++s->ctr[5])
-			if(!++s->ctr[6])
-			{
-				s->ctr[7]++;
-				assert(s->ctr[7]);
-			}
-
-			s->i = 0;
-		}
+		if(s->i == 128) skein1024_output(s);
 
 		U8(out)[i] = s->buf[s->i++];
 	}
 }
 
+static void skein1024_seek(kripto_stream *s, uint64_t offset)
+{
+	STORE64L(offset / 128, s->ctr);
+	s->i = 128;
+
+	if(offset % 128)
+	{
+		skein1024_output(s);
+		s->i = offset % 128;
+	}
+}
+
 static kripto_stream *skein1024_create
 (
 	const kripto_stream_desc *desc,
@@ -278,7 +276,10 @@ static const kripto_stream_desc skein1024 =
 	&skein1024_recreate,
 	&skein1024_crypt,
 	&skein1024_crypt,
+	0, /* encrypt_parallel */
+	0, /* decrypt_parallel */
 	&skein1024_prng,
+	&skein1024_seek,
 	&skein1024_destroy,
 	UINT_MAX, /* max key */
 	UINT_MAX /* max iv */
@@ -74,7 +74,7 @@ static kripto_stream *skein256_recreate
 	unsigned int i;
 
 	s->r = r;
-	s->i = 0;
+	s->i = 32;
 	memset(k, 0, 32);
 	memset(s->ctr, 0, 32);
 
@@ -88,10 +88,11 @@ static kripto_stream *skein256_recreate
 		else block = key_len;
 
 		memcpy(s->buf, key, block);
-		memset(s->buf, 0, 32 - block);
+		memset(s->buf + block, 0, 32 - block);
 
 		POS_ADD(tweak, block);
 
+		key = CU8(key) + block;
 		key_len -= block;
 
 		if(!key_len) tweak[15] |= 0x80; /* add final */
@@ -136,10 +137,11 @@ static kripto_stream *skein256_recreate
 		else block = iv_len;
 
 		memcpy(s->buf, iv, block);
-		memset(s->buf, 0, 32 - block);
+		memset(s->buf + block, 0, 32 - block);
 
 		POS_ADD(tweak, block);
 
+		iv = CU8(iv) + block;
 		iv_len -= block;
 
 		if(!iv_len) tweak[15] |= 0x80; /* add final */
@@ -165,6 +167,28 @@ static kripto_stream *skein256_recreate
 	return s;
 }
 
+static void skein256_output(kripto_stream *s)
+{
+	unsigned int i;
+
+	kripto_block_encrypt(s->block, s->ctr, s->buf);
+	for(i = 0; i < 32; i++) s->buf[i] ^= s->ctr[i];
+
+	if(!++s->ctr[0])
+	if(!++s->ctr[1])
+	if(!++s->ctr[2])
+	if(!++s->ctr[3])
+	if(!++s->ctr[4])
+	if(!++s->ctr[5])
+	if(!++s->ctr[6])
+	{
+		s->ctr[7]++;
+		assert(s->ctr[7]);
+	}
+
+	s->i = 0;
+}
+
 static void skein256_crypt
 (
 	kripto_stream *s,
@@ -177,26 +201,7 @@ static void skein256_crypt
 
 	for(i = 0; i < len; i++)
 	{
-		if(s->i == 32)
-		{
-			kripto_block_encrypt(s->block, s->ctr, s->buf);
-			for(s->i = 0; s->i < 32; s->i++)
-				s->buf[s->i] ^= s->ctr[s->i];
-
-			if(!++s->ctr[0])
-			if(!++s->ctr[1])
-			if(!++s->ctr[2])
-			if(!++s->ctr[3])
-			if(!++s->ctr[4])
-			if(!++s->ctr[5])
-			if(!++s->ctr[6])
-			{
-				s->ctr[7]++;
-				assert(s->ctr[7]);
-			}
-
-			s->i = 0;
-		}
+		if(s->i == 32) skein256_output(s);
 
 		U8(out)[i] = CU8(in)[i] ^ s->buf[s->i++];
 	}
@@ -208,31 +213,24 @@ static void skein256_prng(kripto_stream *s, void *out, size_t len)
 
 	for(i = 0; i < len; i++)
 	{
-		if(s->i == 32)
-		{
-			kripto_block_encrypt(s->block, s->ctr, s->buf);
-			for(s->i = 0; s->i < 32; s->i++)
-				s->buf[s->i] ^= s->ctr[s->i];
-
-			if(!++s->ctr[0])
-			if(!++s->ctr[1])
-			if(!++s->ctr[2])
-			if(!++s->ctr[3])
-			if(!++s->ctr[4])
-			if(!++s->ctr[5])
-			if(!++s->ctr[6])
-			{
-				s->ctr[7]++;
-				assert(s->ctr[7]);
-			}
-
-			s->i = 0;
-		}
+		if(s->i == 32) skein256_output(s);
 
 		U8(out)[i] = s->buf[s->i++];
 	}
 }
 
+static void skein256_seek(kripto_stream *s, uint64_t offset)
+{
+	STORE64L(offset / 32, s->ctr);
+	s->i = 32;
+
+	if(offset % 32)
+	{
+		skein256_output(s);
+		s->i = offset % 32;
+	}
+}
+
 static kripto_stream *skein256_create
 (
 	const kripto_stream_desc *desc,
@@ -278,7 +276,10 @@ static const kripto_stream_desc skein256 =
 	&skein256_recreate,
 	&skein256_crypt,
 	&skein256_crypt,
+	0, /* encrypt_parallel */
+	0, /* decrypt_parallel */
 	&skein256_prng,
+	&skein256_seek,
 	&skein256_destroy,
 	UINT_MAX, /* max key */
 	UINT_MAX /* max iv */
@@ -0,0 +1,216 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ * 
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kripto/memwipe.h>
+#include <kripto/thread.h>
+
+#if defined(KRIPTO_THREADS) && defined(KRIPTO_WINDOWS)
+#include <windows.h>
+typedef HANDLE thread_t;
+#elif defined(KRIPTO_THREADS)
+#include <pthread.h>
+typedef pthread_t thread_t;
+#endif
+
+#ifdef KRIPTO_THREADS
+
+struct job
+{
+	void (*f)(void *, unsigned int);
+	void *arg;
+	unsigned int i;
+	thread_t thread;
+	int started;
+};
+
+#ifdef KRIPTO_WINDOWS
+
+static DWORD WINAPI thread_main(LPVOID arg)
+{
+	struct job *job = arg;
+
+	job->f(job->arg, job->i);
+
+	return 0;
+}
+
+static int thread_start(struct job *job)
+{
+	job->thread = CreateThread(0, 0, &thread_main, job, 0, 0);
+
+	return job->thread != 0;
+}
+
+static void thread_join(struct job *job)
+{
+	(void)WaitForSingleObject(job->thread, INFINITE);
+	(void)CloseHandle(job->thread);
+}
+
+#else
+
+static void *thread_main(void *arg)
+{
+	struct job *job = arg;
+
+	job->f(job->arg, job->i);
+
+	return 0;
+}
+
+static int thread_start(struct job *job)
+{
+	return !pthread_create(&job->thread, 0, &thread_main, job);
+}
+
+static void thread_join(struct job *job)
+{
+	(void)pthread_join(job->thread, 0);
+}
+
+#endif
+
+void kripto_thread_run
+(
+	void (*f)(void *, unsigned int),
+	void *arg,
+	unsigned int n
+)
+{
+	struct job *job;
+	unsigned int i;
+
+	assert(f);
+
+	if(n < 2) goto serial;
+
+	job = malloc(n * sizeof(struct job));
+	if(!job) goto serial;
+
+	/* part 0 runs in the calling thread */
+	for(i = 1; i < n; i++)
+	{
+		job[i].f = f;
+		job[i].arg = arg;
+		job[i].i = i;
+		job[i].started = thread_start(&job[i]);
+	}
+
+	f(arg, 0);
+
+	/* parts without a thread run here too */
+	for(i = 1; i < n; i++)
+	{
+		if(job[i].started) thread_join(&job[i]);
+		else f(arg, i);
+	}
+
+	free(job);
+
+	return;
+
+serial:
+	for(i = 0; i < n; i++) f(arg, i);
+}
+
+#else
+
+void kripto_thread_run
+(
+	void (*f)(void *, unsigned int),
+	void *arg,
+	unsigned int n
+)
+{
+	unsigned int i;
+
+	assert(f);
+
+	for(i = 0; i < n; i++) f(arg, i);
+}
+
+#endif
+
+int kripto_thread_blocks_init
+(
+	struct kripto_thread_blocks *job,
+	void *s,
+	const void *in,
+	void *out,
+	size_t len,
+	unsigned int block_size,
+	size_t size,
+	unsigned int threads
+)
+{
+	assert(block_size);
+
+	if(threads > len / KRIPTO_THREAD_MIN) threads = len / KRIPTO_THREAD_MIN;
+	if(threads < 2) return -1;
+
+	job->mem = 0;
+	if(size)
+	{
+		job->mem = malloc(threads * size);
+		if(!job->mem) return -1;
+	}
+
+	job->s = s;
+	job->in = in;
+	job->out = out;
+	job->size = size;
+	job->blocks = len / block_size;
+	job->n = threads;
+
+	return 0;
+}
+
+void kripto_thread_blocks_chain
+(
+	struct kripto_thread_blocks *job,
+	const void *first,
+	unsigned int block_size
+)
+{
+	unsigned int i;
+
+	memcpy(job->mem, first, block_size);
+
+	for(i = 1; i < job->n; i++)
+	{
+		memcpy
+		(
+			job->mem + i * job->size,
+			job->in + (kripto_thread_part(job->blocks, job->n, i) - 1)
+				* block_size,
+			block_size
+		);
+	}
+}
+
+void kripto_thread_blocks_run
+(
+	struct kripto_thread_blocks *job,
+	void (*f)(void *, unsigned int)
+)
+{
+	kripto_thread_run(f, job, job->n);
+
+	kripto_memwipe(job->mem, job->n * job->size);
+	free(job->mem);
+}
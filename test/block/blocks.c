@@ -0,0 +1,114 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <kripto/block.h>
+#include <kripto/block/rijndael128.h>
+#include <kripto/block/rijndael256.h>
+
+#include "../test.h"
+
+/* crosses the 4 and 8 block groups, with every tail length */
+#define N 17
+
+static char name[96];
+
+static void test
+(
+	const char *cipher,
+	const kripto_block_desc *desc,
+	unsigned int key_len
+)
+{
+	kripto_block *s;
+	uint8_t key[32];
+	uint8_t pt[N * 32];
+	uint8_t ref[N * 32];
+	uint8_t t[N * 32];
+	unsigned int bs;
+	unsigned int n;
+	unsigned int i;
+
+	for(i = 0; i < 32; i++) key[i] = i;
+	for(i = 0; i < N * 32; i++) pt[i] = i * 7 + (i >> 4);
+
+	s = kripto_block_create(desc, 0, key, key_len);
+	if(!s) test_error(cipher);
+
+	bs = kripto_block_size(desc);
+
+	/* n single blocks */
+	for(i = 0; i < N; i++) kripto_block_encrypt(s, pt + i * bs, ref + i * bs);
+
+	for(n = 1; n <= N; n++)
+	{
+		(void)snprintf
+		(
+			name,
+			sizeof(name),
+			"kripto_block_encrypt_blocks: %s, %u byte key, %u blocks",
+			cipher,
+			key_len,
+			n
+		);
+
+		memset(t, 0, sizeof(t));
+		kripto_block_encrypt_blocks(s, pt, t, n);
+		test_cmp(name, t, ref, n * bs);
+
+		/* nothing past the last block */
+		for(i = n * bs; i < N * bs; i++) if(t[i]) break;
+		if(i != N * bs) test_fail(name);
+
+		/* in place */
+		memcpy(t, pt, n * bs);
+		kripto_block_encrypt_blocks(s, t, t, n);
+		test_cmp(name, t, ref, n * bs);
+
+		(void)snprintf
+		(
+			name,
+			sizeof(name),
+			"kripto_block_decrypt_blocks: %s, %u byte key, %u blocks",
+			cipher,
+			key_len,
+			n
+		);
+
+		kripto_block_decrypt_blocks(s, ref, t, n);
+		test_cmp(name, t, pt, n * bs);
+
+		/* in place */
+		memcpy(t, ref, n * bs);
+		kripto_block_decrypt_blocks(s, t, t, n);
+		test_cmp(name, t, pt, n * bs);
+	}
+
+	kripto_block_destroy(s);
+}
+
+int main(void)
+{
+	unsigned int key_len;
+
+	for(key_len = 16; key_len <= 32; key_len += 8)
+	{
+		test("rijndael128", kripto_block_rijndael128, key_len);
+		test("rijndael256", kripto_block_rijndael256, key_len);
+	}
+
+	return test_result;
+}
@@ -0,0 +1,40 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <kripto/hash.h>
+#include <kripto/hash/blake2bp.h>
+
+int main(void)
+{
+	uint8_t hash[64];
+	uint8_t buf[256];
+	unsigned int i;
+
+	for(i = 0; i < 256; i++) buf[i] = (uint8_t)i;
+
+	puts("b5ef811a8038f70b628fa8b294daae7492b1ebe343a80eaabbf1f6ae664dd67b9d90b0120791eab81dc96985f28849f6a305186a85501b405114bfa678df9380");
+	kripto_hash_all(kripto_hash_blake2bp, 0, buf, 0, hash, 64);
+	for(i = 0; i < 64; i++) printf("%.2x", hash[i]);
+	putchar('\n');
+
+	puts("ef1132d866055876c15959557d79cff0539b93b26f47bf4183748921df72c3ed94b0a5e95e17a4bbc59437f34564e60d20923dd643420f5ca25b2ca7ec1ceda4");
+	kripto_hash_all(kripto_hash_blake2bp, 0, buf, 256, hash, 64);
+	for(i = 0; i < 64; i++) printf("%.2x", hash[i]);
+	putchar('\n');
+
+	return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <kripto/hash.h>
+#include <kripto/hash/blake2sp.h>
+
+int main(void)
+{
+	uint8_t hash[32];
+	uint8_t buf[256];
+	unsigned int i;
+
+	for(i = 0; i < 256; i++) buf[i] = (uint8_t)i;
+
+	puts("dd0e891776933f43c7d032b08a917e25741f8aa9a12c12e1cac8801500f2ca4f");
+	kripto_hash_all(kripto_hash_blake2sp, 0, buf, 0, hash, 32);
+	for(i = 0; i < 32; i++) printf("%.2x", hash[i]);
+	putchar('\n');
+
+	puts("5140cfbe0c4ec095dd01713dc470e0ca049e5ba8671984cd28ab510dffee97cd");
+	kripto_hash_all(kripto_hash_blake2sp, 0, buf, 256, hash, 32);
+	for(i = 0; i < 32; i++) printf("%.2x", hash[i]);
+	putchar('\n');
+
+	return 0;
+}
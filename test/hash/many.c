@@ -0,0 +1,115 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <kripto/hash.h>
+#include <kripto/hash/blake2b.h>
+#include <kripto/hash/keccak1600.h>
+#include <kripto/hash/md5.h>
+#include <kripto/hash/sha1.h>
+#include <kripto/hash/sha2_256.h>
+#include <kripto/hash/sha2_512.h>
+
+#include "../test.h"
+
+#define N 17
+
+/* on and around the padding boundaries of 64, 128 and Keccak rates */
+static const size_t lens[N] =
+{
+	0, 1, 55, 56, 63, 64, 65, 71, 72,
+	111, 112, 127, 128, 129, 135, 136, 299
+};
+
+static const struct
+{
+	const char *name;
+	const kripto_hash_desc *const *desc;
+} hashes[] =
+{
+	{"md5", &kripto_hash_md5},
+	{"sha1", &kripto_hash_sha1},
+	{"sha2_256", &kripto_hash_sha2_256},
+	{"sha2_512", &kripto_hash_sha2_512},
+	{"keccak1600", &kripto_hash_keccak1600},
+	{"blake2b", &kripto_hash_blake2b}
+};
+
+int main(void)
+{
+	const kripto_hash_desc *desc;
+	uint8_t msg[N][300];
+	uint8_t out[N][64];
+	uint8_t ref[64];
+	const void *in[N];
+	size_t in_len[N];
+	void *o[N];
+	char name[64];
+	size_t out_len[2];
+	size_t n;
+	unsigned int h;
+	unsigned int l;
+	unsigned int i;
+
+	for(i = 0; i < N; i++)
+	{
+		for(l = 0; l < 300; l++) msg[i][l] = i * 300 + l;
+		o[i] = out[i];
+	}
+
+	for(h = 0; h < sizeof(hashes) / sizeof(*hashes); h++)
+	{
+		desc = *hashes[h].desc;
+
+		/* full and truncated output */
+		out_len[0] = kripto_hash_maxout(desc);
+		if(out_len[0] > 64) out_len[0] = 64;
+		out_len[1] = 16;
+
+		for(l = 0; l < 2; l++) for(n = 1; n <= N; n++)
+		{
+			(void)snprintf
+			(
+				name,
+				sizeof(name),
+				"kripto_hash_many: %s, %u bytes, %u messages",
+				hashes[h].name,
+				(unsigned int)out_len[l],
+				(unsigned int)n
+			);
+
+			/* a different length in each lane for each n */
+			for(i = 0; i < n; i++)
+			{
+				in[i] = msg[i];
+				in_len[i] = lens[(i + n) % N];
+			}
+
+			if(kripto_hash_many(desc, 0, in, in_len, o, n, out_len[l]))
+				test_error(name);
+
+			for(i = 0; i < n; i++)
+			{
+				if(kripto_hash_all(desc, 0, in[i], in_len[i], ref, out_len[l]))
+					test_error(name);
+
+				test_cmp(name, out[i], ref, out_len[l]);
+			}
+		}
+	}
+
+	return test_result;
+}
@@ -0,0 +1,233 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <kripto/hash.h>
+#include <kripto/hash/blake256.h>
+#include <kripto/hash/blake512.h>
+#include <kripto/hash/blake2s.h>
+#include <kripto/hash/blake2b.h>
+#include <kripto/hash/blake2sp.h>
+#include <kripto/hash/blake2bp.h>
+#include <kripto/hash/keccak1600.h>
+#include <kripto/hash/keccak800.h>
+#include <kripto/hash/md5.h>
+#include <kripto/hash/sha1.h>
+#include <kripto/hash/sha2_256.h>
+#include <kripto/hash/sha2_512.h>
+#include <kripto/hash/skein256.h>
+#include <kripto/hash/skein512.h>
+#include <kripto/hash/skein1024.h>
+#include <kripto/hash/tiger.h>
+#include <kripto/hash/whirlpool.h>
+
+#include "../test.h"
+
+#define TEST "kripto_hash_import: "
+
+/*
+ * Body offsets of the rounds and buffer index fields (-1 if the hash
+ * has no rounds) and the most rounds the hash can take (0 if any).
+ */
+static const struct
+{
+	const char *name;
+	const kripto_hash_desc *const *desc;
+	int r;
+	unsigned int r_max;
+	int i;
+} hashes[] =
+{
+	{"blake256", &kripto_hash_blake256, 0, 0, 108},
+	{"blake512", &kripto_hash_blake512, 0, 0, 212},
+	{"blake2s", &kripto_hash_blake2s, 0, 0, 112},
+	{"blake2b", &kripto_hash_blake2b, 0, 0, 220},
+	{"blake2sp", &kripto_hash_blake2sp, 0, 0, 1324},
+	{"blake2bp", &kripto_hash_blake2bp, 0, 0, 1356},
+	{"keccak1600", &kripto_hash_keccak1600, 0, 48, 8},
+	{"keccak800", &kripto_hash_keccak800, 0, 40, 8},
+	{"md5", &kripto_hash_md5, -1, 0, 88},
+	{"sha1", &kripto_hash_sha1, -1, 0, 92},
+	{"sha2_256", &kripto_hash_sha2_256, 104, 128, 108},
+	{"sha2_512", &kripto_hash_sha2_512, 208, 160, 212},
+	{"skein256", &kripto_hash_skein256, -1, 0, 4},
+	{"skein512", &kripto_hash_skein512, -1, 0, 4},
+	{"skein1024", &kripto_hash_skein1024, -1, 0, 4},
+	{"tiger", &kripto_hash_tiger, 0, 0, 100},
+	{"whirlpool", &kripto_hash_whirlpool, 0, 10, 164}
+};
+
+static char name[64];
+
+static const char *test_name(unsigned int h, const char *what)
+{
+	(void)snprintf(name, sizeof(name), TEST"%s %s", hashes[h].name, what);
+
+	return name;
+}
+
+static void store32(uint8_t *p, uint32_t x)
+{
+	p[0] = x;
+	p[1] = x >> 8;
+	p[2] = x >> 16;
+	p[3] = x >> 24;
+}
+
+/* a state with field at off set to x must be rejected */
+static void reject
+(
+	unsigned int h,
+	const char *what,
+	kripto_hash *s,
+	const uint8_t *state,
+	size_t size,
+	int off,
+	uint32_t x
+)
+{
+	uint8_t bad[2048];
+
+	memcpy(bad, state, size);
+	store32(bad + 4 + off, x);
+
+	if(kripto_hash_import(s, bad) != -1) test_fail(test_name(h, what));
+	else test_pass(test_name(h, what));
+}
+
+int main(void)
+{
+	const kripto_hash_desc *desc;
+	kripto_hash *s;
+	uint8_t msg[300];
+	uint8_t state[2048];
+	uint8_t ref[32];
+	uint8_t t[32];
+	kripto_hash *x;
+	size_t split[6];
+	size_t size;
+	size_t len;
+	unsigned int h;
+	unsigned int i;
+
+	for(i = 0; i < sizeof(msg); i++) msg[i] = i;
+
+	for(h = 0; h < sizeof(hashes) / sizeof(*hashes); h++)
+	{
+		desc = *hashes[h].desc;
+
+		len = kripto_hash_maxout(desc);
+		if(len > 32) len = 32;
+
+		size = kripto_hash_exportsize(desc);
+		if(size > sizeof(state)) test_error(test_name(h, "size"));
+
+		if(kripto_hash_all(desc, 0, msg, sizeof(msg), ref, len))
+			test_error(test_name(h, "hash_all"));
+
+		s = kripto_hash_create(desc, 0, len);
+		if(!s) test_error(test_name(h, "create"));
+
+		x = kripto_hash_create(desc, 0, len);
+		if(!x) test_error(test_name(h, "create"));
+
+		/* export, import and continue, around the block boundaries */
+		split[0] = 0;
+		split[1] = 1;
+		split[2] = kripto_hash_blocksize(desc) - 1;
+		split[3] = kripto_hash_blocksize(desc);
+		split[4] = kripto_hash_blocksize(desc) + 1;
+		split[5] = sizeof(msg);
+
+		for(i = 0; i < 6; i++)
+		{
+			(void)kripto_hash_recreate(s, 0, len);
+			kripto_hash_input(s, msg, split[i]);
+			kripto_hash_export(s, state);
+
+			kripto_hash_input(x, msg, 1);
+			if(kripto_hash_import(x, state))
+				test_fail(test_name(h, "import"));
+			kripto_hash_input(x, msg + split[i], sizeof(msg) - split[i]);
+			kripto_hash_output(x, t, len);
+			test_cmp(test_name(h, "export, import"), t, ref, len);
+		}
+
+		/* export between outputs */
+		(void)kripto_hash_recreate(s, 0, len);
+		kripto_hash_input(s, msg, sizeof(msg));
+		kripto_hash_output(s, t, len >> 1);
+		kripto_hash_export(s, state);
+		if(kripto_hash_import(x, state)) test_fail(test_name(h, "import"));
+		kripto_hash_output(x, t + (len >> 1), len - (len >> 1));
+		test_cmp(test_name(h, "output, export"), t, ref, len);
+
+		/* copy */
+		(void)kripto_hash_recreate(s, 0, len);
+		kripto_hash_input(s, msg, 100);
+		kripto_hash_copy(x, s);
+		kripto_hash_input(x, msg + 100, sizeof(msg) - 100);
+		kripto_hash_output(x, t, len);
+		test_cmp(test_name(h, "copy"), t, ref, len);
+
+		kripto_hash_destroy(x);
+
+		kripto_hash_export(s, state);
+
+		/* bad version and size */
+		state[0]++;
+		if(kripto_hash_import(s, state) != -1)
+			test_fail(test_name(h, "version"));
+		state[0]--;
+
+		state[1]++;
+		if(kripto_hash_import(s, state) != -1)
+			test_fail(test_name(h, "size"));
+		state[1]--;
+
+		/* corrupt rounds */
+		if(hashes[h].r >= 0)
+		{
+			reject(h, "0 rounds", s, state, size, hashes[h].r, 0);
+
+			if(hashes[h].r_max)
+			{
+				reject
+				(
+					h,
+					"too many rounds",
+					s,
+					state,
+					size,
+					hashes[h].r,
+					hashes[h].r_max + 1
+				);
+			}
+		}
+
+		/* corrupt buffer index */
+		reject(h, "index", s, state, size, hashes[h].i, 0xFFFFFFFF);
+
+		/* rejected imports leave s as it was */
+		kripto_hash_input(s, msg + 100, sizeof(msg) - 100);
+		kripto_hash_output(s, t, len);
+		test_cmp(test_name(h, "after reject"), t, ref, len);
+
+		kripto_hash_destroy(s);
+	}
+
+	return test_result;
+}
@@ -4,7 +4,7 @@
  * To the extent possible under law, the author(s) have dedicated
  * all copyright and related and neighboring rights to this software
  * to the public domain worldwide.
- * 
+ *
  * This software is distributed without any warranty.
  *
  * You should have received a copy of the CC0 Public Domain Dedication.
@@ -13,51 +13,277 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
+#include <kripto/hash.h>
+#include <kripto/mac.h>
 #include <kripto/mac/hmac.h>
 #include <kripto/hash/sha2_256.h>
 #include <kripto/scrypt.h>
 
-int main(void)
+/* RFC 7914 section 12 */
+static const struct
+{
+	const char *pass;
+	const char *salt;
+	uint64_t n;
+	uint32_t r;
+	uint32_t p;
+	uint8_t out[64];
+} vectors[4] =
 {
-	const uint8_t out[64] =
 	{
-		0x21, 0x01, 0xCB, 0x9B, 0x6A, 0x51, 0x1A, 0xAE,
-		0xAD, 0xDB, 0xBE, 0x09, 0xCF, 0x70, 0xF8, 0x81,
-		0xEC, 0x56, 0x8D, 0x57, 0x4A, 0x2F, 0xFD, 0x4D,
-		0xAB, 0xE5, 0xEE, 0x98, 0x20, 0xAD, 0xAA, 0x47,
-		0x8E, 0x56, 0xFD, 0x8F, 0x4B, 0xA5, 0xD0, 0x9F,
-		0xFA, 0x1C, 0x6D, 0x92, 0x7C, 0x40, 0xF4, 0xC3,
-		0x37, 0x30, 0x40, 0x49, 0xE8, 0xA9, 0x52, 0xFB,
-		0xCB, 0xF4, 0x5C, 0x6F, 0xA7, 0x7A, 0x41, 0xA4
-	};
+		"",
+		"",
+		16,
+		1,
+		1,
+		{
+			0x77, 0xD6, 0x57, 0x62, 0x38, 0x65, 0x7B, 0x20,
+			0x3B, 0x19, 0xCA, 0x42, 0xC1, 0x8A, 0x04, 0x97,
+			0xF1, 0x6B, 0x48, 0x44, 0xE3, 0x07, 0x4A, 0xE8,
+			0xDF, 0xDF, 0xFA, 0x3F, 0xED, 0xE2, 0x14, 0x42,
+			0xFC, 0xD0, 0x06, 0x9D, 0xED, 0x09, 0x48, 0xF8,
+			0x32, 0x6A, 0x75, 0x3A, 0x0F, 0xC8, 0x1F, 0x17,
+			0xE8, 0xD3, 0xE0, 0xFB, 0x2E, 0x0D, 0x36, 0x28,
+			0xCF, 0x35, 0xE2, 0x0C, 0x38, 0xD1, 0x89, 0x06
+		}
+	},
+	{
+		"password",
+		"NaCl",
+		1024,
+		8,
+		16,
+		{
+			0xFD, 0xBA, 0xBE, 0x1C, 0x9D, 0x34, 0x72, 0x00,
+			0x78, 0x56, 0xE7, 0x19, 0x0D, 0x01, 0xE9, 0xFE,
+			0x7C, 0x6A, 0xD7, 0xCB, 0xC8, 0x23, 0x78, 0x30,
+			0xE7, 0x73, 0x76, 0x63, 0x4B, 0x37, 0x31, 0x62,
+			0x2E, 0xAF, 0x30, 0xD9, 0x2E, 0x22, 0xA3, 0x88,
+			0x6F, 0xF1, 0x09, 0x27, 0x9D, 0x98, 0x30, 0xDA,
+			0xC7, 0x27, 0xAF, 0xB9, 0x4A, 0x83, 0xEE, 0x6D,
+			0x83, 0x60, 0xCB, 0xDF, 0xA2, 0xCC, 0x06, 0x40
+		}
+	},
+	{
+		"pleaseletmein",
+		"SodiumChloride",
+		16384,
+		8,
+		1,
+		{
+			0x70, 0x23, 0xBD, 0xCB, 0x3A, 0xFD, 0x73, 0x48,
+			0x46, 0x1C, 0x06, 0xCD, 0x81, 0xFD, 0x38, 0xEB,
+			0xFD, 0xA8, 0xFB, 0xBA, 0x90, 0x4F, 0x8E, 0x3E,
+			0xA9, 0xB5, 0x43, 0xF6, 0x54, 0x5D, 0xA1, 0xF2,
+			0xD5, 0x43, 0x29, 0x55, 0x61, 0x3F, 0x0F, 0xCF,
+			0x62, 0xD4, 0x97, 0x05, 0x24, 0x2A, 0x9A, 0xF9,
+			0xE6, 0x1E, 0x85, 0xDC, 0x0D, 0x65, 0x1E, 0x40,
+			0xDF, 0xCF, 0x01, 0x7B, 0x45, 0x57, 0x58, 0x87
+		}
+	},
+	{
+		"pleaseletmein",
+		"SodiumChloride",
+		1048576,
+		8,
+		1,
+		{
+			0x21, 0x01, 0xCB, 0x9B, 0x6A, 0x51, 0x1A, 0xAE,
+			0xAD, 0xDB, 0xBE, 0x09, 0xCF, 0x70, 0xF8, 0x81,
+			0xEC, 0x56, 0x8D, 0x57, 0x4A, 0x2F, 0xFD, 0x4D,
+			0xAB, 0xE5, 0xEE, 0x98, 0x20, 0xAD, 0xAA, 0x47,
+			0x8E, 0x56, 0xFD, 0x8F, 0x4B, 0xA5, 0xD0, 0x9F,
+			0xFA, 0x1C, 0x6D, 0x92, 0x7C, 0x40, 0xF4, 0xC3,
+			0x37, 0x30, 0x40, 0x49, 0xE8, 0xA9, 0x52, 0xFB,
+			0xCB, 0xF4, 0x5C, 0x6F, 0xA7, 0x7A, 0x41, 0xA4
+		}
+	}
+};
+
+/* n not a power of 2, r or p 0 */
+static const struct
+{
+	uint64_t n;
+	uint32_t r;
+	uint32_t p;
+} invalid[4] =
+{
+	{0, 1, 1},
+	{24, 1, 1},
+	{16, 0, 1},
+	{16, 1, 0}
+};
+
+/* kripto_scrypt_ex() with these thread counts must give the same keys */
+static const unsigned int threads[3] = {2, 3, 16};
+
+/* a workspace reused for each vector in turn, twice */
+static int ctx_test(unsigned int i, unsigned int flags)
+{
+	kripto_scrypt_ctx *ctx;
 	uint8_t buf[64];
-	unsigned int i;
+	unsigned int run;
+
+	ctx = kripto_scrypt_ctx_create
+	(
+		vectors[i].n,
+		vectors[i].r,
+		vectors[i].p,
+		4,
+		flags
+	);
+	if(!ctx) return -1;
+
+	for(run = 0; run < 2; run++)
+	{
+		if(kripto_scrypt_ctx_run
+		(
+			ctx,
+			kripto_mac_hmac(kripto_hash_sha2_256),
+			0,
+			vectors[i].pass,
+			strlen(vectors[i].pass),
+			vectors[i].salt,
+			strlen(vectors[i].salt),
+			buf,
+			64
+		)) break;
+
+		if(memcmp(buf, vectors[i].out, 64)) break;
+	}
+
+	kripto_scrypt_ctx_destroy(ctx);
+
+	return run == 2 ? 0 : -1;
+}
+
+static int invalid_test(unsigned int i)
+{
+	kripto_scrypt_ctx *ctx;
+	uint8_t buf[64];
+
+	ctx = kripto_scrypt_ctx_create
+	(
+		invalid[i].n,
+		invalid[i].r,
+		invalid[i].p,
+		1,
+		0
+	);
+	if(ctx)
+	{
+		kripto_scrypt_ctx_destroy(ctx);
+		return -1;
+	}
 
 	if(kripto_scrypt
 	(
-		kripto_mac_hmac,
-		kripto_hash_sha2_256,
+		kripto_mac_hmac(kripto_hash_sha2_256),
+		0,
+		invalid[i].n,
+		invalid[i].r,
+		invalid[i].p,
+		"",
+		0,
+		"",
 		0,
-		1048576,
-		8,
-		1,
-		"pleaseletmein",
-		13,
-		"SodiumChloride",
-		14,
 		buf,
 		64
-	))
+	) != -1) return -1;
+
+	return 0;
+}
+
+int main(void)
+{
+	uint8_t buf[64];
+	unsigned int i;
+	unsigned int t;
+
+	for(i = 0; i < 4; i++)
 	{
-		perror("kripto_scrypt() returned error");
-		return -1;
+		if(kripto_scrypt
+		(
+			kripto_mac_hmac(kripto_hash_sha2_256),
+			0,
+			vectors[i].n,
+			vectors[i].r,
+			vectors[i].p,
+			vectors[i].pass,
+			strlen(vectors[i].pass),
+			vectors[i].salt,
+			strlen(vectors[i].salt),
+			buf,
+			64
+		))
+		{
+			perror("kripto_scrypt() returned error");
+			return -1;
+		}
+
+		if(memcmp(buf, vectors[i].out, 64))
+		{
+			fprintf(stderr, "kripto_scrypt: vector %u FAIL\n", i + 1);
+			return -1;
+		}
 	}
 
-	for(i = 0; i < 64; i++) if(buf[i] != out[i])
+	/* the first three, split over threads */
+	for(i = 0; i < 3; i++) for(t = 0; t < 3; t++)
 	{
-		fputs("kripto_scrypt: FAIL\n", stderr);
-		return -1;
+		if(kripto_scrypt_ex
+		(
+			kripto_mac_hmac(kripto_hash_sha2_256),
+			0,
+			vectors[i].n,
+			vectors[i].r,
+			vectors[i].p,
+			threads[t],
+			vectors[i].pass,
+			strlen(vectors[i].pass),
+			vectors[i].salt,
+			strlen(vectors[i].salt),
+			buf,
+			64
+		))
+		{
+			perror("kripto_scrypt_ex() returned error");
+			return -1;
+		}
+
+		if(memcmp(buf, vectors[i].out, 64))
+		{
+			fprintf
+			(
+				stderr,
+				"kripto_scrypt_ex: vector %u, %u threads FAIL\n",
+				i + 1,
+				threads[t]
+			);
+			return -1;
+		}
+	}
+
+	/* the first three, from a reused workspace */
+	for(i = 0; i < 3; i++)
+	{
+		if(ctx_test(i, 0) || ctx_test(i, KRIPTO_SCRYPT_HUGEPAGES))
+		{
+			fprintf(stderr, "kripto_scrypt_ctx: vector %u FAIL\n", i + 1);
+			return -1;
+		}
+	}
+
+	/* rejected before any workspace is sized */
+	for(i = 0; i < 4; i++)
+	{
+		if(invalid_test(i))
+		{
+			fprintf(stderr, "kripto_scrypt: invalid %u FAIL\n", i + 1);
+			return -1;
+		}
 	}
 
 	puts("kripto_scrypt: OK");
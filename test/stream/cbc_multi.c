@@ -0,0 +1,147 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kripto/block.h>
+#include <kripto/block/rijndael128.h>
+#include <kripto/block/blowfish.h>
+#include <kripto/stream.h>
+#include <kripto/stream/cbc.h>
+
+#include "../test.h"
+
+/* more than two batches of 16 lanes */
+#define LANES 37
+
+/* most blocks in a lane */
+#define MAX 11
+
+static uint8_t in[LANES][MAX * 16];
+static uint8_t a[LANES][MAX * 16];
+static uint8_t b[LANES][MAX * 16];
+
+static char name[96];
+
+static void test(const char *cipher, const kripto_block_desc *block)
+{
+	kripto_stream_desc *desc;
+	kripto_stream *s1[LANES];
+	kripto_stream *s2[LANES];
+	const void *pt[LANES];
+	void *ct[LANES];
+	size_t len[LANES];
+	uint8_t key[16];
+	uint8_t iv[16];
+	unsigned int bs;
+	unsigned int run;
+	unsigned int i;
+	unsigned int j;
+
+	desc = kripto_stream_cbc(block);
+	if(!desc) test_error(cipher);
+
+	bs = kripto_block_size(block);
+
+	for(i = 0; i < 16; i++) key[i] = i;
+
+	for(i = 0; i < LANES; i++)
+	{
+		for(j = 0; j < 16; j++) iv[j] = i * 16 + j;
+
+		s1[i] = kripto_stream_create(desc, 0, key, 16, iv, bs);
+		if(!s1[i]) test_error(cipher);
+		s2[i] = kripto_stream_create(desc, 0, key, 16, iv, bs);
+		if(!s2[i]) test_error(cipher);
+	}
+
+	/* each run continues the streams left by the one before */
+	for(run = 0; run < 4; run++)
+	{
+		(void)snprintf
+		(
+			name,
+			sizeof(name),
+			"kripto_stream_cbc_encrypt_multi: %s, run %u%s",
+			cipher,
+			run,
+			run & 1 ? ", in place" : ""
+		);
+
+		for(i = 0; i < LANES; i++)
+		{
+			/* uneven lengths, some lanes empty */
+			len[i] = ((i * 7 + run * 3) % MAX) * bs;
+
+			for(j = 0; j < len[i]; j++) in[i][j] = i * 31 + j + run;
+
+			kripto_stream_encrypt(s1[i], in[i], a[i], len[i]);
+
+			if(run & 1)
+			{
+				memcpy(b[i], in[i], len[i]);
+				pt[i] = b[i];
+			}
+			else pt[i] = in[i];
+			ct[i] = b[i];
+		}
+
+		/* all lanes, then fewer than a batch */
+		if(run < 2)
+			kripto_stream_cbc_encrypt_multi(s2, pt, ct, len, LANES);
+		else
+			kripto_stream_cbc_encrypt_multi(s2, pt, ct, len, 5);
+
+		for(i = 0; i < (run < 2 ? LANES : 5); i++)
+			test_cmp(name, b[i], a[i], len[i]);
+
+		/* lanes left out go on serially */
+		for(; i < LANES; i++)
+		{
+			kripto_stream_encrypt(s2[i], in[i], b[i], len[i]);
+			test_cmp(name, b[i], a[i], len[i]);
+		}
+	}
+
+	/* every stream continues serially from where it was left */
+	(void)snprintf
+	(
+		name,
+		sizeof(name),
+		"kripto_stream_cbc_encrypt_multi: %s, serial after",
+		cipher
+	);
+
+	for(i = 0; i < LANES; i++)
+	{
+		kripto_stream_encrypt(s1[i], in[0], a[i], 2 * bs);
+		kripto_stream_encrypt(s2[i], in[0], b[i], 2 * bs);
+		test_cmp(name, b[i], a[i], 2 * bs);
+
+		kripto_stream_destroy(s1[i]);
+		kripto_stream_destroy(s2[i]);
+	}
+
+	free(desc);
+}
+
+int main(void)
+{
+	test("rijndael128", kripto_block_rijndael128);
+	test("blowfish", kripto_block_blowfish);
+
+	return test_result;
+}
@@ -0,0 +1,182 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kripto/block.h>
+#include <kripto/block/rijndael128.h>
+#include <kripto/block/blowfish.h>
+#include <kripto/stream.h>
+#include <kripto/stream/ecb.h>
+#include <kripto/stream/ctr.h>
+#include <kripto/stream/cbc.h>
+#include <kripto/stream/cfb.h>
+#include <kripto/stream/chacha.h>
+#include <kripto/stream/salsa20.h>
+
+#include "../test.h"
+
+/* enough for 4 threads of KRIPTO_THREAD_MIN bytes */
+#define LEN 300000
+
+static uint8_t in[LEN];
+static uint8_t a[LEN];
+static uint8_t b[LEN];
+
+/* bytes consumed serially before the parallel call */
+static const size_t pre[4] = {0, 1, 37, 1000};
+
+static char name[96];
+
+static void crypt
+(
+	kripto_stream *s,
+	unsigned int dec,
+	const void *src,
+	void *dst,
+	size_t len,
+	unsigned int threads
+)
+{
+	if(!threads)
+	{
+		if(dec) kripto_stream_decrypt(s, src, dst, len);
+		else kripto_stream_encrypt(s, src, dst, len);
+	}
+	else
+	{
+		if(dec) kripto_stream_decrypt_parallel(s, src, dst, len, threads);
+		else kripto_stream_encrypt_parallel(s, src, dst, len, threads);
+	}
+}
+
+static void test
+(
+	const char *stream,
+	const kripto_stream_desc *desc,
+	unsigned int iv_len
+)
+{
+	kripto_stream *s1;
+	kripto_stream *s2;
+	uint8_t key[16];
+	uint8_t iv[24];
+	size_t len;
+	size_t p;
+	unsigned int dec;
+	unsigned int threads;
+	unsigned int m;
+	unsigned int i;
+
+	for(i = 0; i < 16; i++) key[i] = i;
+	for(i = 0; i < 24; i++) iv[i] = i + 16;
+
+	for(dec = 0; dec < 2; dec++)
+	for(threads = 2; threads <= 4; threads += 2)
+	for(i = 0; i < 4; i++)
+	{
+		(void)snprintf
+		(
+			name,
+			sizeof(name),
+			"kripto_stream_%s_parallel: %s, %u threads, %u bytes before",
+			dec ? "decrypt" : "encrypt",
+			stream,
+			threads,
+			(unsigned int)pre[i]
+		);
+
+		s1 = kripto_stream_create(desc, 0, key, 16, iv, iv_len);
+		if(!s1) test_error(name);
+		s2 = kripto_stream_create(desc, 0, key, 16, iv, iv_len);
+		if(!s2) test_error(name);
+
+		m = kripto_stream_multof(s1);
+		p = pre[i] - pre[i] % m;
+		len = LEN - LEN % m;
+
+		crypt(s1, dec, in, a, p, 0);
+		crypt(s1, dec, in + p, a + p, len - p, 0);
+
+		crypt(s2, dec, in, b, p, 0);
+		if(i & 1)
+		{
+			/* in place */
+			memcpy(b + p, in + p, len - p);
+			crypt(s2, dec, b + p, b + p, len - p, threads);
+		}
+		else crypt(s2, dec, in + p, b + p, len - p, threads);
+
+		test_cmp(name, a, b, len);
+
+		/* both continue from the same point */
+		crypt(s1, dec, in, a, 64, 0);
+		crypt(s2, dec, in, b, 64, 0);
+		test_cmp(name, a, b, 64);
+
+		kripto_stream_destroy(s1);
+		kripto_stream_destroy(s2);
+	}
+}
+
+int main(void)
+{
+	const kripto_block_desc *block[2];
+	const char *block_name[2] = {"rijndael128", "blowfish"};
+	kripto_stream_desc *desc;
+	char stream[32];
+	size_t i;
+	unsigned int j;
+
+	for(i = 0; i < LEN; i++) in[i] = i * 7 + (i >> 8);
+
+	block[0] = kripto_block_rijndael128;
+	block[1] = kripto_block_blowfish;
+
+	for(j = 0; j < 2; j++)
+	{
+		(void)snprintf(stream, sizeof(stream), "ecb %s", block_name[j]);
+		desc = kripto_stream_ecb(block[j]);
+		if(!desc) test_error(stream);
+		test(stream, desc, 0);
+		free(desc);
+
+		(void)snprintf(stream, sizeof(stream), "ctr %s", block_name[j]);
+		desc = kripto_stream_ctr(block[j]);
+		if(!desc) test_error(stream);
+		test(stream, desc, kripto_block_size(block[j]));
+		free(desc);
+
+		(void)snprintf(stream, sizeof(stream), "cbc %s", block_name[j]);
+		desc = kripto_stream_cbc(block[j]);
+		if(!desc) test_error(stream);
+		test(stream, desc, kripto_block_size(block[j]));
+		free(desc);
+
+		(void)snprintf(stream, sizeof(stream), "cfb %s", block_name[j]);
+		desc = kripto_stream_cfb(block[j]);
+		if(!desc) test_error(stream);
+		test(stream, desc, kripto_block_size(block[j]));
+		free(desc);
+	}
+
+	test("chacha", kripto_stream_chacha, 8);
+	test("xchacha", kripto_stream_chacha, 24);
+	test("salsa20", kripto_stream_salsa20, 8);
+	test("xsalsa20", kripto_stream_salsa20, 24);
+
+	return test_result;
+}
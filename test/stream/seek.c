@@ -0,0 +1,117 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kripto/block.h>
+#include <kripto/block/rijndael128.h>
+#include <kripto/block/blowfish.h>
+#include <kripto/stream.h>
+#include <kripto/stream/ctr.h>
+#include <kripto/stream/chacha.h>
+#include <kripto/stream/salsa20.h>
+#include <kripto/stream/skein256.h>
+#include <kripto/stream/skein512.h>
+#include <kripto/stream/skein1024.h>
+
+#include "../test.h"
+
+/* past 1024 Skein-1024 blocks, where its counter carries into byte 1 */
+#define LEN 33280
+
+static const uint8_t zero[LEN];
+static uint8_t ref[LEN];
+
+/* out of order, on and around block boundaries */
+static const size_t offset[10] =
+{
+	4097, 0, 65, 1, 1000, 63, 64, 5488, 8190, 32700
+};
+
+static char name[96];
+
+static void test
+(
+	const char *stream,
+	const kripto_stream_desc *desc,
+	unsigned int iv_len
+)
+{
+	kripto_stream *s;
+	uint8_t key[16];
+	uint8_t iv[24];
+	uint8_t t[512];
+	unsigned int carry;
+	unsigned int i;
+
+	for(i = 0; i < 16; i++) key[i] = i;
+
+	/* the second pass makes counters taken from the IV carry */
+	for(carry = 0; carry < 2; carry++)
+	{
+		for(i = 0; i < 24; i++) iv[i] = carry ? 0xFF : i + 16;
+
+		s = kripto_stream_create(desc, 0, key, 16, iv, iv_len);
+		if(!s) test_error(stream);
+
+		/* keystream from the start */
+		kripto_stream_encrypt(s, zero, ref, LEN);
+
+		for(i = 0; i < 10; i++)
+		{
+			(void)snprintf
+			(
+				name,
+				sizeof(name),
+				"kripto_stream_seek: %s, %u%s",
+				stream,
+				(unsigned int)offset[i],
+				carry ? ", carry" : ""
+			);
+
+			kripto_stream_seek(s, offset[i]);
+			kripto_stream_encrypt(s, zero, t, 512);
+			test_cmp(name, t, ref + offset[i], 512);
+		}
+
+		kripto_stream_destroy(s);
+	}
+}
+
+int main(void)
+{
+	kripto_stream_desc *desc;
+
+	desc = kripto_stream_ctr(kripto_block_rijndael128);
+	if(!desc) test_error("ctr rijndael128");
+	test("ctr rijndael128", desc, 16);
+	free(desc);
+
+	desc = kripto_stream_ctr(kripto_block_blowfish);
+	if(!desc) test_error("ctr blowfish");
+	test("ctr blowfish", desc, 8);
+	free(desc);
+
+	test("chacha", kripto_stream_chacha, 8);
+	test("xchacha", kripto_stream_chacha, 24);
+	test("salsa20", kripto_stream_salsa20, 8);
+	test("xsalsa20", kripto_stream_salsa20, 24);
+	test("skein256", kripto_stream_skein256, 8);
+	test("skein512", kripto_stream_skein512, 8);
+	test("skein1024", kripto_stream_skein1024, 24);
+
+	return test_result;
+}
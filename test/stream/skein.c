@@ -0,0 +1,163 @@
+/*
+ * Written in 2026 by the kripto contributors
+ *
+ * To the extent possible under law, the author(s) have dedicated
+ * all copyright and related and neighboring rights to this software
+ * to the public domain worldwide.
+ *
+ * This software is distributed without any warranty.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication.
+ * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <kripto/stream.h>
+#include <kripto/stream/skein256.h>
+#include <kripto/stream/skein512.h>
+#include <kripto/stream/skein1024.h>
+
+#include "../test.h"
+
+/*
+ * Skein with KEY, CFG (output length 2^64 - 1 bits) and NONCE, then the
+ * OUTPUT blocks from counter 0.
+ * short: key 00 01 .. 1F, nonce F0 EF .. E9, keystream bytes 0 to 63.
+ * long: key 00 01 .. 80 and nonce F0 EF .. 70 (129 bytes each, more than
+ * one block), keystream bytes 100 to 163.
+ */
+static const struct
+{
+	const char *name;
+	const kripto_stream_desc *const *desc;
+	uint8_t short_out[64];
+	uint8_t long_out[64];
+} vectors[3] =
+{
+	{
+		"skein256",
+		&kripto_stream_skein256,
+		{
+			0x4B, 0x8E, 0x11, 0x55, 0xA5, 0xC9, 0x1A, 0x35,
+			0x34, 0x85, 0x05, 0x92, 0xB5, 0x61, 0x58, 0xC6,
+			0xD4, 0x7C, 0x9D, 0xA5, 0x18, 0x7B, 0x96, 0x6A,
+			0x16, 0xEC, 0x92, 0x59, 0x7E, 0x29, 0x69, 0x61,
+			0x0E, 0x2A, 0x1B, 0x1D, 0xD3, 0xEA, 0x76, 0x9A,
+			0xFF, 0x9E, 0x8A, 0xF0, 0xCF, 0xF3, 0x0E, 0xD8,
+			0x7C, 0x6B, 0xB3, 0x72, 0x94, 0x37, 0x05, 0xDB,
+			0x58, 0x07, 0xEC, 0x52, 0x1C, 0xBC, 0xF9, 0x72
+		},
+		{
+			0x6E, 0x7C, 0x94, 0xFE, 0x09, 0x2C, 0xCB, 0x7B,
+			0xDD, 0xD1, 0x9D, 0x57, 0x36, 0x98, 0xA2, 0xCC,
+			0xE4, 0xFF, 0xB0, 0x38, 0xDA, 0xD3, 0xAD, 0xA0,
+			0x1E, 0x46, 0x6C, 0xC2, 0xD9, 0xD4, 0xAB, 0x2C,
+			0xEB, 0xC2, 0x17, 0x8B, 0xE5, 0x5F, 0x96, 0xC9,
+			0xAC, 0xA6, 0xE2, 0x63, 0x38, 0xD6, 0x41, 0x4D,
+			0xBA, 0x1C, 0xEB, 0x66, 0xFB, 0xB7, 0xA2, 0xA9,
+			0x54, 0x05, 0x05, 0xC6, 0x9C, 0x2E, 0x95, 0x31
+		}
+	},
+	{
+		"skein512",
+		&kripto_stream_skein512,
+		{
+			0x75, 0xBE, 0xCA, 0xF2, 0xD7, 0xA9, 0xF8, 0x10,
+			0xDB, 0x12, 0x1D, 0xED, 0x63, 0x29, 0x81, 0x72,
+			0xB8, 0x39, 0xC2, 0x98, 0xE1, 0xA2, 0x5A, 0xA9,
+			0x00, 0x20, 0x3B, 0xBE, 0x56, 0x0D, 0x4D, 0x39,
+			0xE5, 0xFA, 0x8C, 0xB0, 0x27, 0xCC, 0x93, 0xD7,
+			0x94, 0x5C, 0x5D, 0xC1, 0xE8, 0xF6, 0x13, 0xE8,
+			0xE9, 0x52, 0xCB, 0xD5, 0x20, 0x19, 0x19, 0x51,
+			0x51, 0x4A, 0x9F, 0x65, 0x34, 0x6C, 0x26, 0x17
+		},
+		{
+			0x9C, 0xE9, 0xFA, 0xF7, 0x2F, 0x46, 0xAA, 0x0F,
+			0x13, 0x8A, 0x18, 0x6E, 0x4B, 0xA4, 0x9D, 0x61,
+			0xFB, 0x61, 0x09, 0xDE, 0x05, 0x86, 0x47, 0xF8,
+			0x1E, 0xDC, 0x29, 0x08, 0xAD, 0xE3, 0xED, 0x82,
+			0x27, 0x9B, 0x7B, 0x92, 0x9D, 0x6E, 0xC0, 0xC1,
+			0x9A, 0x4B, 0x59, 0xA7, 0xCD, 0x9B, 0xA6, 0xD0,
+			0x98, 0xA2, 0xDF, 0x55, 0x17, 0x62, 0x69, 0x47,
+			0xD2, 0xD4, 0xA2, 0x0A, 0x11, 0x41, 0xBA, 0xC4
+		}
+	},
+	{
+		"skein1024",
+		&kripto_stream_skein1024,
+		{
+			0xBE, 0x98, 0xA0, 0x59, 0x4D, 0xB8, 0xFF, 0x3D,
+			0x2B, 0xED, 0x99, 0x1D, 0x1A, 0xF4, 0xC2, 0xDC,
+			0x39, 0xFA, 0x6E, 0x82, 0x77, 0x92, 0x8A, 0x24,
+			0x52, 0xFB, 0x09, 0x61, 0x0C, 0xFA, 0x06, 0x4F,
+			0x5B, 0x6A, 0x0F, 0x13, 0x94, 0x5D, 0xEA, 0x18,
+			0x5E, 0x1B, 0x9E, 0x84, 0x3B, 0x1D, 0x83, 0x3E,
+			0x3D, 0x96, 0x05, 0x86, 0xE4, 0xE2, 0xCA, 0x2B,
+			0x6E, 0xB9, 0x92, 0x01, 0x1F, 0x03, 0xC6, 0xB1
+		},
+		{
+			0x22, 0x44, 0xD7, 0x1C, 0x95, 0x37, 0x33, 0x82,
+			0x41, 0x38, 0x52, 0x7B, 0x12, 0xE1, 0x55, 0x26,
+			0x73, 0xB0, 0xE4, 0xE2, 0x18, 0xAA, 0x18, 0xE1,
+			0xF6, 0x7A, 0x5D, 0x86, 0x68, 0xEB, 0x4C, 0x24,
+			0xF4, 0xE2, 0x4E, 0x18, 0x1E, 0xD1, 0xF4, 0x06,
+			0x39, 0x59, 0xD9, 0x31, 0x15, 0xBF, 0x54, 0x88,
+			0xEC, 0xAF, 0x3E, 0x76, 0x71, 0x22, 0x0B, 0xAA,
+			0xDA, 0x05, 0x11, 0x4D, 0xBC, 0xDB, 0xA5, 0xCD
+		}
+	}
+};
+
+static char name[64];
+
+int main(void)
+{
+	kripto_stream *s;
+	uint8_t key[129];
+	uint8_t iv[129];
+	uint8_t t[100];
+	unsigned int i;
+
+	for(i = 0; i < 129; i++)
+	{
+		key[i] = i;
+		iv[i] = 0xF0 - i;
+	}
+
+	for(i = 0; i < 3; i++)
+	{
+		(void)snprintf(name, sizeof(name), "%s short key", vectors[i].name);
+
+		s = kripto_stream_create(*vectors[i].desc, 0, key, 32, iv, 8);
+		if(!s) test_error(name);
+
+		kripto_stream_prng(s, t, 64);
+		test_cmp(name, t, vectors[i].short_out, 64);
+
+		/* encryption of zeros from a recreated stream */
+		(void)snprintf(name, sizeof(name), "%s recreate", vectors[i].name);
+
+		s = kripto_stream_recreate(s, 0, key, 32, iv, 8);
+		if(!s) test_error(name);
+
+		memset(t, 0, 64);
+		kripto_stream_encrypt(s, t, t, 64);
+		test_cmp(name, t, vectors[i].short_out, 64);
+
+		(void)snprintf(name, sizeof(name), "%s long key", vectors[i].name);
+
+		s = kripto_stream_recreate(s, 0, key, 129, iv, 129);
+		if(!s) test_error(name);
+
+		kripto_stream_prng(s, t, 100);
+		kripto_stream_prng(s, t, 64);
+		test_cmp(name, t, vectors[i].long_out, 64);
+
+		kripto_stream_destroy(s);
+	}
+
+	return test_result;
+}